@@ -7,13 +7,20 @@ G++ = g++
 AR = ar
 
 CFLAGS := -O3
-LDFLAGS = -lm
+LDFLAGS = -lm -lpthread
 CONFIG = -DHAVE_CONFIG_H 
 DEFS = -DFAST_UART
 
+# Interpreter dispatch: switch, or threaded (needs GCC labels as values)
+DISPATCH = switch
+ifeq ($(DISPATCH),threaded)
+DEFS += -DTHREADED_DISPATCH
+endif
+
 BUILD_DIR = build
 SRC_DIR = src
 UNIT_TEST_DIR = test/unit
 INTEGRATION_TEST_DIR = test/integration
+BENCH_DIR = test/bench
 
 RTEMS_APP_DIR = /opt/rtems-6-sparc-gr712rc-smp-4/src/example/b-gr712rc-qual-only/app.exe
\ No newline at end of file
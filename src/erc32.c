@@ -153,6 +153,7 @@ static uint32 rtc_scaler_start;
 static uint32 rtc_enabled;
 static uint32 rtc_cr;
 static uint32 rtc_se;
+static uint64 rtc_event;
 
 static uint32 gpt_counter;
 static uint32 gpt_reload;
@@ -161,11 +162,13 @@ static uint32 gpt_scaler_start;
 static uint32 gpt_enabled;
 static uint32 gpt_cr;
 static uint32 gpt_se;
+static uint64 gpt_event;
 
 static uint32 wdog_scaler;
 static uint32 wdog_counter;
 static uint32 wdog_rst_delay;
 static uint32 wdog_rston;
+static uint64 wdog_event;
 
 enum wdog_type
 {
@@ -211,6 +214,7 @@ static int f1open = 0, f2open = 0;
 static char uarta_sreg, uarta_hreg, uartb_sreg, uartb_hreg;
 static uint32 uart_stat_reg;
 static uint32 uarta_data, uartb_data;
+static uint64 uart_event;
 
 /* Forward declarations */
 
@@ -228,6 +232,7 @@ static void set_sfsr (uint32 fault, uint32 addr, uint32 asi, uint32 read);
 static int32 mec_read (uint32 addr, uint32 asi, uint32 * data);
 static int mec_write (uint32 addr, uint32 data);
 static void port_init (void);
+static void ckpt_init (void);
 static uint32 read_uart (uint32 addr);
 static void write_uart (uint32 addr, uint32 data);
 static void flush_uart (void);
@@ -258,10 +263,96 @@ static void store_bytes (char *mem, uint32 waddr,
 static void
 init_sim ()
 {
+  mem_alloc (RAM_SIZE, ROM_SIZE);
+  decode_memcfg ();		/* RAM limits depend on the allocated size */
   port_init ();
+  ckpt_init ();
   ebase.ramstart = RAM_START;
 }
 
+/* MEC state saved in checkpoints */
+
+static void
+ckpt_init ()
+{
+  CKPT_VAR (mec_ssa);
+  CKPT_VAR (mec_sea);
+  CKPT_VAR (mec_wpr);
+  CKPT_VAR (mec_sfsr);
+  CKPT_VAR (mec_ffar);
+  CKPT_VAR (mec_ipr);
+  CKPT_VAR (mec_imr);
+  CKPT_VAR (mec_isr);
+  CKPT_VAR (mec_icr);
+  CKPT_VAR (mec_ifr);
+  CKPT_VAR (mec_mcr);
+  CKPT_VAR (mec_memcfg);
+  CKPT_VAR (mec_wcr);
+  CKPT_VAR (mec_iocr);
+  CKPT_VAR (posted_irq);
+  CKPT_VAR (mec_ersr);
+  CKPT_VAR (mec_tcr);
+  CKPT_VAR (rtc_counter);
+  CKPT_VAR (rtc_reload);
+  CKPT_VAR (rtc_scaler);
+  CKPT_VAR (rtc_scaler_start);
+  CKPT_VAR (rtc_enabled);
+  CKPT_VAR (rtc_cr);
+  CKPT_VAR (rtc_se);
+  CKPT_VAR (rtc_event);
+  CKPT_VAR (gpt_counter);
+  CKPT_VAR (gpt_reload);
+  CKPT_VAR (gpt_scaler);
+  CKPT_VAR (gpt_scaler_start);
+  CKPT_VAR (gpt_enabled);
+  CKPT_VAR (gpt_cr);
+  CKPT_VAR (gpt_se);
+  CKPT_VAR (gpt_event);
+  CKPT_VAR (wdog_scaler);
+  CKPT_VAR (wdog_counter);
+  CKPT_VAR (wdog_rst_delay);
+  CKPT_VAR (wdog_rston);
+  CKPT_VAR (wdog_event);
+  CKPT_VAR (wdog_status);
+  CKPT_VAR (mem_ramr_ws);
+  CKPT_VAR (mem_ramw_ws);
+  CKPT_VAR (mem_romr_ws);
+  CKPT_VAR (mem_romw_ws);
+  CKPT_VAR (mem_ramstart);
+  CKPT_VAR (mem_ramend);
+  CKPT_VAR (mem_rammask);
+  CKPT_VAR (mem_ramsz);
+  CKPT_VAR (mem_romsz);
+  CKPT_VAR (mem_accprot);
+  CKPT_VAR (mem_blockprot);
+  CKPT_VAR (Ucontrol);
+  CKPT_VAR (aq);
+  CKPT_VAR (bq);
+  CKPT_VAR (anum);
+  CKPT_VAR (aind);
+  CKPT_VAR (bnum);
+  CKPT_VAR (bind);
+  CKPT_VAR (wbufa);
+  CKPT_VAR (wbufb);
+  CKPT_VAR (wnuma);
+  CKPT_VAR (wnumb);
+  CKPT_VAR (uarta_sreg);
+  CKPT_VAR (uarta_hreg);
+  CKPT_VAR (uartb_sreg);
+  CKPT_VAR (uartb_hreg);
+  CKPT_VAR (uart_stat_reg);
+  CKPT_VAR (uarta_data);
+  CKPT_VAR (uartb_data);
+  CKPT_VAR (uart_event);
+  CKPT_EVENT (uarta_tx);
+  CKPT_EVENT (uartb_tx);
+  CKPT_EVENT (uart_rx);
+  CKPT_EVENT (uart_intr);
+  CKPT_EVENT (wdog_intr);
+  CKPT_EVENT (rtc_intr);
+  CKPT_EVENT (gpt_intr);
+}
+
 /* Power-on reset init */
 
 static void
@@ -376,10 +467,14 @@ decode_memcfg ()
 
   mem_ramsz = (1024 * 1024) << ((mec_memcfg >> 10) & 7);
   mem_romsz = (2 * 1024 * 1024) << ((mec_memcfg >> 18) & 7);
+  if (ebase.romsize && (mem_romsz > ebase.romsize))
+    mem_romsz = ebase.romsize;	/* no ROM beyond what is allocated */
 
   mem_ramstart = RAM_START;
   mem_ramend = RAM_END;
   mem_rammask = RAM_MASK;
+  pdc_reset ();
+  tlb_flush ();
 
   if (sis_verbose)
     printf ("RAM start: 0x%x, RAM size: %d K, ROM size: %d K\n",
@@ -399,6 +494,8 @@ decode_wcr ()
       mem_romr_ws = 5 + (4 * mem_romr_ws);
     }
   mem_romw_ws = (mec_wcr >> 8) & 0x0f;
+  pdc_reset ();			/* cached fetches carry the old waitstates */
+  tlb_flush ();			/* as do TLB entries */
   if (sis_verbose)
     printf
       ("Waitstates = RAM read: %d, RAM write: %d, ROM read: %d, ROM write: %d\n",
@@ -410,6 +507,7 @@ decode_mcr ()
 {
   mem_accprot = (mec_wpr[0] | mec_wpr[1]);
   mem_blockprot = (mec_mcr >> 3) & 1;
+  tlb_flush ();
   if (sis_verbose && mem_accprot)
     printf ("Memory block write protection enabled\n");
   if (mec_mcr & 0x08000)
@@ -480,6 +578,7 @@ mec_reset ()
   uart_stat_reg = UARTA_SRE | UARTA_HRE | UARTB_SRE | UARTB_HRE;
   uarta_data = uartb_data = UART_THE | UART_TSE;
 
+  cancel_event (rtc_event);
   rtc_counter = 0xffffffff;
   rtc_reload = 0xffffffff;
   rtc_scaler = 0xff;
@@ -487,6 +586,7 @@ mec_reset ()
   rtc_cr = 0;
   rtc_se = 0;
 
+  cancel_event (gpt_event);
   gpt_counter = 0xffffffff;
   gpt_reload = 0xffffffff;
   gpt_scaler = 0xffff;
@@ -637,7 +737,10 @@ mec_read (addr, asi, data)
       break;
     case MEC_RTC_SCALER:	/* 0x84 */
       if (rtc_enabled)
-	*data = rtc_scaler - (now () - rtc_scaler_start);
+	{
+	  *data = rtc_scaler - ((uint32) sim_time () - rtc_scaler_start);
+	  ebase.iosfx++;	/* changes without an event */
+	}
       else
 	*data = rtc_scaler;
       break;
@@ -647,8 +750,11 @@ mec_read (addr, asi, data)
       break;
 
     case MEC_GPT_SCALER:	/* 0x8c */
-      if (rtc_enabled)
-	*data = gpt_scaler - (now () - gpt_scaler_start);
+      if (gpt_enabled)
+	{
+	  *data = gpt_scaler - ((uint32) sim_time () - gpt_scaler_start);
+	  ebase.iosfx++;	/* changes without an event */
+	}
       else
 	*data = gpt_scaler;
       break;
@@ -678,11 +784,13 @@ mec_read (addr, asi, data)
 	  return 1;
 	}
       *data = read_uart (addr);
+      ebase.iosfx++;
       break;
 
     case MEC_UART_CTRL:	/* 0xE8 */
 
       *data = read_uart (addr);
+      ebase.iosfx++;		/* polls the host */
       break;
 
     default:
@@ -732,6 +840,7 @@ mec_write (addr, data)
       mec_ssa[0] = data & 0x7fffff;
       mec_wpr[0] = (data >> 23) & 0x03;
       mem_accprot = mec_wpr[0] || mec_wpr[1];
+      tlb_flush ();
       if (sis_verbose && mec_wpr[0])
 	printf ("Segment 1 memory protection enabled (0x02%06x - 0x02%06x)\n",
 		mec_ssa[0] << 2, mec_sea[0] << 2);
@@ -747,6 +856,7 @@ mec_write (addr, data)
       mec_ssa[1] = data & 0x7fffff;
       mec_wpr[1] = (data >> 23) & 0x03;
       mem_accprot = mec_wpr[0] || mec_wpr[1];
+      tlb_flush ();
       if (sis_verbose && mec_wpr[1])
 	printf ("Segment 2 memory protection enabled (0x02%06x - 0x02%06x)\n",
 		mec_ssa[1] << 2, mec_sea[1] << 2);
@@ -1383,7 +1493,7 @@ uart_rx (arg)
       uart_stat_reg |= UARTB_DR;
       mec_irq (5);
     }
-  event (uart_rx, 0, UART_RX_TIME);
+  uart_event = event (uart_rx, 0, UART_RX_TIME);
 }
 
 static void
@@ -1392,18 +1502,19 @@ uart_intr (arg)
 {
   read_uart (0xE8);		/* Check for UART interrupts every 1000 clk */
   flush_uart ();		/* Flush UART ports      */
-  event (uart_intr, 0, UART_FLUSH_TIME);
+  uart_event = event (uart_intr, 0, UART_FLUSH_TIME);
 }
 
 
 static void
 uart_irq_start ()
 {
+  cancel_event (uart_event);
 #ifdef FAST_UART
-  event (uart_intr, 0, UART_FLUSH_TIME);
+  uart_event = event (uart_intr, 0, UART_FLUSH_TIME);
 #else
 #ifndef _WIN32
-  event (uart_rx, 0, UART_RX_TIME);
+  uart_event = event (uart_rx, 0, UART_RX_TIME);
 #endif
 #endif
 }
@@ -1424,7 +1535,7 @@ wdog_intr (arg)
       if (wdog_counter)
 	{
 	  wdog_counter--;
-	  event (wdog_intr, 0, wdog_scaler + 1);
+	  wdog_event = event (wdog_intr, 0, wdog_scaler + 1);
 	}
       else
 	{
@@ -1439,7 +1550,7 @@ wdog_intr (arg)
 	      mec_irq (15);
 	      wdog_rston = 1;
 	      wdog_counter = wdog_rst_delay;
-	      event (wdog_intr, 0, wdog_scaler + 1);
+	      wdog_event = event (wdog_intr, 0, wdog_scaler + 1);
 	    }
 	}
     }
@@ -1448,13 +1559,15 @@ wdog_intr (arg)
 static void
 wdog_start ()
 {
-  event (wdog_intr, 0, wdog_scaler + 1);
+  cancel_event (wdog_event);
+  wdog_event = event (wdog_intr, 0, wdog_scaler + 1);
   if (sis_verbose)
     printf ("Watchdog started, scaler = %d, counter = %d\n",
 	    wdog_scaler, wdog_counter);
 }
 
-/* MEC timers */
+/* MEC timers.  A timer is started at the time of the core that
+   writes the control register, which can be ahead of ebase.simtime. */
 
 static void
 rtc_intr (arg)
@@ -1473,7 +1586,7 @@ rtc_intr (arg)
     rtc_counter -= 1;
   if (rtc_se)
     {
-      event (rtc_intr, 0, rtc_scaler + 1);
+      rtc_event = event (rtc_intr, 0, rtc_scaler + 1);
       rtc_scaler_start = now ();
       rtc_enabled = 1;
     }
@@ -1490,8 +1603,9 @@ rtc_start ()
 {
   if (sis_verbose)
     printf ("RTC started (period %d)\n\r", rtc_scaler + 1);
-  event (rtc_intr, 0, rtc_scaler + 1);
-  rtc_scaler_start = now ();
+  cancel_event (rtc_event);
+  rtc_scaler_start = sim_time ();
+  rtc_event = event (rtc_intr, 0, rtc_scaler_start - now () + rtc_scaler + 1);
   rtc_enabled = 1;
 }
 
@@ -1531,7 +1645,7 @@ gpt_intr (arg)
     gpt_counter -= 1;
   if (gpt_se)
     {
-      event (gpt_intr, 0, gpt_scaler + 1);
+      gpt_event = event (gpt_intr, 0, gpt_scaler + 1);
       gpt_scaler_start = now ();
       gpt_enabled = 1;
     }
@@ -1548,8 +1662,9 @@ gpt_start ()
 {
   if (sis_verbose)
     printf ("GPT started (period %d)\n\r", gpt_scaler + 1);
-  event (gpt_intr, 0, gpt_scaler + 1);
-  gpt_scaler_start = now ();
+  cancel_event (gpt_event);
+  gpt_scaler_start = sim_time ();
+  gpt_event = event (gpt_intr, 0, gpt_scaler_start - now () + gpt_scaler + 1);
   gpt_enabled = 1;
 }
 
@@ -1749,6 +1864,7 @@ memory_write (uint32 addr, uint32 * data, int32 sz, int32 * ws)
 	    }
 	}
       waddr = addr & mem_rammask;
+      PDC_WRITE (mem_ramstart + waddr, 1 << sz);
       store_bytes (ramb, waddr, data, sz, ws);
       return 0;
     }
@@ -1781,6 +1897,7 @@ memory_write (uint32 addr, uint32 * data, int32 sz, int32 * ws)
       *ws = mem_romw_ws + 1;
       if (sz == 3)
 	*ws += mem_romw_ws + STD_WS;
+      PDC_WRITE (addr, 1 << sz);
       store_bytes (romb, addr, data, sz, ws);
       return 0;
     }
@@ -1796,7 +1913,7 @@ get_mem_ptr (addr, size)
      uint32 addr;
      uint32 size;
 {
-  if ((addr + size) < ROM_SIZE)
+  if ((addr + size) < ROM_END)
     {
       return &romb[addr];
     }
@@ -1808,6 +1925,36 @@ get_mem_ptr (addr, size)
   return (char *) -1;
 }
 
+/* RAM and ROM pages for the software TLB.  RAM is only writable
+   through the TLB while no write protection is enabled, and ROM
+   writes always go through memory_write ().  Stores to RAM aliases
+   beyond ebase.ramsize also go through memory_write (), which
+   invalidates predecoded code at the canonical address. */
+
+static int
+map_page (uint32 addr, struct tlbent *e)
+{
+  if ((addr >= mem_ramstart) && (addr < (mem_ramstart + mem_ramsz)))
+    {
+      e->mem = &ramb[addr & mem_rammask];
+      e->rws = mem_ramr_ws;
+      e->wws[0] = e->wws[1] = mem_ramw_ws + 3;
+      e->wws[2] = mem_ramw_ws;
+      e->wws[3] = 2 * mem_ramw_ws + STD_WS;
+      if (mem_accprot || ((addr - mem_ramstart) >= ebase.ramsize))
+	return TLB_R;
+      return TLB_R | TLB_W;
+    }
+  else if (((addr >> TLB_PAGEBITS) != (MEC_START >> TLB_PAGEBITS))
+	   && (addr < mem_romsz))
+    {
+      e->mem = &romb[addr];
+      e->rws = mem_romr_ws;
+      return TLB_R;
+    }
+  return 0;
+}
+
 static int
 sis_memory_write (addr, data, length)
      uint32 addr;
@@ -1819,6 +1966,10 @@ sis_memory_write (addr, data, length)
   if ((mem = get_mem_ptr (addr, length)) == ((char *) -1))
     return 0;
 
+  if ((mem >= ramb) && (mem < ramb + ebase.ramsize))
+    PDC_WRITE (mem_ramstart + (mem - ramb), length);
+  else
+    PDC_WRITE (addr, length);
   memcpy (mem, data, length);
   return length;
 }
@@ -1874,5 +2025,8 @@ const struct memsys erc32sys = {
   memory_write,
   sis_memory_write,
   sis_memory_read,
-  boot_init
+  boot_init,
+  get_mem_ptr,
+  NULL,
+  map_page
 };
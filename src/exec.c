@@ -26,7 +26,7 @@
 #include <ctype.h>
 #include <fenv.h>
 
-int ext_irl[NCPU];
+int *ext_irl;			/* see cpu_alloc () */
 
 #define SIGN_BIT 0x80000000
 
@@ -122,6 +122,77 @@ clear_accex ()
   feclearexcept (FE_ALL_EXCEPT);
 }
 
+/* Rounding mode in effect on the host thread, fesetround () is slow.
+   -1 makes the first call in each thread set the mode it inherited. */
+static __thread int host_fround = -1;
+
+void
+set_fround (int fround)
+{
+  if (fround != host_fround)
+    {
+      fesetround (fround);
+      host_fround = fround;
+    }
+}
+
+/* Reset core i */
+
+void
+init_cpu (int i)
+{
+  sregs[i].pc = 0;
+  sregs[i].npc = 4;
+  sregs[i].trap = 0;
+  SYNC_CC (&sregs[i]);
+  sregs[i].psr &= 0x00f03fdf;
+  if (cputype == CPU_ERC32)
+    sregs[i].psr |= 0x11000080;	/* Set supervisor bit */
+  else if (cputype == CPU_LEON2)
+    sregs[i].psr |= 0x00000080;	/* Set supervisor bit */
+  else
+    sregs[i].psr |= 0xF3000080;	/* Set supervisor bit */
+  sregs[i].breakpoint = 0;
+  sregs[i].fpstate = 0;
+  sregs[i].fpqn = 0;
+  sregs[i].ftime = 0;
+  sregs[i].ltime = 0;
+  sregs[i].err_mode = 0;
+  ext_irl[i] = 0;
+  sregs[i].g[0] = 0;
+  sregs[i].r[0] = 0;
+  sregs[i].fs = (float32 *) sregs[i].fd;
+  sregs[i].fsi = (int32 *) sregs[i].fd;
+  sregs[i].fsr = 0;
+  sregs[i].fpu_pres = !nfp;
+  sregs[i].ildreg = 0;
+  sregs[i].ildtime = 0;
+
+  sregs[i].y = 0;
+  sregs[i].asr17 = 0;
+
+  sregs[i].rett_err = 0;
+  sregs[i].jmpltime = 0;
+  sregs[i].asr17 = 0x04000107 | (i << 28);
+  if (!nfp)
+    sregs[i].asr17 |= (3 << 10);	/* Meiko FPU */
+  sregs[i].cpu = i;
+  sregs[i].simtime = 0;
+  sregs[i].pwdtime = 0;
+  sregs[i].pwdstart = 0;
+  if (i == 0)
+    sregs[i].pwd_mode = 0;
+  else
+    sregs[i].pwd_mode = 1;
+  sregs[i].mip = 0;
+  sregs[i].mstatus = 0;
+  sregs[i].mie = 0;
+  sregs[i].mpp = 0;
+  sregs[i].mode = 1;
+  sregs[i].lrq = 0;
+  sregs[i].bphit = 0;
+}
+
 void
 init_regs (sregs)
      struct pstate *sregs;
@@ -129,76 +200,31 @@ init_regs (sregs)
   int i;
 
   ebase.wphit = 0;
+  sparc_sync_accex ();
+  riscv_sync_fflags ();
 
-  for (i = 0; i < NCPU; i++)
-    {
-      sregs[i].pc = 0;
-      sregs[i].npc = 4;
-      sregs[i].trap = 0;
-      sregs[i].psr &= 0x00f03fdf;
-      if (cputype == CPU_ERC32)
-	sregs[i].psr |= 0x11000080;	/* Set supervisor bit */
-      else if (cputype == CPU_LEON2)
-	sregs[i].psr |= 0x00000080;	/* Set supervisor bit */
-      else
-	sregs[i].psr |= 0xF3000080;	/* Set supervisor bit */
-      sregs[i].breakpoint = 0;
-      sregs[i].fpstate = 0;
-      sregs[i].fpqn = 0;
-      sregs[i].ftime = 0;
-      sregs[i].ltime = 0;
-      sregs[i].err_mode = 0;
-      ext_irl[i] = 0;
-      sregs[i].g[0] = 0;
-      sregs[i].r[0] = 0;
-      sregs[i].fs = (float32 *) sregs[i].fd;
-      sregs[i].fsi = (int32 *) sregs[i].fd;
-      sregs[i].fsr = 0;
-      sregs[i].fpu_pres = !nfp;
-      sregs[i].ildreg = 0;
-      sregs[i].ildtime = 0;
-
-      sregs[i].y = 0;
-      sregs[i].asr17 = 0;
-
-      sregs[i].rett_err = 0;
-      sregs[i].jmpltime = 0;
-      sregs[i].asr17 = 0x04000107 | (i << 28);
-      if (!nfp)
-	sregs[i].asr17 |= (3 << 10);	/* Meiko FPU */
-      sregs[i].cpu = i;
-      sregs[i].simtime = 0;
-      sregs[i].pwdtime = 0;
-      sregs[i].pwdstart = 0;
-      if (i == 0)
-	sregs[i].pwd_mode = 0;
-      else
-	sregs[i].pwd_mode = 1;
-      sregs[i].mip = 0;
-      sregs[i].mstatus = 0;
-      sregs[i].mie = 0;
-      sregs[i].mpp = 0;
-      sregs[i].mode = 1;
-      sregs[i].lrq = 0;
-      sregs[i].bphit = 0;
-    }
+  for (i = 0; i < ncpu_alloc; i++)
+    init_cpu (i);
 }
 
-#ifdef ENABLE_L1CACHE
+/* Cores that may hold a line at each data cache index */
+static uint32 l1dshare[L1DTAGS];
+
 void
 l1data_snoop (uint32 address, uint32 cpu)
 {
+  uint32 idx = (address >> L1DLINEBITS) & L1DMASK;
+  uint32 cores;
   int i;
-  for (i = 0; i < ncpu; i++)
+
+  for (cores = l1dshare[idx] & ~(1u << cpu); cores; cores &= cores - 1)
     {
-      if (sregs[i].l1dtags[(address >> L1DLINEBITS) & L1DMASK] ==
-	  (address >> L1DLINEBITS))
+      i = __builtin_ctz (cores);
+      if (sregs[i].l1dtags[idx] == (address >> L1DLINEBITS))
 	{
-	  if (cpu != i)
-	    {
-	      sregs[i].l1dtags[(address >> L1DLINEBITS) & L1DMASK] = 0;
-//                              printf("l1 snoop hit : 0x%08X,  %d  %d\n", address, cpu, i);
-	    }
+	  sregs[i].l1dtags[idx] = 0;
+	  l1dshare[idx] &= ~(1u << i);
+	  mp_xcpu = 1;
 	}
     }
 }
@@ -211,8 +237,8 @@ l1data_update (uint32 address, uint32 cpu)
     {
       sregs[cpu].l1dtags[(address >> L1DLINEBITS) & L1DMASK] =
 	(address >> L1DLINEBITS);
+      l1dshare[(address >> L1DLINEBITS) & L1DMASK] |= 1u << cpu;
       sregs[cpu].hold += T_L1DMISS;
       sregs[cpu].l1dmiss++;
     }
 }
-#endif
@@ -23,6 +23,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stddef.h>
+#include <fenv.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
 #ifdef WIN32
 #include <winsock.h>
 #else
@@ -30,8 +35,11 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <netdb.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #endif
 #include <fcntl.h>
+#include <sys/stat.h>
 #include "sis.h"
 #include <inttypes.h>
 #include <sys/time.h>
@@ -42,14 +50,68 @@ int dumbio = 0;
 /* set if UARTs are connected to a tty, enable by default */
 int tty_setup = 1;
 
-struct pstate sregs[NCPU];
+struct pstate *sregs = NULL;	/* see cpu_alloc () */
 struct estate ebase;
-struct evcell evbuf[MAX_EVENT];
+
+/* core currently being simulated */
+static __thread struct pstate *simcore = NULL;
+
+/* Idle loop detection, see idle_check () */
+
+#define IDLE_MAXINST	32	/* longest loop considered, in instructions */
+#define IDLE_MAXWAIT	1024	/* most visits ignored after a failed check */
+
+#define IDLE_IUWORDS \
+  ((offsetof (struct pstate, trap) - offsetof (struct pstate, psr)) / 4)
+#define IDLE_CSRWORDS \
+  ((offsetof (struct pstate, mscratch) + 4 - \
+    offsetof (struct pstate, mip)) / 4)
+
+struct idleloop
+{
+  uint32 pc;			/* candidate loop head */
+  int armed;			/* core state below was saved at pc */
+  uint32 wait;			/* visits to ignore after a failed check */
+  uint32 backoff;		/* next value of wait */
+  uint64 time;			/* counters at the last visit to pc */
+  uint64 ninst;
+  uint64 finst;
+  uint32 wmiss;			/* TLB write misses, see idle_arm () */
+  uint64 nload;
+  uint64 nbranch;
+  uint64 holdt;
+  uint64 icntt;
+  uint64 fholdt;
+  uint64 iosfx;
+  uint64 evtime;
+  uint32 ild;			/* pending load interlock, relative */
+  uint32 fsr;
+  float64 fd[32];
+  uint32 iu[IDLE_IUWORDS];
+  uint32 csr[IDLE_CSRWORDS];
+  uint64 hits;			/* number of fast-forwards */
+  uint64 cycles;		/* cycles fast-forwarded */
+};
+
+static struct idleloop *idle = NULL;
+
+/* MP time slice statistics, see run_sim_mp () */
+
+static struct
+{
+  uint64 n;			/* slices run */
+  uint64 cycles;		/* their total length */
+  uint64 max;			/* longest slice */
+  uint64 shrunk;		/* slices with cross-cpu activity */
+  uint64 idle;			/* jumps to the next event with all cores idle */
+} qstat;
 
 int ctrl_c = 0;
 int sis_verbose = 0;
 char *sis_version = PACKAGE_VERSION;
 int nfp = 0;
+int fpexact = 0;
+int noidle = 0;
 int ift = 0;
 int wrp = 0;
 int rom8 = 0;
@@ -64,16 +126,33 @@ int sim_run = 0;
 int sync_rt = 0;
 char bridge[32] = "";
 
-/* RAM and ROM for all systems */
-char romb[MAX_ROM_SIZE];
-char ramb[MAX_RAM_SIZE];
+/* RAM and ROM for all systems, allocated by mem_alloc () */
+char *romb;
+char *ramb;
+uint32 romsize = 0;		/* -rom size, 0 for the target default */
+uint32 ramsize = 0;		/* -ram size, 0 for the target default */
+int hugepage = 0;		/* back guest memory with huge pages */
+static unsigned char *covram;	/* code coverage, one byte per RAM word */
 const struct memsys *ms;
 int cputype = 0;
 int archtype = 0;
 int sis_gdb_break;
 int cpu = 0;			/* active cpu */
 int ncpu = 1;			/* number of cpus to emulate */
+int ncpu_alloc = 0;		/* cpus with allocated state */
 int delta = 50;			/* time slice for MP simulation */
+int delta_max = 1000;		/* longest adaptive MP time slice */
+int mp_xcpu = 0;		/* cross-cpu activity in the current slice */
+uint32 mp_idle = 0;		/* sleeping cores run_sim_mp () skips */
+int jit = 0;			/* run translated blocks */
+int jithost = 1;		/* as host code where JIT_X86 allows */
+#ifdef ENABLE_L1CACHE
+int l1cache = 1;		/* L1 cache model in MP runs (-l1) */
+#else
+int l1cache = 0;		/* L1 cache model in MP runs (-l1) */
+#endif
+int mtsim = 0;			/* run cores on host threads (-mt) */
+int mt_running = 0;		/* cores are running on host threads */
 const struct cpu_arch *arch = &sparc32;
 uint32 daddr = 0;
 /*
@@ -86,7 +165,6 @@ static int symcount = 0;
 /* Forward declarations */
 
 static int batch (struct pstate *sregs, char *fname);
-static void init_event (void);
 static void disp_mem (uint32 addr, uint32 len);
 static ssize_t mygetline (char **lineptr, size_t * n, FILE * stream);
 static void symprint ();
@@ -159,6 +237,231 @@ limcalc (freq)
   return lim;
 }
 
+/* Fan a test script out over forked copies of the simulator.  Each
+   line of the script names a file that becomes the UART input (stdin)
+   of one child, optionally followed by a time limit as for tlimit.
+   The children continue from the current state, sharing memory with
+   the parent copy-on-write, and write their output to <file>.log.  A
+   job without a limit stops after FORK_TLIMIT seconds of simulated
+   time, as a guest waiting for more input would otherwise never end.
+   At most n run at once; n = 0 uses all host cores.  The statistics of
+   each child are copied from its log once all have finished. */
+
+#ifndef WIN32
+#define FORK_TLIMIT	10
+
+struct forkjob
+{
+  pid_t pid;
+  int status;			/* exit status from waitpid () */
+  uint64 cycles;		/* filled in by the child */
+  uint64 ninst;
+  off_t statpos;		/* offset of show_stat () output in the log */
+};
+
+static const char *const stat_name[] = {
+  "ok", "time out", "breakpoint", "error mode", "interrupt", "watchpoint",
+  "segfault"
+};
+
+/* Run one job; line is "file [time limit]" */
+
+static void
+fork_child (struct forkjob *job, char *line)
+{
+  char lname[256], *fname;
+  uint64 lim;
+  int fd, i, stat;
+
+  fname = strtok (line, " \t");
+  if ((fd = open (fname, O_RDONLY)) < 0)
+    {
+      printf ("couldn't open %s\n", fname);
+      fflush (stdout);
+      _exit (127);
+    }
+  dup2 (fd, 0);
+  close (fd);
+  snprintf (lname, sizeof (lname), "%s.log", fname);
+  if ((fd = open (lname, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+    {
+      printf ("couldn't create %s\n", lname);
+      _exit (127);
+    }
+  dup2 (fd, 1);
+  dup2 (fd, 2);
+  close (fd);
+  if ((lim = limcalc (ebase.freq)) != (uint64) -1)
+    ebase.tlimit = lim;
+  else if (ebase.tlimit <= ebase.simtime)
+    ebase.tlimit =
+      ebase.simtime + (uint64) (FORK_TLIMIT * 1.0E6 * ebase.freq);
+
+  stat = run_sim (UINT64_MAX / 2, 0);
+  if ((stat == CTRL_C) && (ctrl_c == 2))
+    stat = TIME_OUT;
+  ms->sim_halt ();
+  fflush (stdout);
+  job->statpos = lseek (1, 0, SEEK_CUR);
+  show_stat (sregs);
+  job->cycles = ebase.simtime - ebase.simstart;
+  for (job->ninst = 0, i = 0; i < ncpu; i++)
+    job->ninst += sregs[i].ninst;
+  fflush (stdout);
+  _exit (stat);
+}
+
+/* Wait for a child and note its status */
+
+static int
+fork_reap (struct forkjob *job, int njob)
+{
+  pid_t pid;
+  int i, st;
+
+  if ((pid = wait (&st)) < 0)
+    return 0;
+  for (i = 0; i < njob; i++)
+    if (job[i].pid == pid)
+      job[i].status = st;
+  return 1;
+}
+
+/* Copy the statistics a child left at the end of its log */
+
+static void
+fork_stat (struct forkjob *job, int i, const char *name)
+{
+  char lname[256];
+  FILE *fp;
+  int c;
+
+  snprintf (lname, sizeof (lname), "%.*s.log", (int) strcspn (name, " \t"),
+	    name);
+  if ((fp = fopen (lname, "r")) == NULL)
+    return;
+  if (fseek (fp, job->statpos, SEEK_SET) == 0)
+    {
+      printf ("\n job %d, %s:\n", i, lname);
+      while ((c = getc (fp)) != EOF)
+	putchar (c);
+    }
+  fclose (fp);
+}
+
+static int
+fork_run (int n, const char *fname)
+{
+  FILE *fp;
+  char *lbuf = NULL, *name;
+  size_t len = 0;
+  struct forkjob *job;
+  char **names = NULL;
+  int i, njob = 0, running = 0, next, failed = 0, st;
+  pid_t pid;
+
+  if ((fp = fopen (fname, "r")) == NULL)
+    {
+      printf ("couldn't open fork script %s\n", fname);
+      return 0;
+    }
+  while (mygetline (&lbuf, &len, fp) > -1)
+    {
+      for (name = lbuf; isspace ((unsigned char) *name); name++);
+      if ((*name == 0) || (*name == '#'))
+	continue;
+      name[strcspn (name, "\n\r")] = 0;
+      names = realloc (names, (njob + 1) * sizeof (char *));
+      names[njob++] = strdup (name);
+    }
+  free (lbuf);
+  fclose (fp);
+  if (njob == 0)
+    {
+      printf ("fork: no jobs in %s\n", fname);
+      return 0;
+    }
+
+  /* results come back through memory shared with the children */
+  job = mmap (NULL, njob * sizeof (struct forkjob), PROT_READ | PROT_WRITE,
+	      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (job == MAP_FAILED)
+    {
+      printf ("fork: %s\n", strerror (errno));
+      return 0;
+    }
+  if ((ebase.simtime == 0) && (last_load_addr != 0))
+    {
+      /* not booted yet, start from the entry point as run does */
+      reset_all ();
+      reset_stat (sregs);
+      for (i = 0; i < ncpu; i++)
+	{
+	  sregs[i].pc = last_load_addr & ~3;
+	  sregs[i].npc = sregs[i].pc + 4;
+	}
+      ms->boot_init ();
+    }
+  if (n <= 0)
+    n = sysconf (_SC_NPROCESSORS_ONLN);
+  if (sis_verbose)
+    printf ("forking %d jobs, %d at a time\n", njob, n);
+
+  for (next = 0; (next < njob) || running;)
+    {
+      if ((next < njob) && (running < n))
+	{
+	  job[next].status = -1;
+	  job[next].statpos = -1;
+	  fflush (stdout);
+	  if ((pid = fork ()) == 0)
+	    fork_child (&job[next], names[next]);
+	  if (pid < 0)
+	    {
+	      printf ("fork: %s\n", strerror (errno));
+	      break;
+	    }
+	  job[next++].pid = pid;
+	  running++;
+	  continue;
+	}
+      if (!fork_reap (job, next))
+	break;
+      running--;
+    }
+  while (running && fork_reap (job, next))
+    running--;
+
+  for (i = 0; i < next; i++)
+    if (job[i].statpos >= 0)
+      fork_stat (&job[i], i, names[i]);
+  printf ("\n  job  status            cycles      instructions  input\n");
+  for (i = 0; i < njob; i++)
+    {
+      printf (" %4d  ", i);
+      st = job[i].status;
+      if ((i >= next) || (st == -1))
+	printf ("%-10s", "not run");
+      else if (WIFSIGNALED (st))
+	printf ("signal %-3d", WTERMSIG (st));
+      else if (WEXITSTATUS (st) < (int) (sizeof (stat_name) / sizeof (char *)))
+	printf ("%-10s", stat_name[WEXITSTATUS (st)]);
+      else
+	printf ("exit %-5d", WEXITSTATUS (st));
+      if ((i >= next) || (st == -1) || WIFSIGNALED (st)
+	  || (WEXITSTATUS (st) == 127))
+	failed++;
+      printf (" %14" PRIu64 "  %16" PRIu64 "  %s\n", job[i].cycles,
+	      job[i].ninst, names[i]);
+      free (names[i]);
+    }
+  printf (" %d jobs, %d failed\n\n", njob, failed);
+  free (names);
+  munmap (job, njob * sizeof (struct forkjob));
+  return 1;
+}
+#endif
+
 int
 exec_cmd (const char *cmd)
 {
@@ -237,6 +540,10 @@ exec_cmd (const char *cmd)
 	      batch (sregs, cmd1);
 	    }
 	}
+      else if (strncmp (cmd1, "baseline", clen) == 0)
+	{
+	  baseline_set ();
+	}
       else if (strncmp (cmd1, "cont", clen) == 0)
 	{
 	  if ((cmd1 = strtok (NULL, " \t\n\r")) == NULL)
@@ -274,6 +581,13 @@ exec_cmd (const char *cmd)
 	  daddr = dis_mem (daddr, len);
 	  printf ("\n");
 	}
+      else if (strncmp (cmd1, "dump", clen) == 0)
+	{
+	  if ((cmd1 = strtok (NULL, " \t\n\r")) != NULL)
+	    mem_dump (cmd1);
+	  else
+	    printf ("dump: no file specified\n");
+	}
       else if (strncmp (cmd1, "echo", clen) == 0)
 	{
 	  if ((cmd1 = strtok (NULL, " \t\n\r")) != NULL)
@@ -285,6 +599,18 @@ exec_cmd (const char *cmd)
 	{
 	  arch->display_fpu (sregs);
 	}
+      else if (strncmp (cmd1, "fork", clen) == 0)
+	{
+	  if (((cmd1 = strtok (NULL, " \t\n\r")) == NULL) ||
+	      ((cmd2 = strtok (NULL, " \t\n\r")) == NULL))
+	    printf ("usage: fork <n> <script>\n");
+	  else
+#ifdef WIN32
+	    printf ("fork: not supported on this host\n");
+#else
+	    fork_run (VAL (cmd1), cmd2);
+#endif
+	}
       else if (strncmp (cmd1, "go", clen) == 0)
 	{
 	  if ((cmd1 = strtok (NULL, " \t\n\r")) == NULL)
@@ -363,6 +689,7 @@ exec_cmd (const char *cmd)
 	{
 	  if ((cmd1 = strtok (NULL, " \t\n\r")) != NULL)
 	    {
+	      baseline_drop ();
 	      last_load_addr = elf_load (cmd1, 1);
 	      daddr = last_load_addr;
 	      while ((cmd1 = strtok (NULL, " \t\n\r")) != NULL)
@@ -389,8 +716,8 @@ exec_cmd (const char *cmd)
 	  if ((cmd1 = strtok (NULL, " \t\n\r")) != NULL)
 	    {
 	      cpu = VAL (cmd1);
-	      if (cpu > NCPU)
-		cpu = NCPU;
+	      if (cpu >= ncpu)
+		cpu = ncpu - 1;
 	    }
 	  printf ("active cpu: %d\n", cpu);
 	}
@@ -401,6 +728,12 @@ exec_cmd (const char *cmd)
 	      ncpu = VAL (cmd1);
 	      if (ncpu > NCPU)
 		ncpu = NCPU;
+	      if (ncpu < 1)
+		ncpu = 1;
+	      if (((cputype == CPU_LEON3) || (cputype == CPU_LEON4))
+		  && (ncpu > IRQMP_NCPU))
+		ncpu = IRQMP_NCPU;
+	      cpu_alloc (ncpu);
 	    }
 	  printf ("number of online cpus: %d\n", ncpu);
 	}
@@ -453,18 +786,36 @@ exec_cmd (const char *cmd)
 	  reset_all ();
 	  reset_stat (sregs);
 	}
+      else if (strncmp (cmd1, "restore", clen) == 0)
+	{
+	  if ((cmd1 = strtok (NULL, " \t\n\r")) == NULL)
+	    printf ("restore: no file specified\n");
+	  else if (ckpt_restore (cmd1) == 0)
+	    daddr = sregs[cpu].pc;
+	}
+      else if (strncmp (cmd1, "rewind", clen) == 0)
+	{
+	  if ((i = baseline_rewind ()) < 0)
+	    printf ("rewind: no baseline set\n");
+	  else if (sis_verbose)
+	    printf ("rewound %d pages\n", i);
+	  daddr = sregs[cpu].pc;
+	}
       else if (strncmp (cmd1, "run", clen) == 0)
 	{
-	  ebase.simtime = 0;
-	  ebase.simstart = 0;
-	  reset_all ();
-	  reset_stat (sregs);
-	  if (last_load_addr != 0)
+	  if (baseline_rewind () < 0)
 	    {
-	      for (i = 0; i < ncpu; i++)
+	      ebase.simtime = 0;
+	      ebase.simstart = 0;
+	      reset_all ();
+	      reset_stat (sregs);
+	      if (last_load_addr != 0)
 		{
-		  sregs[i].pc = last_load_addr & ~3;
-		  sregs[i].npc = sregs[i].pc + 4;
+		  for (i = 0; i < ncpu; i++)
+		    {
+		      sregs[i].pc = last_load_addr & ~3;
+		      sregs[i].npc = sregs[i].pc + 4;
+		    }
 		}
 	    }
 	  if (ebase.simtime == 0)
@@ -641,6 +992,13 @@ exec_cmd (const char *cmd)
 		}
 	    }
 	}
+      else if (strncmp (cmd1, "save", clen) == 0)
+	{
+	  if ((cmd1 = strtok (NULL, " \t\n\r")) != NULL)
+	    ckpt_save (cmd1);
+	  else
+	    printf ("save: no file specified\n");
+	}
       else
 	printf ("syntax error\n");
     }
@@ -657,6 +1015,7 @@ reset_stat (sregs)
      struct pstate *sregs;
 {
   ebase.tottime = 0.0;
+  ebase.totcyc = 0;
   sregs->pwdtime = 0;
   sregs->ninst = 0;
   sregs->fholdt = 0;
@@ -669,19 +1028,23 @@ reset_stat (sregs)
   ebase.simstart = ebase.simtime;
   sregs->l1imiss = 0;
   sregs->l1dmiss = 0;
-
+  memset (idle, 0, ncpu_alloc * sizeof (struct idleloop));
+  memset (&qstat, 0, sizeof (qstat));
+  if (ms && ms->bus_stat)
+    ms->bus_stat (1);
 }
 
 void
 show_stat (sregs)
      struct pstate *sregs;
 {
-  uint64 iinst, ninst, pwdtime;
+  uint64 iinst, ninst, pwdtime, ihits, icycles;
   uint64 stime, atime;
-  int i;
+  int i, l1;
 
   ninst = 0;
   pwdtime = 0;
+  ihits = icycles = 0;
   atime = 0;
   if (ebase.tottime == 0.0)
     ebase.tottime += 1E-6;
@@ -694,6 +1057,8 @@ show_stat (sregs)
 	}
       ninst += sregs[i].ninst;
       pwdtime += sregs[i].pwdtime;
+      ihits += idle[i].hits;
+      icycles += idle[i].cycles;
     }
   stime = ebase.simtime - ebase.simstart;	/* Total simulated time */
   printf ("\n Frequency       : %4.1f MHz\n", ebase.freq);
@@ -708,26 +1073,23 @@ show_stat (sregs)
 		   ((double) (stime) / (ebase.freq * 1.0E6))));
   printf (" Simulator perf. : %.2f MIPS\n",
 	  (double) (ninst / ebase.tottime / 1E6));
+  if (ebase.totcyc && ninst)
+    printf (" Host cycles/inst: %.1f\n", (double) ebase.totcyc / ninst);
+  printf (" Idle loops      : %" PRIu64 " skips, %" PRIu64 " cycles\n", ihits,
+	  icycles);
+  if (qstat.n)
+    printf (" MP time slices  : %" PRIu64 ", %.1f cycles average, %" PRIu64
+	    " max, %" PRIu64 " shrunk, %" PRIu64 " idle jumps\n", qstat.n,
+	    (double) qstat.cycles / qstat.n, qstat.max, qstat.shrunk,
+	    qstat.idle);
   printf (" Wall time       : %.2f s\n\n", ebase.tottime);
-  printf (" Core   MIPS   MFLOPS     CPI     Util"
-#ifdef ENABLE_L1CACHE
-	  "      IHit      DHit"
-#endif
-	  "\n");
+  l1 = l1cache && (ncpu > 1);
+  printf (" Core   MIPS   MFLOPS     CPI     Util%s\n",
+	  l1 ? "      IHit      DHit" : "");
   for (i = 0; i < ncpu; i++)
     {
-#ifdef STAT
-      iinst =
-	sregs[i].ninst - sregs[i].finst - sregs[i].nload - sregs[i].nstore -
-	sregs[i].nbranch;
-#endif
-
       stime = sregs[i].simtime - ebase.simstart + 1;	/* Core simulated time */
-      printf ("  %d    %5.2f    %5.2f    %5.2f    %5.2f%%"
-#ifdef ENABLE_L1CACHE
-	      "    %5.2f%%    %5.2f%%"
-#endif
-	      "\n", i,
+      printf ("  %d    %5.2f    %5.2f    %5.2f    %5.2f%%", i,
 	      ebase.freq * (double) (sregs[i].ninst - sregs[i].finst) /
 	      (double) (stime - sregs[i].pwdtime),
 	      ebase.freq * (double) sregs[i].finst / (double) (stime -
@@ -735,35 +1097,58 @@ show_stat (sregs)
 							       [i].pwdtime),
 	      (double) (stime - sregs[i].pwdtime) / (double) (sregs[i].ninst +
 							      1),
-	      100.0 * (1.0 - ((double) sregs[i].pwdtime / (double) stime))
-#ifdef ENABLE_L1CACHE
-	      , (double) (sregs[i].ninst - sregs[i].l1imiss + 1) /
-	      (double) (sregs[i].ninst + 1) * 100.0,
-	      (double) (sregs[i].nload + sregs[i].nstore - sregs[i].l1dmiss +
-			1) / (double) (sregs[i].nload + sregs[i].nstore +
-				       1) * 100.0
-#endif
-	);
-    }
-
-#ifdef STAT
-  printf ("   integer    : %9.2f %%\n",
-	  100.0 * (double) iinst / (double) sregs[i].ninst);
-  printf ("   load       : %9.2f %%\n",
-	  100.0 * (double) sregs->nload / (double) sregs[i].ninst);
-  printf ("   store      : %9.2f %%\n",
-	  100.0 * (double) sregs->nstore / (double) sregs[i].ninst);
-  printf ("   branch     : %9.2f %%\n",
-	  100.0 * (double) sregs->nbranch / (double) sregs[i].ninst);
-  printf ("   float      : %9.2f %%\n",
-	  100.0 * (double) sregs->finst / (double) sregs[i].ninst);
-  printf (" Integer CPI  : %9.2f\n",
-	  ((double)
-	   (stime - sregs[i].pwdtime - sregs[i].fholdt -
-	    sregs[i].finst)) / (double) (sregs[i].ninst - sregs[i].finst));
-  printf (" Float CPI    : %9.2f\n",
-	  ((double) sregs[i].fholdt / (double) sregs[i].finst) + 1.0);
-#endif
+	      100.0 * (1.0 - ((double) sregs[i].pwdtime / (double) stime)));
+      if (l1)
+	printf ("    %5.2f%%", (double) (sregs[i].ninst - sregs[i].l1imiss + 1) /
+		(double) (sregs[i].ninst + 1) * 100.0);
+      /* loads and stores are only counted with -stat */
+      if (l1 && ebase.stat)
+	printf ("    %5.2f%%",
+		(double) (sregs[i].nload + sregs[i].nstore - sregs[i].l1dmiss +
+			  1) / (double) (sregs[i].nload + sregs[i].nstore +
+					 1) * 100.0);
+      else if (l1)
+	printf ("         -");
+      printf ("\n");
+    }
+
+  if (ebase.stat && ninst)
+    {
+      /* instruction mix and CPI over all cores */
+      uint64 finst, nload, nstore, nbranch, fholdt;
+
+      finst = nload = nstore = nbranch = fholdt = 0;
+      atime = 0;
+      for (i = 0; i < ncpu; i++)
+	{
+	  finst += sregs[i].finst;
+	  nload += sregs[i].nload;
+	  nstore += sregs[i].nstore;
+	  nbranch += sregs[i].nbranch;
+	  fholdt += sregs[i].fholdt;
+	  atime += sregs[i].simtime - ebase.simstart + 1 - sregs[i].pwdtime;
+	}
+      iinst = ninst - finst - nload - nstore - nbranch;
+      printf ("\n   integer    : %9.2f %%\n",
+	      100.0 * (double) iinst / (double) ninst);
+      printf ("   load       : %9.2f %%\n",
+	      100.0 * (double) nload / (double) ninst);
+      printf ("   store      : %9.2f %%\n",
+	      100.0 * (double) nstore / (double) ninst);
+      printf ("   branch     : %9.2f %%\n",
+	      100.0 * (double) nbranch / (double) ninst);
+      printf ("   float      : %9.2f %%\n",
+	      100.0 * (double) finst / (double) ninst);
+      if (ninst > finst)
+	printf (" Integer CPI  : %9.2f\n",
+		((double) (atime - fholdt - finst)) /
+		(double) (ninst - finst));
+      if (finst)
+	printf (" Float CPI    : %9.2f\n",
+		((double) fholdt / (double) finst) + 1.0);
+      if (ms->bus_stat)
+	ms->bus_stat (0);
+    }
   printf ("\n");
 }
 
@@ -929,44 +1314,164 @@ dis_mem (addr, len)
   return addr;
 }
 
-/* Add event to event queue */
+/* The event queue is a binary heap ordered on time, and on insertion
+   order for events with equal time. Heap entries are indices into a pool
+   of event cells which is grown when exhausted. */
 
-void
-event (cfunc, arg, delta)
-     void (*cfunc) ();
-     int32 arg;
-     uint64 delta;
+static int
+ev_before (a, b)
+     uint32 a;
+     uint32 b;
+{
+  struct evcell *ea = &ebase.evcell[a];
+  struct evcell *eb = &ebase.evcell[b];
+
+  return (ea->time < eb->time) || ((ea->time == eb->time)
+				   && (ea->seq < eb->seq));
+}
+
+static void
+ev_place (pos, cell)
+     uint32 pos;
+     uint32 cell;
 {
-  struct evcell *ev1, *evins;
+  ebase.eq[pos] = cell;
+  ebase.evcell[cell].pos = pos;
+}
+
+static void
+ev_up (pos)
+     uint32 pos;
+{
+  uint32 cell = ebase.eq[pos];
 
-  if (ebase.freeq == NULL)
+  while (pos > 0)
     {
-      printf ("Error, too many events in event queue\n");
-      return;
+      uint32 parent = (pos - 1) / 2;
+      if (!ev_before (cell, ebase.eq[parent]))
+	break;
+      ev_place (pos, ebase.eq[parent]);
+      pos = parent;
+    }
+  ev_place (pos, cell);
+}
+
+static void
+ev_down (pos)
+     uint32 pos;
+{
+  uint32 cell = ebase.eq[pos];
+  uint32 child;
+
+  while ((child = 2 * pos + 1) < ebase.evnum)
+    {
+      if ((child + 1 < ebase.evnum)
+	  && ev_before (ebase.eq[child + 1], ebase.eq[child]))
+	child++;
+      if (!ev_before (ebase.eq[child], cell))
+	break;
+      ev_place (pos, ebase.eq[child]);
+      pos = child;
     }
-  ev1 = &ebase.eq;
-  delta += ebase.simtime;
-  while ((ev1->nxt != NULL) && (ev1->nxt->time <= delta))
+  ev_place (pos, cell);
+}
+
+/* Remove the event at heap position pos and release its cell */
+
+static void
+ev_delete (pos)
+     uint32 pos;
+{
+  uint32 cell = ebase.eq[pos];
+
+  ebase.evnum--;
+  if (pos < ebase.evnum)
     {
-      ev1 = ev1->nxt;
+      ev_place (pos, ebase.eq[ebase.evnum]);
+      if ((pos > 0) && ev_before (ebase.eq[pos], ebase.eq[(pos - 1) / 2]))
+	ev_up (pos);
+      else
+	ev_down (pos);
     }
-  if (ev1->nxt == NULL)
+  ebase.evcell[cell].pos = EVC_NONE;
+  ebase.evcell[cell].nxt = ebase.freeq;
+  ebase.freeq = cell;
+  ebase.evtime = ebase.evnum ? ebase.evcell[ebase.eq[0]].time : UINT64_MAX;
+}
+
+static int
+ev_grow ()
+{
+  struct evcell *evcell;
+  uint32 *eq;
+  uint32 i, evmax;
+
+  evmax = ebase.evmax ? ebase.evmax * 2 : MAX_EVENT;
+  evcell = realloc (ebase.evcell, evmax * sizeof (struct evcell));
+  if (evcell == NULL)
+    return 0;
+  ebase.evcell = evcell;
+  eq = realloc (ebase.eq, evmax * sizeof (uint32));
+  if (eq == NULL)
+    return 0;
+  ebase.eq = eq;
+  for (i = ebase.evmax; i < evmax; i++)
     {
-      ev1->nxt = ebase.freeq;
-      ebase.freeq = ebase.freeq->nxt;
-      ev1->nxt->nxt = NULL;
+      evcell[i].pos = EVC_NONE;
+      evcell[i].nxt = (i + 1 < evmax) ? i + 1 : EVC_NONE;
     }
-  else
+  ebase.freeq = ebase.evmax;
+  ebase.evmax = evmax;
+  return 1;
+}
+
+/* Add event to event queue. Returns a handle for cancel_event(), made of
+   the cell index and the low part of the sequence number so that a stale
+   handle does not match a reused cell. Zero is never a valid handle. */
+
+uint64
+event (cfunc, arg, delta)
+     void (*cfunc) ();
+     int32 arg;
+     uint64 delta;
+{
+  struct evcell *ev;
+  uint32 cell;
+
+  if ((ebase.freeq >= ebase.evmax) && !ev_grow ())
     {
-      evins = ebase.freeq;
-      ebase.freeq = ebase.freeq->nxt;
-      evins->nxt = ev1->nxt;
-      ev1->nxt = evins;
+      printf ("Error, too many events in event queue\n");
+      return 0;
     }
-  ev1->nxt->time = delta;
-  ev1->nxt->cfunc = cfunc;
-  ev1->nxt->arg = arg;
-  ebase.evtime = ebase.eq.nxt->time;
+  cell = ebase.freeq;
+  ev = &ebase.evcell[cell];
+  ebase.freeq = ev->nxt;
+  ev->time = delta + ebase.simtime;
+  ev->cfunc = cfunc;
+  ev->arg = arg;
+  if ((uint32) ebase.evseq == 0)
+    ebase.evseq++;
+  ev->seq = ebase.evseq++;
+  ebase.eq[ebase.evnum] = cell;
+  ev_up (ebase.evnum++);
+  ebase.evtime = ebase.evcell[ebase.eq[0]].time;
+  return ((uint64) (uint32) ev->seq << 32) | cell;
+}
+
+/* Remove a pending event by handle. Returns 1 if the event was still
+   queued, 0 if it already fired or was cancelled. */
+
+int
+cancel_event (handle)
+     uint64 handle;
+{
+  uint32 cell = handle & 0xffffffff;
+
+  if ((cell >= ebase.evmax) || (ebase.evcell[cell].pos == EVC_NONE)
+      || ((uint32) ebase.evcell[cell].seq != (uint32) (handle >> 32)))
+    return 0;
+  ev_delete (ebase.evcell[cell].pos);
+  return 1;
 }
 
 /* remove event from event queue */
@@ -975,21 +1480,21 @@ remove_event (cfunc, arg)
      void (*cfunc) ();
      int32 arg;
 {
-  struct evcell *ev1, *evdel;
+  struct evcell *ev;
+  uint32 pos;
 
-  ev1 = &ebase.eq;
-  while (ev1->nxt != NULL)
+  /* Scan from the end; a deletion can only move an unvisited entry
+     into the current position, so it is checked again.  */
+  for (pos = ebase.evnum; pos-- > 0;)
     {
-      if ((ev1->nxt->cfunc == cfunc) && ((arg == ev1->nxt->arg) || (arg < 0)))
+      while (pos < ebase.evnum)
 	{
-	  evdel = ev1->nxt;
-	  ev1->nxt = ev1->nxt->nxt;
-	  evdel->nxt = ebase.freeq;
-	  ebase.freeq = evdel;
+	  ev = &ebase.evcell[ebase.eq[pos]];
+	  if ((ev->cfunc != cfunc) || ((arg != ev->arg) && (arg >= 0)))
+	    break;
+	  ev_delete (pos);
 	}
-      ev1 = ev1->nxt;
     }
-  ebase.evtime = ebase.eq.nxt->time;
 }
 
 static void
@@ -1002,15 +1507,18 @@ last_event (int32 arg)
 void
 init_event ()
 {
-  int32 i;
+  uint32 i;
 
-  ebase.eq.nxt = NULL;
-  ebase.freeq = evbuf;
-  for (i = 0; i < MAX_EVENT; i++)
+  /* evseq is kept, so handles taken before a reset stay invalid */
+  ebase.evnum = 0;
+  ebase.freeq = EVC_NONE;
+  for (i = ebase.evmax; i-- > 0;)
     {
-      evbuf[i].nxt = &evbuf[i + 1];
+      ebase.evcell[i].pos = EVC_NONE;
+      ebase.evcell[i].nxt = ebase.freeq;
+      ebase.freeq = i;
     }
-  evbuf[MAX_EVENT - 1].nxt = NULL;
+  ebase.evtime = UINT64_MAX;
   event (last_event, 0, UINT64_MAX);
 }
 
@@ -1021,23 +1529,24 @@ advance_time (endtime)
      uint64 endtime;
 {
 
-  struct evcell *evrem;
+  struct evcell *ev;
+  struct pstate *core;
   void (*cfunc) ();
   uint32 arg;
 
+  core = simcore;
+  simcore = NULL;
   while (ebase.evtime <= endtime)
     {
-      ebase.simtime = ebase.eq.nxt->time;
-      cfunc = ebase.eq.nxt->cfunc;
-      arg = ebase.eq.nxt->arg;
-      evrem = ebase.eq.nxt;
-      ebase.eq.nxt = ebase.eq.nxt->nxt;
-      ebase.evtime = ebase.eq.nxt->time;
-      evrem->nxt = ebase.freeq;
-      ebase.freeq = evrem;
+      ev = &ebase.evcell[ebase.eq[0]];
+      ebase.simtime = ev->time;
+      cfunc = ev->cfunc;
+      arg = ev->arg;
+      ev_delete (0);
       cfunc (arg);
     }
   ebase.simtime = endtime;
+  simcore = core;
 
 }
 
@@ -1047,12 +1556,40 @@ now ()
   return (uint32) ebase.simtime;
 }
 
+/* Current simulated time as seen by the executing core. Devices that
+   update their state lazily use this, since ebase.simtime only moves
+   when events are processed. */
+
+uint64
+sim_time ()
+{
+  if ((simcore != NULL) && (simcore->simtime > ebase.simtime))
+    return simcore->simtime;
+  return ebase.simtime;
+}
+
 void
 pwd_enter (struct pstate *sregs)
 {
+  /* a device may wake the core from another thread */
+  bus_lock ();
   sregs->pwd_mode = 1;
   sregs->pwdstart = sregs->simtime;
   sregs->hold += delta;
+  bus_unlock ();
+}
+
+/* Take core cpu out of the idle set of run_sim_mp () when an interrupt
+   or a start request reaches it.  It has not run since it went idle,
+   so its time is brought up to that of the waker. */
+
+void
+mp_wake (int cpu)
+{
+  uint32 bit = 1u << cpu;
+
+  if (__atomic_fetch_and (&mp_idle, ~bit, __ATOMIC_RELAXED) & bit)
+    sregs[cpu].simtime = sim_time ();
 }
 
 void
@@ -1060,6 +1597,10 @@ rt_sync ()
 {
   double walltime, realtime, dtime;
   int64 stime;
+  fexcept_t fexc;
+
+  /* keep any FPU exceptions of the simulated code out of the way */
+  fegetexceptflag (&fexc, FE_ALL_EXCEPT);
   stime = ebase.simtime - ebase.simstart;	/* Total simulated time */
   realtime = (double) ((stime) / 1000000.0 / ebase.freq);
   walltime = ebase.tottime + get_time () - ebase.starttime;
@@ -1070,6 +1611,7 @@ rt_sync ()
 	dtime = 0.1;
       usleep ((useconds_t) (dtime * 1E6));
     }
+  fesetexceptflag (&fexc, FE_ALL_EXCEPT);
 }
 
 int
@@ -1135,47 +1677,1748 @@ void
 reset_all ()
 {
   init_event ();		/* Clear event queue */
+  cpu_alloc (ncpu);
+  pdc_reset ();			/* Drop predecoded instructions */
+  tlb_flush ();
   init_regs (sregs);
   ms->reset ();
 }
 
+/* Make room for the state of n cpus.  Cpus added after start-up, by
+   the ncpu command, come up as after a reset and share the interrupt
+   controller of cpu 0. */
+
 void
-sys_reset ()
+cpu_alloc (int n)
 {
-  reset_all ();
-  sregs[0].trap = 256;		/* Force fake reset trap */
+  struct pstate *ps;
+  struct idleloop *il;
+  int *irl;
+  int i;
+
+  if (n <= ncpu_alloc)
+    return;
+  ps = realloc (sregs, n * sizeof (struct pstate));
+  il = realloc (idle, n * sizeof (struct idleloop));
+  irl = realloc (ext_irl, n * sizeof (int));
+  if ((ps == NULL) || (il == NULL) || (irl == NULL))
+    {
+      printf ("Error, cannot allocate state of %d cpus\n", n);
+      exit (1);
+    }
+  sregs = ps;
+  idle = il;
+  ext_irl = irl;
+  memset (&sregs[ncpu_alloc], 0, (n - ncpu_alloc) * sizeof (struct pstate));
+  memset (&idle[ncpu_alloc], 0, (n - ncpu_alloc) * sizeof (struct idleloop));
+  /* the state may have moved */
+  for (i = 0; i < n; i++)
+    {
+      sregs[i].pd = &sregs[i].pdtmp;
+      sregs[i].fs = (float32 *) sregs[i].fd;
+      sregs[i].fsi = (int32 *) sregs[i].fd;
+    }
+  for (i = ncpu_alloc, ncpu_alloc = n; i < n; i++)
+    {
+      init_cpu (i);
+      sregs[i].intack = sregs[0].intack;
+    }
+  tlb_flush ();
 }
 
-void
-sys_halt ()
+/* Map size bytes of guest memory, zeroed or read from offset in the
+   image file fd.  Anonymous mappings are only committed as pages are
+   touched, so large or idle memories are cheap.  Huge pages come from
+   the reserved pool if it is large enough, otherwise transparent huge
+   pages are requested.  Image mappings are private: pages the guest
+   never writes stay shared with the host page cache. */
+
+static void *
+mem_map (void *old, uint32 oldsize, uint32 size, int fd, uint32 offset)
 {
-  sregs[0].trap = 257;		/* Force fake halt trap */
+  void *p;
+
+#ifdef WIN32
+  free (old);
+  p = calloc (size, 1);
+  if (p && (fd >= 0))
+    {
+      lseek (fd, offset, SEEK_SET);
+      if (read (fd, p, size) != size)
+	printf ("Short read from memory image\n");
+    }
+#else
+  if (old)
+    munmap (old, oldsize);
+  p = MAP_FAILED;
+  if (fd >= 0)
+    p = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset);
+#ifdef MAP_HUGETLB
+  else if (hugepage)
+    p = mmap (NULL, size, PROT_READ | PROT_WRITE,
+	      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+  if ((p == MAP_FAILED) && (fd < 0))
+    {
+      p = mmap (NULL, size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+#ifdef MADV_HUGEPAGE
+      if (hugepage && (p != MAP_FAILED))
+	madvise (p, size, MADV_HUGEPAGE);
+#endif
+    }
+  if (p == MAP_FAILED)
+    p = NULL;
+#endif
+  if (!p)
+    {
+      printf ("Failed to allocate %d K of simulated memory\n", size >> 10);
+      exit (1);
+    }
+  return p;
 }
 
-/* simulate one core instruction-wise */
+/* Memory image given with -image */
+
+static char imgfile[256];
+static struct memimg imghdr;
+
+/* Check that the memory sizes in the image header are ones -ram and
+   -rom accept, and that the memory areas are all in the file, since
+   mapping past its end would fault on first access */
 
 static int
-run_sim_un (sregs, icount, dis)
-     struct pstate *sregs;
-     uint64 icount;
-     int dis;
+img_check (FILE * fp, const struct memimg *h, const char *fname)
 {
-  int irq, mexc, deb;
-  uint32 *inst;
+  struct stat st;
 
-  if (sregs->err_mode)
-    icount = 0;
-  deb = dis || ebase.histlen || ebase.bptnum;
-  mexc = irq = 0;
-  while (icount > 0)
+  if ((h->ramsize < MIN_MEM_SIZE) || (h->ramsize > MAX_RAM_SIZE) ||
+      (h->ramsize & (h->ramsize - 1)) || (h->romsize < MIN_MEM_SIZE) ||
+      (h->romsize > MAX_ROM_SIZE) || (h->romsize & (h->romsize - 1)))
     {
-      if (sregs->pwd_mode)
-	{
-	  sregs->simtime = ebase.evtime;	/* skip forward to next event */
-	  if (ext_irl[sregs->cpu])
-	    irq = arch->check_interrupts (sregs);
-	}
-      else
+      printf ("%s has an invalid memory size\n", fname);
+      return (-1);
+    }
+  if ((fstat (fileno (fp), &st) != 0) ||
+      ((uint64) st.st_size < (uint64) IMG_ALIGN + h->romsize + h->ramsize)
+      || (h->state && ((uint64) st.st_size < h->state)))
+    {
+      printf ("%s is truncated\n", fname);
+      return (-1);
+    }
+  return (0);
+}
+
+/* Check the header of a memory image and select it for mem_alloc ().
+   Returns the entry point, or -1. */
+
+int
+mem_image (const char *fname)
+{
+  FILE *fp;
+
+  if ((fp = fopen (fname, "rb")) == NULL)
+    {
+      printf ("file not found\n");
+      return (-1);
+    }
+  if ((fread (&imghdr, sizeof (imghdr), 1, fp) != 1) ||
+      (memcmp (imghdr.magic, IMG_MAGIC, sizeof (imghdr.magic)) != 0) ||
+      (imghdr.order != IMG_ORDER))
+    {
+      printf ("%s is not a memory image for this host\n", fname);
+      fclose (fp);
+      return (-1);
+    }
+  if (img_check (fp, &imghdr, fname))
+    {
+      fclose (fp);
+      return (-1);
+    }
+  fclose (fp);
+  strncpy (imgfile, fname, sizeof (imgfile) - 1);
+  ebase.cpu = imghdr.cpu;
+  ebase.arch = imghdr.arch;
+  return (imghdr.entry);
+}
+
+/* (Re)allocate RAM and ROM, mapping them from image fd if it is open */
+
+static void
+mem_setup (uint32 ram, uint32 rom, int fd)
+{
+  baseline_drop ();
+  if ((fd >= 0) || (ram != ebase.ramsize))
+    {
+      ramb = mem_map (ramb, ebase.ramsize, ram, fd, IMG_ALIGN + rom);
+      covram = mem_map (covram, ebase.ramsize / 4, ram / 4, -1, 0);
+      ebase.ramsize = ram;
+    }
+  if ((fd >= 0) || (rom != ebase.romsize))
+    {
+      romb = mem_map (romb, ebase.romsize, rom, fd, IMG_ALIGN);
+      ebase.romsize = rom;
+    }
+  pdc_reset ();
+  tlb_flush ();
+}
+
+/* Allocate RAM and ROM, using the -ram/-rom sizes if given, or map
+   them from the memory image */
+
+void
+mem_alloc (uint32 ramdef, uint32 romdef)
+{
+  uint32 ram = ramsize ? ramsize : ramdef;
+  uint32 rom = romsize ? romsize : romdef;
+  int fd = -1;
+
+  if (imgfile[0])
+    {
+      ram = imghdr.ramsize;
+      rom = imghdr.romsize;
+      if ((fd = open (imgfile, O_RDONLY)) < 0)
+	{
+	  printf ("Failed to open %s\n", imgfile);
+	  exit (1);
+	}
+    }
+  mem_setup (ram, rom, fd);
+  if (fd >= 0)
+    {
+      close (fd);
+      printf (" Mapped %s, entry 0x%08x\n", imgfile, imghdr.entry);
+    }
+}
+
+/* Write the non-zero pages of mem at offset, leaving holes for the rest.
+   Returns -1 on a write error. */
+
+static int
+dump_area (FILE * fp, const char *mem, uint32 size, uint32 offset)
+{
+  static const char zero[IMG_PAGE];
+  uint32 i;
+
+  for (i = 0; i < size; i += IMG_PAGE)
+    if (memcmp (&mem[i], zero, IMG_PAGE) != 0)
+      {
+	if ((fseek (fp, offset + i, SEEK_SET) != 0) ||
+	    (fwrite (&mem[i], IMG_PAGE, 1, fp) != 1))
+	  return (-1);
+      }
+  return (0);
+}
+
+/* Write ROM and RAM as a memory image, with the stream left at the
+   end of RAM.  The old file is unlinked first, as it may still be
+   mapped as guest memory. */
+
+static FILE *
+img_create (const char *fname, uint32 state)
+{
+  FILE *fp;
+  struct memimg h;
+
+  remove (fname);
+  if ((fp = fopen (fname, "wb")) == NULL)
+    {
+      printf ("could not create %s\n", fname);
+      return (NULL);
+    }
+  memset (&h, 0, sizeof (h));
+  memcpy (h.magic, IMG_MAGIC, sizeof (h.magic));
+  h.order = IMG_ORDER;
+  h.ramstart = ebase.ramstart;
+  h.ramsize = ebase.ramsize;
+  h.romsize = ebase.romsize;
+  h.entry = last_load_addr;
+  h.cpu = cputype;
+  h.arch = archtype;
+  h.state = state;
+  /* the last byte sets the file size */
+  if ((fwrite (&h, sizeof (h), 1, fp) != 1) ||
+      dump_area (fp, romb, ebase.romsize, IMG_ALIGN) ||
+      dump_area (fp, ramb, ebase.ramsize, IMG_ALIGN + ebase.romsize) ||
+      (fseek (fp, IMG_ALIGN + ebase.romsize + ebase.ramsize - 1, SEEK_SET)
+       != 0) || (fputc (ramb[ebase.ramsize - 1], fp) == EOF))
+    {
+      printf ("error writing %s\n", fname);
+      fclose (fp);
+      remove (fname);
+      return (NULL);
+    }
+  return (fp);
+}
+
+/* Save ROM and RAM to a memory image that -image can map */
+
+int
+mem_dump (const char *fname)
+{
+  FILE *fp;
+
+  if ((fp = img_create (fname, 0)) == NULL)
+    return (-1);
+  if (fclose (fp) != 0)
+    {
+      printf ("error writing %s\n", fname);
+      remove (fname);
+      return (-1);
+    }
+  printf ("saved memory image to %s\n", fname);
+  return (0);
+}
+
+/* Checkpoints.  Devices register their static state and the callbacks
+   they put in the event queue, normally from their init functions; both
+   are saved by name so that the registration order does not matter.
+   Host side resources (files, sockets, terminals) are not saved. */
+
+struct ckblk
+{
+  char name[CKPT_NAMELEN];
+  void *addr;
+  uint32 size;
+};
+
+struct ckev
+{
+  char name[CKPT_NAMELEN];
+  void (*cfunc) ();
+};
+
+static struct ckblk ckblk[CKPT_MAX];
+static int ckblkn;
+static struct ckev ckev[CKPT_EVMAX];
+static int ckevn;
+
+/* Register size bytes at addr as device state.  A second registration
+   of the same name replaces the first. */
+
+void
+ckpt_state (const char *name, void *addr, uint32 size)
+{
+  int i;
+
+  for (i = 0; i < ckblkn; i++)
+    if (strncmp (ckblk[i].name, name, CKPT_NAMELEN) == 0)
+      break;
+  if (i == CKPT_MAX)
+    {
+      printf ("Error, too many checkpoint blocks\n");
+      return;
+    }
+  if (i == ckblkn)
+    ckblkn++;
+  snprintf (ckblk[i].name, CKPT_NAMELEN, "%s", name);
+  ckblk[i].addr = addr;
+  ckblk[i].size = size;
+}
+
+/* Register an event callback */
+
+void
+ckpt_event (const char *name, void (*cfunc) ())
+{
+  int i;
+
+  for (i = 0; i < ckevn; i++)
+    if (strncmp (ckev[i].name, name, CKPT_NAMELEN) == 0)
+      break;
+  if (i == CKPT_EVMAX)
+    {
+      printf ("Error, too many checkpoint events\n");
+      return;
+    }
+  if (i == ckevn)
+    ckevn++;
+  snprintf (ckev[i].name, CKPT_NAMELEN, "%s", name);
+  ckev[i].cfunc = cfunc;
+}
+
+/* Stands in for callbacks that were not registered when the checkpoint
+   was taken, e.g. host polling, so that the queue keeps its shape */
+
+static void
+ckpt_lost (int32 arg)
+{
+}
+
+/* Write the processor, event queue and device state.  Returns -1 if
+   any of the writes failed. */
+
+static int
+state_save (FILE * fp)
+{
+  char name[CKPT_NAMELEN];
+  uint32 i, j;
+
+  i = ncpu;
+  fwrite (&i, sizeof (i), 1, fp);
+  fwrite (&cpu, sizeof (cpu), 1, fp);
+  fwrite (sregs, sizeof (struct pstate), ncpu, fp);
+  fwrite (&ebase, sizeof (ebase), 1, fp);
+
+  /* event cells, with the callback replaced by its name */
+  for (i = 0; i < ebase.evmax; i++)
+    {
+      memset (name, 0, sizeof (name));
+      if (ebase.evcell[i].pos != EVC_NONE)
+	{
+	  for (j = 0; j < ckevn; j++)
+	    if (ckev[j].cfunc == ebase.evcell[i].cfunc)
+	      memcpy (name, ckev[j].name, CKPT_NAMELEN);
+	  if (!name[0] && sis_verbose)
+	    printf ("event at %" PRIu64 " not registered, not saved\n",
+		    ebase.evcell[i].time);
+	}
+      fwrite (name, sizeof (name), 1, fp);
+      fwrite (&ebase.evcell[i], sizeof (struct evcell), 1, fp);
+    }
+  fwrite (ebase.eq, sizeof (uint32), ebase.evnum, fp);
+
+  /* device state, terminated by an empty name */
+  for (i = 0; i < ckblkn; i++)
+    {
+      fwrite (ckblk[i].name, CKPT_NAMELEN, 1, fp);
+      fwrite (&ckblk[i].size, sizeof (uint32), 1, fp);
+      fwrite (ckblk[i].addr, ckblk[i].size, 1, fp);
+    }
+  memset (name, 0, sizeof (name));
+  fwrite (name, sizeof (name), 1, fp);
+  return (ferror (fp) ? -1 : 0);
+}
+
+/* Read back what state_save () wrote */
+
+static int
+state_restore (FILE * fp)
+{
+  struct pstate *ps;
+  struct estate es;
+  struct evcell ev;
+  char name[CKPT_NAMELEN];
+  uint32 i, j, n, act, size;
+
+  if ((fread (&n, sizeof (n), 1, fp) != 1) || (n != ncpu))
+    {
+      printf ("state was saved with a different number of cpus\n");
+      return (-1);
+    }
+  ps = malloc (n * sizeof (struct pstate));
+  if ((fread (&act, sizeof (act), 1, fp) != 1) || (act >= n) ||
+      (fread (ps, sizeof (struct pstate), n, fp) != n) ||
+      (fread (&es, sizeof (es), 1, fp) != 1))
+    {
+      printf ("state is truncated\n");
+      free (ps);
+      return (-1);
+    }
+
+  /* processors, keeping the host pointers of this process */
+  for (i = 0; i < n; i++)
+    {
+      ps[i].fs = sregs[i].fs;
+      ps[i].fsi = sregs[i].fsi;
+      ps[i].histbuf = sregs[i].histbuf;
+      ps[i].intack = sregs[i].intack;
+      ps[i].pdtmp = sregs[i].pdtmp;
+      ps[i].pd = &sregs[i].pdtmp;
+      memcpy (ps[i].tlb, sregs[i].tlb, sizeof (ps[i].tlb));
+      sregs[i] = ps[i];
+    }
+  free (ps);
+  cpu = act;
+  tlb_flush ();
+  memset (idle, 0, ncpu_alloc * sizeof (struct idleloop));
+
+  /* system state; debugger settings and host timing stay as they are */
+  ebase.evseq = es.evseq;
+  ebase.simtime = es.simtime;
+  ebase.freq = es.freq;
+  ebase.simstart = es.simstart;
+  ebase.iosfx = es.iosfx;
+  ebase.ramstart = es.ramstart;
+  ebase.bpcpu = es.bpcpu;
+  ebase.bend = es.bend;
+  ebase.cpu = es.cpu;
+  ebase.arch = es.arch;
+
+  /* event queue, with the same cells so that device handles stay valid */
+  while (ebase.evmax < es.evmax)
+    if (!ev_grow ())
+      {
+	printf ("Error, too many events in event queue\n");
+	exit (1);
+      }
+  for (i = 0; i < es.evmax; i++)
+    {
+      fread (name, sizeof (name), 1, fp);
+      fread (&ev, sizeof (ev), 1, fp);
+      ev.cfunc = NULL;
+      if (ev.pos != EVC_NONE)
+	{
+	  ev.cfunc = ckpt_lost;
+	  for (j = 0; j < ckevn; j++)
+	    if (strncmp (ckev[j].name, name, CKPT_NAMELEN) == 0)
+	      ev.cfunc = ckev[j].cfunc;
+	  if ((ev.cfunc == ckpt_lost) && name[0])
+	    printf ("Warning, event %s not restored\n", name);
+	}
+      ebase.evcell[i] = ev;
+    }
+  for (; i < ebase.evmax; i++)
+    {
+      ebase.evcell[i].pos = EVC_NONE;
+      ebase.evcell[i].nxt = (i + 1 < ebase.evmax) ? i + 1 : es.freeq;
+    }
+  /* cells beyond the saved pool go in front of the free list */
+  ebase.freeq = (es.evmax < ebase.evmax) ? es.evmax : es.freeq;
+  ebase.evnum = es.evnum;
+  fread (ebase.eq, sizeof (uint32), es.evnum, fp);
+  ebase.evtime = ebase.evnum ? ebase.evcell[ebase.eq[0]].time : UINT64_MAX;
+
+  /* devices */
+  while ((fread (name, sizeof (name), 1, fp) == 1) && name[0])
+    {
+      if (fread (&size, sizeof (size), 1, fp) != 1)
+	break;
+      for (j = 0; j < ckblkn; j++)
+	if (strncmp (ckblk[j].name, name, CKPT_NAMELEN) == 0)
+	  break;
+      if ((j < ckblkn) && (ckblk[j].size == size))
+	fread (ckblk[j].addr, size, 1, fp);
+      else
+	{
+	  printf ("Warning, device state %s not restored\n", name);
+	  fseek (fp, size, SEEK_CUR);
+	}
+    }
+  return (0);
+}
+
+/* Save memory and the complete simulator state to fname */
+
+int
+ckpt_save (const char *fname)
+{
+  FILE *fp;
+  uint32 state;
+  int res;
+
+  state = IMG_ALIGN + ebase.romsize + ebase.ramsize;
+  if ((fp = img_create (fname, state)) == NULL)
+    return (-1);
+  res = (fseek (fp, state, SEEK_SET) != 0) || state_save (fp);
+  if ((fclose (fp) != 0) || res)
+    {
+      printf ("error writing %s\n", fname);
+      remove (fname);
+      return (-1);
+    }
+  printf ("saved checkpoint to %s\n", fname);
+  return (0);
+}
+
+/* Restore a checkpoint taken with the same simulator and options.
+   Memory is mapped copy-on-write from the file, like -image. */
+
+int
+ckpt_restore (const char *fname)
+{
+  FILE *fp;
+  struct memimg h;
+  uint32 n;
+  int fd, res;
+
+  if ((fp = fopen (fname, "rb")) == NULL)
+    {
+      printf ("file not found\n");
+      return (-1);
+    }
+  if ((fread (&h, sizeof (h), 1, fp) != 1) ||
+      (memcmp (h.magic, IMG_MAGIC, sizeof (h.magic)) != 0) ||
+      (h.order != IMG_ORDER) || !h.state)
+    {
+      printf ("%s is not a checkpoint for this host\n", fname);
+      fclose (fp);
+      return (-1);
+    }
+  if (img_check (fp, &h, fname))
+    {
+      fclose (fp);
+      return (-1);
+    }
+  fseek (fp, h.state, SEEK_SET);
+  if ((h.cpu != cputype) || (h.arch != archtype)
+      || (fread (&n, sizeof (n), 1, fp) != 1) || (n != ncpu))
+    {
+      printf ("%s was saved from a different system\n", fname);
+      fclose (fp);
+      return (-1);
+    }
+  fseek (fp, h.state, SEEK_SET);
+
+  /* memory */
+  if ((fd = open (fname, O_RDONLY)) < 0)
+    {
+      printf ("Failed to open %s\n", fname);
+      exit (1);
+    }
+  mem_setup (h.ramsize, h.romsize, fd);
+  close (fd);
+  last_load_addr = h.entry;
+
+  res = state_restore (fp);
+  fclose (fp);
+  if (res == 0)
+    printf ("restored checkpoint from %s\n", fname);
+  return (res);
+}
+
+/* Baseline for fast rewinds.  baseline_set () keeps the processor,
+   event queue and device state, and flags every page PDC_CLEAN.  The
+   first store to a clean page (see PDC_WRITE) copies the page before it
+   is modified, so baseline_rewind () only has to copy back the pages
+   written since, however large the memory is. */
+
+struct basepage
+{
+  uint32 page;			/* guest page number */
+  uint32 copy;			/* index of its contents in basemem */
+};
+
+static FILE *basefp;		/* saved state, NULL without a baseline */
+static uint32 *basecopy[2];	/* RAM, ROM host pages: copy + 1, or 0 */
+static char *basemem;		/* page contents at the baseline */
+static uint32 basecopies, basemax;
+static struct basepage *basedirty;	/* pages written since */
+static uint32 basendirty, basedmax;
+
+/* Host memory of a guest page, and its entry in basecopy */
+
+static uint32 *
+base_page (uint32 page, char **mem)
+{
+  char *p = ms->get_mem_ptr (page << PDC_PAGEBITS, 1);
+
+  *mem = p;
+  if ((p >= ramb) && (p < ramb + ebase.ramsize))
+    return &basecopy[0][(p - ramb) >> PDC_PAGEBITS];
+  if ((p >= romb) && (p < romb + ebase.romsize))
+    return &basecopy[1][(p - romb) >> PDC_PAGEBITS];
+  return NULL;
+}
+
+/* First store to a clean page */
+
+static void
+base_write (uint32 page)
+{
+  uint32 *copy;
+  char *mem;
+
+  pdc_flags[page] &= ~PDC_CLEAN;
+  if ((copy = base_page (page, &mem)) == NULL)
+    return;
+  if (*copy == 0)
+    {
+      if (basecopies == basemax)
+	{
+	  basemax = basemax ? basemax * 2 : 64;
+	  if ((basemem = realloc (basemem, basemax * PDC_PAGESIZE)) == NULL)
+	    {
+	      printf ("Error, out of memory for the baseline\n");
+	      exit (1);
+	    }
+	}
+      memcpy (&basemem[basecopies * PDC_PAGESIZE], mem, PDC_PAGESIZE);
+      *copy = ++basecopies;
+    }
+  if (basendirty == basedmax)
+    {
+      basedmax = basedmax ? basedmax * 2 : 64;
+      basedirty = realloc (basedirty, basedmax * sizeof (struct basepage));
+      if (basedirty == NULL)
+	{
+	  printf ("Error, out of memory for the baseline\n");
+	  exit (1);
+	}
+    }
+  basedirty[basendirty].page = page;
+  basedirty[basendirty].copy = *copy - 1;
+  basendirty++;
+}
+
+void
+baseline_drop ()
+{
+  uint32 i;
+
+  if (basefp == NULL)
+    return;
+  fclose (basefp);
+  basefp = NULL;
+  free (basecopy[0]);
+  free (basecopy[1]);
+  free (basemem);
+  free (basedirty);
+  basemem = NULL;
+  basedirty = NULL;
+  basecopies = basemax = basendirty = basedmax = 0;
+  for (i = 0; i < (1 << (32 - PDC_PAGEBITS)); i++)
+    pdc_flags[i] &= ~PDC_CLEAN;
+}
+
+/* Make the current state the one baseline_rewind () returns to */
+
+int
+baseline_set ()
+{
+  uint32 i;
+
+  baseline_drop ();
+  if ((basefp = tmpfile ()) == NULL)
+    {
+      printf ("could not create baseline\n");
+      return (-1);
+    }
+  if (state_save (basefp))
+    {
+      printf ("could not create baseline\n");
+      baseline_drop ();
+      return (-1);
+    }
+  basecopy[0] = calloc (ebase.ramsize >> PDC_PAGEBITS, sizeof (uint32));
+  basecopy[1] = calloc (ebase.romsize >> PDC_PAGEBITS, sizeof (uint32));
+  for (i = 0; i < (1 << (32 - PDC_PAGEBITS)); i++)
+    pdc_flags[i] |= PDC_CLEAN;
+  return (0);
+}
+
+/* Return to the baseline.  Returns the number of pages copied back, or
+   -1 if there is no baseline. */
+
+int
+baseline_rewind ()
+{
+  struct basepage *d;
+  char *mem;
+  uint32 i;
+
+  if (basefp == NULL)
+    return (-1);
+  for (i = 0; i < basendirty; i++)
+    {
+      d = &basedirty[i];
+      base_page (d->page, &mem);
+      memcpy (mem, &basemem[d->copy * PDC_PAGESIZE], PDC_PAGESIZE);
+      pdc_flush (d->page << PDC_PAGEBITS, PDC_PAGESIZE);
+      pdc_flags[d->page] |= PDC_CLEAN;
+    }
+  basendirty = 0;
+  rewind (basefp);
+  state_restore (basefp);
+  return (i);
+}
+
+void
+sys_reset ()
+{
+  reset_all ();
+  sregs[0].trap = 256;		/* Force fake reset trap */
+}
+
+void
+sys_halt ()
+{
+  sregs[0].trap = 257;		/* Force fake halt trap */
+}
+
+/* Predecoded instruction cache, shared by all cores.  Decoded
+   instructions are kept in 4 KiB pages held in a small direct-mapped
+   table.  pdc_flags[] marks the pages currently cached so that memory
+   stores can check cheaply whether they hit code (see PDC_WRITE).  Only
+   instructions fetched from plain RAM or ROM are cached.  The same
+   flags catch the first store to each page after a baseline. */
+
+struct pdpage
+{
+  uint32 page;
+  struct pdinst inst[PDC_PAGESIZE / 2];
+  struct jitblk **blk;		/* translated blocks by start address */
+  uint32 nblk;
+  uint32 jlo, jhi;		/* entries covered by translated blocks */
+  unsigned char heat[PDC_PAGESIZE / 2];	/* executions before translation */
+};
+
+unsigned char pdc_flags[1 << (32 - PDC_PAGEBITS)];
+static struct pdpage *pdc_slot[PDC_SLOTS];
+
+/* Placeholder for addresses where no block can be translated */
+static struct jitblk jit_none;
+
+/* Bumped whenever blocks are freed, invalidating all chain links */
+static uint32 jit_gen;
+
+/* Stands in for an instruction with no effect in a delay slot */
+
+uint32
+jit_nop (struct pstate *sregs, const struct jitop *op)
+{
+  return 0;
+}
+
+static void
+jit_drop (struct pdpage *pg)
+{
+  uint32 i;
+
+  if (pg->nblk)
+    {
+      for (i = 0; i < PDC_PAGESIZE / 2; i++)
+	if ((pg->blk[i] != NULL) && (pg->blk[i] != &jit_none))
+	  free (pg->blk[i]);
+      memset (pg->blk, 0, (PDC_PAGESIZE / 2) * sizeof (struct jitblk *));
+      pg->nblk = 0;
+      pg->jlo = PDC_PAGESIZE / 2;
+      pg->jhi = 0;
+      jit_gen++;
+    }
+  memset (pg->heat, 0, sizeof (pg->heat));
+}
+
+/* Serializes the devices, the event queue and the predecode cache
+   while cores run on host threads.  It is recursive since a device
+   access can reach pdc_flush. */
+
+static pthread_mutex_t bus_mutex;
+static pthread_once_t bus_once = PTHREAD_ONCE_INIT;
+
+static void
+bus_init (void)
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init (&attr);
+  pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init (&bus_mutex, &attr);
+  pthread_mutexattr_destroy (&attr);
+}
+
+void
+bus_lock (void)
+{
+  if (mt_running)
+    pthread_mutex_lock (&bus_mutex);
+}
+
+void
+bus_unlock (void)
+{
+  if (mt_running)
+    pthread_mutex_unlock (&bus_mutex);
+}
+
+/* Invalidate the entries overlapping addr .. addr + len - 1 */
+
+void
+pdc_flush (uint32 addr, uint32 len)
+{
+  struct pdpage *pg;
+  uint32 start, end, page, first, last;
+
+  bus_lock ();
+  /* a 32-bit instruction may start on the halfword before addr */
+  start = addr - ((addr & (PDC_PAGESIZE - 1)) < 2 ?
+		  (addr & (PDC_PAGESIZE - 1)) : 2);
+  end = addr + len - 1;
+  if ((len == 0) || (end < addr))
+    end = 0xffffffff;
+  for (page = start >> PDC_PAGEBITS; page <= (end >> PDC_PAGEBITS); page++)
+    {
+      if ((pdc_flags[page] & PDC_CLEAN) && (page >= (addr >> PDC_PAGEBITS)))
+	base_write (page);
+      if (pdc_flags[page] & PDC_VALID)
+	{
+	  pg = pdc_slot[page & (PDC_SLOTS - 1)];
+	  first = (page == (start >> PDC_PAGEBITS)) ?
+	    (start & (PDC_PAGESIZE - 1)) >> 1 : 0;
+	  last = (page == (end >> PDC_PAGEBITS)) ?
+	    (end & (PDC_PAGESIZE - 1)) >> 1 : (PDC_PAGESIZE / 2) - 1;
+	  if (pg->nblk && (first <= pg->jhi) && (last >= pg->jlo))
+	    jit_drop (pg);
+	  for (; first <= last; first++)
+	    pg->inst[first].len = 0;
+	}
+      if (page == 0xfffff)
+	break;
+    }
+  bus_unlock ();
+}
+
+/* Invalidate the whole cache, e.g. after a change of memory timing */
+
+void
+pdc_reset ()
+{
+  int i;
+
+  for (i = 0; i < PDC_SLOTS; i++)
+    if (pdc_slot[i] != NULL)
+      {
+	pdc_flags[pdc_slot[i]->page] &= ~PDC_VALID;
+	jit_drop (pdc_slot[i]);
+      }
+}
+
+/* Drop all TLB entries, e.g. after a change of memory configuration */
+
+void
+tlb_flush ()
+{
+  int i, j;
+
+  for (i = 0; i < ncpu_alloc; i++)
+    for (j = 0; j < TLB_ENTRIES; j++)
+      sregs[i].tlb[j].rtag = sregs[i].tlb[j].wtag = TLB_NONE;
+}
+
+/* Map the page of addr if it is plain memory.  Other pages leave the
+   entry alone, so that polling a device does not evict RAM. */
+
+static void
+tlb_fill (struct pstate *sregs, uint32 addr)
+{
+  struct tlbent *e, tmp;
+  uint32 page = addr & ~(TLB_PAGESIZE - 1);
+  int perm;
+
+  if ((ms->map_page == NULL) || !(perm = ms->map_page (page, &tmp)))
+    return;
+  e = &sregs->tlb[(addr >> TLB_PAGEBITS) & (TLB_ENTRIES - 1)];
+  *e = tmp;
+  e->rtag = (perm & TLB_R) ? page : TLB_NONE;
+  e->wtag = (perm & TLB_W) ? page : TLB_NONE;
+}
+
+int
+tlb_miss_read (struct pstate *sregs, uint32 addr, uint32 * data, int32 * ws)
+{
+  int mexc;
+
+  bus_lock ();
+  tlb_fill (sregs, addr);
+  mexc = ms->memory_read (addr, data, ws);
+  bus_unlock ();
+  return mexc;
+}
+
+int
+tlb_miss_write (struct pstate *sregs, uint32 addr, uint32 * data, int32 sz,
+		int32 * ws)
+{
+  int mexc;
+
+  sregs->wmiss++;
+  bus_lock ();
+  tlb_fill (sregs, addr);
+  mexc = ms->memory_write (addr, data, sz, ws);
+  bus_unlock ();
+  return mexc;
+}
+
+/* Host memory of the word at addr for an atomic instruction of a core
+   on a host thread, or NULL if it is not in RAM.  The caller updates it
+   with a host atomic operation, so that stores of the other cores
+   cannot slip in between the read and the write.  ws gets the
+   waitstates of a read and a write. */
+
+uint32 *
+mt_word (struct pstate *sregs, uint32 addr, int32 * ws)
+{
+  struct tlbent *e = &sregs->tlb[(addr >> TLB_PAGEBITS) & (TLB_ENTRIES - 1)];
+  uint32 page = addr & ~(TLB_PAGESIZE - 1);
+
+  if ((e->rtag != page) || (e->wtag != page))
+    {
+      sregs->wmiss++;
+      bus_lock ();
+      tlb_fill (sregs, addr);
+      bus_unlock ();
+      if ((e->rtag != page) || (e->wtag != page))
+	return NULL;
+    }
+  PDC_WRITE (addr & ~3, 4);
+  *ws = e->rws + e->wws[2];
+  return (uint32 *) & e->mem[addr & (TLB_PAGESIZE - 4)];
+}
+
+static int
+pdc_miss (struct pstate *sregs)
+{
+  uint32 pc = sregs->pc;
+  uint32 page = pc >> PDC_PAGEBITS;
+  struct pdpage *pg;
+  struct pdinst *pd, *slot = NULL;
+  char *mem;
+  int mexc, len;
+
+  bus_lock ();
+  mexc = ms->memory_iread (pc, &sregs->inst, (int32 *) & sregs->hold);
+  if (mexc || (arch->predecode == NULL))
+    {
+      bus_unlock ();
+      return mexc;
+    }
+  pd = &sregs->pdtmp;
+  mem = ms->get_mem_ptr (pc, 4);
+  /* stores invalidate by RAM offset, so code fetched through a RAM
+     alias is predecoded but not cached */
+  if ((mem != NULL) && (mem != (char *) -1) && (mem >= ramb)
+      && (mem < ramb + ebase.ramsize) && (mem != ramb + (pc - ebase.ramstart)))
+    mem = NULL;
+  if ((mem != NULL) && (mem != (char *) -1) && (sregs->hold < 256)
+      && ((pc & (PDC_PAGESIZE - 1)) < (PDC_PAGESIZE - 2)))
+    {
+      pg = pdc_slot[page & (PDC_SLOTS - 1)];
+      if (pg == NULL)
+	{
+	  pg = (struct pdpage *) calloc (1, sizeof (struct pdpage));
+	  if (pg != NULL)
+	    {
+	      pdc_slot[page & (PDC_SLOTS - 1)] = pg;
+	      pg->page = page;
+	      pg->jlo = PDC_PAGESIZE / 2;
+	      pdc_flags[page] |= PDC_VALID;
+	    }
+	}
+      else if ((pg->page != page) || !(pdc_flags[page] & PDC_VALID))
+	{
+	  /* With -mt other cores may be running from the cached page,
+	     so it stays until a miss after the run */
+	  if (mt_running && (pdc_flags[pg->page] & PDC_VALID))
+	    pg = NULL;
+	  else
+	    {
+	      pdc_flags[pg->page] &= ~PDC_VALID;
+	      memset (pg->inst, 0, sizeof (pg->inst));
+	      jit_drop (pg);
+	      pg->page = page;
+	      pdc_flags[page] |= PDC_VALID;
+	    }
+	}
+      if (pg != NULL)
+	slot = &pg->inst[(pc & (PDC_PAGESIZE - 1)) >> 1];
+    }
+  if (!mt_running && (slot != NULL))
+    pd = slot;
+  if ((slot == NULL) || !mt_running || (slot->len == 0))
+    {
+      pd->inst = sregs->inst;
+      pd->hold = sregs->hold;
+      pd->flags = 0;
+      arch->predecode (pd);
+    }
+  if (mt_running && (slot != NULL))
+    {
+      /* publish the entry to the other cores, its length last */
+      if (slot->len == 0)
+	{
+	  len = pd->len;
+	  pd->len = 0;
+	  *slot = *pd;
+	  __atomic_store_n (&slot->len, len, __ATOMIC_RELEASE);
+	}
+      pd = slot;
+    }
+  bus_unlock ();
+  sregs->pd = pd;
+  return 0;
+}
+
+/* Fetch the instruction at pc, using the predecode cache if possible */
+
+static inline int
+fetch_inst (struct pstate *sregs)
+{
+  uint32 pc = sregs->pc;
+  struct pdinst *pd;
+
+  if (pdc_flags[pc >> PDC_PAGEBITS] & PDC_VALID)
+    {
+      pd = &pdc_slot[(pc >> PDC_PAGEBITS) & (PDC_SLOTS - 1)]->inst
+	[(pc & (PDC_PAGESIZE - 1)) >> 1];
+      if (__atomic_load_n (&pd->len, __ATOMIC_ACQUIRE))
+	{
+	  sregs->pd = pd;
+	  sregs->inst = pd->inst;
+	  sregs->hold = pd->hold;
+	  return 0;
+	}
+    }
+  return pdc_miss (sregs);
+}
+
+/* Count the instruction mix of -stat from the predecode flags, n
+   times.  Only the stat run loop variants call this. */
+
+static inline void
+stat_inst (struct pstate *sregs, int flags, int64 n)
+{
+  if (flags & PD_DOUBLE)
+    n *= 2;
+  if (flags & PD_BRANCH)
+    sregs->nbranch += n;
+  if (flags & PD_LOAD)
+    sregs->nload += n;
+  if (flags & PD_STORE)
+    sregs->nstore += n;
+}
+
+static void
+jit_mix (uint32 * mix, int flags)
+{
+  uint32 n = (flags & PD_DOUBLE) ? 2 : 1;
+
+  if (flags & PD_BRANCH)
+    mix[0] += n;
+  if (flags & PD_LOAD)
+    mix[1] += n;
+  if (flags & PD_STORE)
+    mix[2] += n;
+}
+
+/* Read, predecode and translate the instruction at addr */
+
+static uint32
+jit_insn (uint32 addr, struct pdinst *pd, struct jitop *op, uint32 * extra)
+{
+  char *mem;
+  int32 ws;
+
+  mem = ms->get_mem_ptr (addr, 4);
+  if ((mem == NULL) || (mem == (char *) -1)
+      || ms->memory_iread (addr, &pd->inst, &ws) || (ws > 254))
+    return 0;
+  pd->hold = ws;
+  pd->flags = 0;
+  arch->predecode (pd);
+  return arch->translate (pd, addr, op, extra);
+}
+
+#ifdef JIT_X86
+/* Host code of the translated blocks, allocated from the start of
+   jit_code.  Dropped blocks leave their code behind; once the buffer
+   is full, all blocks are dropped at the next jit_run () and it is
+   filled again from the start. */
+
+#define JIT_CODESIZE	(16 << 20)
+#define JIT_MAXCODE	(64 << 10)	/* room for any block */
+
+static unsigned char *jit_code;
+static uint32 jit_codelen;
+static int jit_codefull;
+
+static void
+jit_flush (void)
+{
+  int i;
+
+  for (i = 0; i < PDC_SLOTS; i++)
+    if (pdc_slot[i] != NULL)
+      jit_drop (pdc_slot[i]);
+  jit_codelen = 0;
+  jit_codefull = 0;
+}
+#endif
+
+/* Give blk host code if the host and the architecture allow */
+
+static void
+jit_emit (struct jitblk *blk)
+{
+#ifdef JIT_X86
+  uint32 len;
+
+  blk->code = NULL;
+  if (!jithost || (arch->emit == NULL) || jit_codefull)
+    return;
+  if (jit_code == NULL)
+    jit_code = (unsigned char *) mmap (NULL, JIT_CODESIZE,
+				       PROT_READ | PROT_WRITE | PROT_EXEC,
+				       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (jit_code == MAP_FAILED)
+    return;
+  len = arch->emit (blk, jit_code + jit_codelen, JIT_CODESIZE - jit_codelen);
+  if (len == 0)
+    {
+      if ((JIT_CODESIZE - jit_codelen) < JIT_MAXCODE)
+	jit_codefull = 1;
+      return;
+    }
+  blk->code = (uint32 (*)(struct pstate *)) (jit_code + jit_codelen);
+  jit_codelen += (len + 15) & ~15;
+#else
+  blk->code = NULL;
+#endif
+}
+
+/* Set up op for the instruction at addr, preceded in the block by
+   ninst instructions of cycles cycles, hold of them fetch waitstates,
+   with the branches, loads and stores in mix, the last loading ild */
+
+static void
+jit_before (struct jitop *op, uint32 addr, uint32 ninst, uint32 cycles,
+	    uint32 hold, const uint32 * mix, uint32 ild)
+{
+  op->pc = addr;
+  op->ninst = ninst;
+  op->cycles = cycles;
+  op->hold = hold;
+  op->mix[0] = mix[0];
+  op->mix[1] = mix[1];
+  op->mix[2] = mix[2];
+  op->ild = ild;
+  op->lreg = 0;
+  op->flags = 0;
+}
+
+/* Translate the block starting at pc.  Instructions are read and
+   decoded afresh so the predecode cache is left untouched; the block
+   never extends past the page, so invalidating the page's predecoded
+   entries also drops it. */
+
+static struct jitblk *
+jit_translate (uint32 pc)
+{
+  struct jitop ops[JIT_MAXINST + 1];
+  struct jitblk *blk;
+  struct pdinst pd, dpd;
+  uint32 addr, icnt, dcnt, extra, dextra, nops, nhid, ninst, cycles, hold;
+  uint32 lcycles, lhold, lflags, mix[3], dmix[3], ild;
+
+  addr = pc;
+  nops = nhid = ninst = cycles = hold = extra = lcycles = lhold = ild = 0;
+  lflags = mix[0] = mix[1] = mix[2] = 0;
+  while ((ninst < JIT_MAXINST - 1) && ((addr >> PDC_PAGEBITS) ==
+				       (pc >> PDC_PAGEBITS))
+	 && ((addr & (PDC_PAGESIZE - 1)) < (PDC_PAGESIZE - 2)))
+    {
+      dextra = extra;
+      jit_before (&ops[nops], addr, ninst, cycles, hold, mix, ild);
+      icnt = jit_insn (addr, &pd, &ops[nops], &extra);
+      if (icnt == 0)
+	break;
+      if (pd.flags & PD_DELAY)
+	{
+	  /* translate the delay slot too, or leave both to the
+	     interpreter */
+	  memcpy (dmix, mix, sizeof (mix));
+	  jit_mix (dmix, pd.flags);
+	  jit_before (&ops[nops + 1], addr + pd.len, ninst + 1,
+		      cycles + icnt + pd.hold, hold + pd.hold, dmix,
+		      ops[nops].lreg);
+	  ops[nops + 1].flags = JIT_SLOT;
+	  ops[nops + 1].idx = nops + 1;
+	  if ((ops[nops].fn == NULL)
+	      || (((addr + pd.len) >> PDC_PAGEBITS) != (pc >> PDC_PAGEBITS))
+	      || (((addr + pd.len) & (PDC_PAGESIZE - 1)) >=
+		  (PDC_PAGESIZE - 2)))
+	    dcnt = 0;
+	  else
+	    dcnt = jit_insn (addr + pd.len, &dpd, &ops[nops + 1], &extra);
+	  if ((dcnt == 0) || (dpd.flags & PD_BLKEND))
+	    {
+	      extra = dextra;
+	      break;
+	    }
+	  if (ops[nops + 1].fn == NULL)
+	    ops[nops + 1].fn = jit_nop;
+	  nhid = 1;
+	}
+      ild = ops[nops].lreg;
+      if (ops[nops].fn != NULL)
+	{
+	  ops[nops].idx = nops;
+	  nops++;
+	}
+      ninst++;
+      cycles += icnt + pd.hold;
+      hold += pd.hold;
+      lcycles = icnt + pd.hold;
+      lhold = pd.hold;
+      lflags = pd.flags;
+      jit_mix (mix, pd.flags);
+      addr += pd.len;
+      if (nhid)
+	{
+	  ild = ops[nops].lreg;
+	  ninst++;
+	  cycles += dcnt + dpd.hold;
+	  hold += dpd.hold;
+	  lcycles = dcnt + dpd.hold;
+	  lhold = dpd.hold;
+	  lflags = dpd.flags;
+	  jit_mix (mix, dpd.flags);
+	  addr += dpd.len;
+	}
+      if (pd.flags & PD_BLKEND)
+	break;
+    }
+  if (ninst == 0)
+    return &jit_none;
+  blk = (struct jitblk *) malloc (sizeof (struct jitblk) +
+				  (nops + nhid) * sizeof (struct jitop));
+  if (blk == NULL)
+    return &jit_none;
+  blk->pc = pc;
+  blk->ninst = ninst;
+  blk->nops = nops;
+  blk->end = addr;
+  blk->cycles = cycles;
+  blk->hold = hold;
+  blk->extra = extra;
+  blk->lcycles = lcycles;
+  blk->lhold = lhold;
+  blk->lflags = lflags;
+  blk->ild = ild;
+  memcpy (blk->mix, mix, sizeof (mix));
+  blk->gen = jit_gen;
+  blk->next[0] = blk->next[1] = NULL;
+  memcpy (blk->op, ops, (nops + nhid) * sizeof (struct jitop));
+  jit_emit (blk);
+  return blk;
+}
+
+/* Find the translated block at pc, translating it once it is hot */
+
+static inline struct jitblk *
+jit_lookup (uint32 pc)
+{
+  struct pdpage *pg;
+  uint32 i;
+
+  if (!(pdc_flags[pc >> PDC_PAGEBITS] & PDC_VALID))
+    return NULL;
+  pg = pdc_slot[(pc >> PDC_PAGEBITS) & (PDC_SLOTS - 1)];
+  i = (pc & (PDC_PAGESIZE - 1)) >> 1;
+  if ((pg->blk != NULL) && (pg->blk[i] != NULL))
+    return pg->blk[i];
+  if (++pg->heat[i] < JIT_HOT)
+    return NULL;
+  if (pg->blk == NULL)
+    {
+      pg->blk = (struct jitblk **) calloc (PDC_PAGESIZE / 2,
+					   sizeof (struct jitblk *));
+      if (pg->blk == NULL)
+	return NULL;
+    }
+  pg->blk[i] = jit_translate (pc);
+  pg->nblk++;
+  if (pg->blk[i] != &jit_none)
+    {
+      if (i < pg->jlo)
+	pg->jlo = i;
+      if (((pg->blk[i]->end - 1) & (PDC_PAGESIZE - 1)) >> 1 > pg->jhi)
+	pg->jhi = ((pg->blk[i]->end - 1) & (PDC_PAGESIZE - 1)) >> 1;
+    }
+  return pg->blk[i];
+}
+
+/* Idle loop detection.  Code waiting for an interrupt or polling a
+   device typically spins in a short loop that stores nothing.  If
+   such a loop also reads no device register with side effects or
+   with a value that changes with time, such as a timer counter, and
+   takes no trap, the core comes back to the loop head in the same
+   state every iteration, and since nothing else can change until the
+   next event, each further iteration runs exactly like the last one.
+   idle_check () is called when a core is at a block boundary with
+   its time accounted and no event due.  Once it has seen the same
+   state twice at the same pc, it skips whole iterations up to the
+   next event, charging their cycles and instruction counts, so the
+   result is the same as running them.  Returns the number of
+   instructions skipped. */
+
+static void
+idle_mark (struct pstate *sregs, struct idleloop *id)
+{
+  id->pc = sregs->pc;
+  id->time = sregs->simtime;
+  id->ninst = sregs->ninst;
+  id->finst = sregs->finst;
+  id->wmiss = sregs->wmiss;
+  id->nload = sregs->nload;
+  id->nbranch = sregs->nbranch;
+  id->holdt = sregs->holdt;
+  id->icntt = sregs->icntt;
+  id->fholdt = sregs->fholdt;
+  id->iosfx = ebase.iosfx;
+  id->evtime = ebase.evtime;
+}
+
+static uint32
+idle_ild (struct pstate *sregs)
+{
+  if (sregs->ildreg && (sregs->ildtime >= sregs->simtime))
+    return (uint32) (sregs->ildtime - sregs->simtime) + 1;
+  return 0;
+}
+
+static void
+idle_save (struct pstate *sregs, struct idleloop *id)
+{
+  id->ild = idle_ild (sregs);
+  id->fsr = sregs->fsr;
+  memcpy (id->fd, sregs->fd, sizeof (id->fd));
+  memcpy (id->iu, &sregs->psr, sizeof (id->iu));
+  memcpy (id->csr, &sregs->mip, sizeof (id->csr));
+}
+
+/* Save the state at the loop head.  Stores are not counted outside
+   the -stat loops, so drop this core's TLB write mappings instead:
+   a store in the next iteration then misses and shows in wmiss. */
+
+static void
+idle_arm (struct pstate *sregs, struct idleloop *id)
+{
+  int i;
+
+  for (i = 0; i < TLB_ENTRIES; i++)
+    sregs->tlb[i].wtag = TLB_NONE;
+  idle_save (sregs, id);
+  idle_mark (sregs, id);
+  id->armed = 1;
+}
+
+static int
+idle_same (struct pstate *sregs, struct idleloop *id)
+{
+  return (id->ild == idle_ild (sregs)) && (id->fsr == sregs->fsr)
+    && (memcmp (id->iu, &sregs->psr, sizeof (id->iu)) == 0)
+    && (memcmp (id->csr, &sregs->mip, sizeof (id->csr)) == 0)
+    && (memcmp (id->fd, sregs->fd, sizeof (id->fd)) == 0);
+}
+
+static uint64
+idle_check (struct pstate *sregs, uint64 icount)
+{
+  struct idleloop *id = &idle[sregs->cpu];
+  uint64 n, p, k;
+
+  if (sregs->pc != id->pc)
+    {
+      /* keep the candidate while a loop through it is still possible */
+      if ((sregs->ninst - id->ninst) > IDLE_MAXINST)
+	{
+	  idle_mark (sregs, id);
+	  id->armed = 0;
+	  id->wait = 0;
+	}
+      return 0;
+    }
+  if (id->wait)
+    {
+      id->wait--;
+      idle_mark (sregs, id);
+      return 0;
+    }
+  n = sregs->ninst - id->ninst;
+  if ((n == 0) || (n > IDLE_MAXINST) || (sregs->simtime <= id->time)
+      || (sregs->simtime >= ebase.evtime) || (ebase.evtime != id->evtime)
+      || (sregs->finst != id->finst)
+      || (ebase.iosfx != id->iosfx)
+      || (sregs->trap | sregs->pwd_mode | ext_irl[sregs->cpu] | ctrl_c))
+    {
+      idle_mark (sregs, id);
+      id->armed = 0;
+      return 0;
+    }
+  if (!id->armed)
+    {
+      idle_arm (sregs, id);
+      return 0;
+    }
+  if ((sregs->wmiss != id->wmiss) || !idle_same (sregs, id))
+    {
+      /* a loop that does work, look again later */
+      id->wait = id->backoff;
+      id->backoff = (id->backoff < IDLE_MAXWAIT) ? (id->backoff * 2 + 1) :
+	IDLE_MAXWAIT;
+      idle_mark (sregs, id);
+      id->armed = 0;
+      return 0;
+    }
+
+  /* skip iterations that end before the next event */
+  p = sregs->simtime - id->time;
+  k = (ebase.evtime - 1 - sregs->simtime) / p;
+  if (k > (icount / n))
+    k = icount / n;
+  if (k)
+    {
+      if (id->ild)
+	sregs->ildtime += k * p;
+      sregs->ninst += k * n;
+      sregs->nload += k * (sregs->nload - id->nload);
+      sregs->nbranch += k * (sregs->nbranch - id->nbranch);
+      sregs->holdt += k * (sregs->holdt - id->holdt);
+      sregs->icntt += k * (sregs->icntt - id->icntt);
+      sregs->fholdt += k * (sregs->fholdt - id->fholdt);
+      sregs->simtime += k * p;
+      id->hits++;
+      id->cycles += k * p;
+      id->backoff = 0;
+    }
+  idle_mark (sregs, id);
+  return k * n;
+}
+
+/* Run translated blocks starting at the current pc, chaining from one
+   block to the next, for as long as this gives the same result as
+   interpreting the instructions one by one: no block may end at or
+   after *tlimit, so no event or interrupt can become due inside it.
+   The load interlock is part of the static cost inside a block, so
+   blocks are not entered while it may apply to their first
+   instruction, and chaining stops after a block that ends with a
+   load.  A block left with JIT_EXIT is accounted up to the exiting
+   instruction, which the caller then interprets.  Callers only enter
+   with pc and npc in sequence, and blocks keep them so.  With idle
+   set, idle loops are looked for between blocks.  Returns the number
+   of instructions executed. */
+
+static uint64
+jit_run (struct pstate *sregs, uint64 icount, const uint64 * tlimit, int stat,
+	 int idle)
+{
+  struct jitblk *blk, *nblk;
+  const struct jitop *op, *end;
+  uint64 n = 0;
+  uint32 r, ninst, cycles, hold, ild, mix[3];
+  int k;
+
+#ifdef JIT_X86
+  if (jit_codefull)
+    jit_flush ();
+#endif
+  if ((sregs->simtime <= sregs->ildtime) && sregs->ildreg)
+    return 0;
+  blk = jit_lookup (sregs->pc);
+  while ((blk != NULL) && (blk->ninst != 0) && (blk->ninst <= (icount - n))
+	 && ((sregs->simtime + blk->cycles + blk->extra) < *tlimit))
+    {
+      sregs->pc = blk->end;
+      sregs->npc = blk->end + 4;
+      if (blk->code != NULL)
+	r = blk->code (sregs);
+      else
+	{
+	  r = 0;
+	  end = &blk->op[blk->nops];
+	  for (op = blk->op; (op < end) && !(r & JIT_EXIT); op++)
+	    r += op->fn (sregs, op);
+	}
+      if (r & JIT_EXIT)
+	{
+	  /* stop in front of op */
+	  op = &blk->op[JIT_IDX (r)];
+	  sregs->npc = (op->flags & JIT_SLOT) ? sregs->pc : op->pc + 4;
+	  sregs->pc = op->pc;
+	  ninst = op->ninst;
+	  cycles = op->cycles;
+	  hold = op->hold;
+	  ild = op->ild;
+	  mix[0] = op->mix[0];
+	  mix[1] = op->mix[1];
+	  mix[2] = op->mix[2];
+	}
+      else
+	{
+	  ninst = blk->ninst;
+	  cycles = blk->cycles;
+	  hold = blk->hold;
+	  ild = blk->ild;
+	  memcpy (mix, blk->mix, sizeof (mix));
+	  if (r & JIT_ANNUL)
+	    {
+	      ninst--;
+	      cycles -= blk->lcycles;
+	      hold -= blk->lhold;
+	      ild = 0;
+	    }
+	}
+      sregs->simtime += cycles + JIT_CYCLES (r) + JIT_WS (r);
+      sregs->ninst += ninst;
+      if (stat)
+	{
+	  sregs->holdt += hold + JIT_WS (r);
+	  sregs->icntt += cycles - hold + JIT_CYCLES (r);
+	  sregs->nbranch += mix[0];
+	  sregs->nload += mix[1];
+	  sregs->nstore += mix[2];
+	  if (r & JIT_ANNUL)
+	    stat_inst (sregs, blk->lflags, -1);
+	}
+      n += ninst;
+      if (ild)
+	{
+	  /* the next instruction may depend on it */
+	  sregs->ildreg = ild;
+	  sregs->ildtime = sregs->simtime;
+	}
+      if ((r & JIT_EXIT) || ild || ext_irl[sregs->cpu] || ctrl_c)
+	break;
+      if (idle)
+	n += idle_check (sregs, icount - n);
+      k = (sregs->pc != blk->end);
+      if (blk->gen != jit_gen)
+	{
+	  blk->next[0] = blk->next[1] = NULL;
+	  blk->gen = jit_gen;
+	}
+      nblk = blk->next[k];
+      if ((nblk == NULL) || (nblk->pc != sregs->pc))
+	{
+	  nblk = jit_lookup (sregs->pc);
+	  if ((nblk != NULL) && (nblk->ninst != 0))
+	    blk->next[k] = nblk;
+	}
+      blk = nblk;
+    }
+  return n;
+}
+
+/* The run loops below are instantiated once per variant and must be
+   inlined into each, so that the variant parameters fold away */
+
+#ifdef __GNUC__
+#define ALWAYS_INLINE	inline __attribute__ ((always_inline))
+#else
+#define ALWAYS_INLINE	inline
+#endif
+
+/* Execute the remainder of a basic block after the caller has
+   dispatched its first instruction, without going back through the
+   per-instruction checks of the main loop.  Cycle costs are still
+   taken per instruction since hold and branch penalties are dynamic.
+   The block is left as soon as any of those checks could matter: a
+   trap, power-down, a pending interrupt, ctrl-C, or the next
+   instruction starting at or after *tlimit.  *tlimit is read again
+   after every instruction, since a device access may schedule an
+   event earlier than the one due when the block was entered.  With
+   -jit, translated blocks are run in between where possible.  The
+   time of the last instruction executed is left for the caller to
+   account.  l1 selects the instruction cache model used by
+   run_sim_core, dispatch and stat are those of the run loop variant,
+   idle is set when the core runs alone and tlimit points to the next
+   event.  Returns the number of additional instructions executed. */
+
+static ALWAYS_INLINE uint64
+run_block (struct pstate *sregs, uint64 icount, const uint64 * tlimit, int l1,
+	   int (*dispatch) (struct pstate *), int stat, int idle)
+{
+  uint64 n = 0;
+  int mexc, usejit;
+#ifdef THREADED_DISPATCH
+  int chain;
+#endif
+
+  /* translated loads and stores do not check watchpoints */
+  usejit = jit && (arch->translate != NULL) && !mt_running
+    && !ebase.wprnum && !ebase.wpwnum;
+#ifdef THREADED_DISPATCH
+  chain = !usejit && !stat;	/* see below */
+#endif
+  if (l1)
+    usejit = 0;
+#ifdef THREADED_DISPATCH
+  chain = chain && !l1;
+#endif
+
+  while ((n < icount) && !(sregs->pd->flags & PD_BLKEND)
+	 && !(sregs->trap | sregs->pwd_mode | ext_irl[sregs->cpu] | ctrl_c)
+	 && ((sregs->simtime + sregs->icnt + sregs->hold + sregs->fhold) <
+	     *tlimit))
+    {
+      if (stat)
+	{
+	  sregs->fholdt += sregs->fhold;
+	  sregs->holdt += sregs->hold;
+	  sregs->icntt += sregs->icnt;
+	}
+      sregs->simtime += sregs->icnt + sregs->hold + sregs->fhold;
+      if (usejit)
+	{
+	  n += jit_run (sregs, icount - n, tlimit, stat, idle && !noidle);
+	  if ((n >= icount) || ctrl_c)
+	    {
+	      /* nothing left for the caller to account */
+	      sregs->icnt = sregs->hold = sregs->fhold = 0;
+	      return n;
+	    }
+	}
+      sregs->icnt = 1;
+      sregs->fhold = 0;
+      mexc = fetch_inst (sregs);
+      if (l1 && (sregs->l1itags[(sregs->pc >> L1ILINEBITS) & L1IMASK] !=
+		 (sregs->pc >> L1ILINEBITS)))
+	{
+	  sregs->hold = T_L1IMISS;
+	  sregs->l1itags[(sregs->pc >> L1ILINEBITS) & L1IMASK] =
+	    (sregs->pc >> L1ILINEBITS);
+	  sregs->l1imiss++;
+	}
+      if (mexc)
+	{
+	  sregs->trap = I_ACC_EXC;
+	  return n;
+	}
+#ifdef THREADED_DISPATCH
+      if (chain)
+	{
+	  /* let the dispatcher chain the instructions that follow */
+	  sregs->tdleft = icount - n;
+	  sregs->tdlimit = tlimit;
+	  dispatch (sregs);
+	  n += icount - n - sregs->tdleft;
+	  sregs->tdleft = 0;
+	  continue;
+	}
+#endif
+      if (stat)
+	stat_inst (sregs, sregs->pd->flags, 1);
+      dispatch (sregs);
+      n++;
+    }
+  return n;
+}
+
+/* simulate one core instruction-wise.  dispatch, deb, cov and stat
+   are constants in each of the variants instantiated by RUN_LOOPS
+   below: deb when tracing, history or breakpoints need a check per
+   instruction, cov when coverage is collected, stat when detailed
+   statistics are collected. */
+
+static ALWAYS_INLINE int
+run_sim_un (struct pstate *sregs, uint64 icount, int dis,
+	    int (*dispatch) (struct pstate *), int deb, int cov, int stat)
+{
+  int irq, mexc;
+
+  if (sregs->err_mode)
+    icount = 0;
+  mexc = irq = 0;
+  simcore = sregs;
+  while (icount > 0)
+    {
+      if (sregs->pwd_mode)
+	{
+	  sregs->simtime = ebase.evtime;	/* skip forward to next event */
+	  if (ext_irl[sregs->cpu])
+	    irq = arch->check_interrupts (sregs);
+	}
+      else
 	{
 	  sregs->icnt = 1;
 	  sregs->fhold = 0;
@@ -1183,7 +3426,7 @@ run_sim_un (sregs, icount, dis)
 	    irq = arch->check_interrupts (sregs);
 	  if (!irq)
 	    {
-	      mexc = ms->memory_iread (sregs->pc, &sregs->inst, &sregs->hold);
+	      mexc = fetch_inst (sregs);
 	      if (mexc)
 		{
 		  sregs->trap = I_ACC_EXC;
@@ -1211,15 +3454,22 @@ run_sim_un (sregs, icount, dis)
 			      printf (" %8" PRIu64 " ", ebase.simtime);
 			      dis_mem (sregs->pc, 1);
 			    }
-			  arch->dispatch_instruction (sregs);
+			  if (stat)
+			    stat_inst (sregs, sregs->pd->flags, 1);
+			  dispatch (sregs);
 			  icount--;
 			  advance_time (sregs->simtime);
 			}
 		    }
 		  else
 		    {
-		      arch->dispatch_instruction (sregs);
+		      if (stat)
+			stat_inst (sregs, sregs->pd->flags, 1);
+		      dispatch (sregs);
 		      icount--;
+		      if (!cov)
+			icount -= run_block (sregs, icount, &ebase.evtime, 0,
+					     dispatch, stat, 1);
 		    }
 		}
 	    }
@@ -1228,6 +3478,7 @@ run_sim_un (sregs, icount, dis)
 	  if (sregs->trap)
 	    {
 	      irq = 0;
+	      idle[sregs->cpu].armed = 0;	/* trap timing is not periodic */
 	      if ((sregs->err_mode = arch->execute_trap (sregs)) == WPT_HIT)
 		{
 		  sregs->err_mode = 0;
@@ -1248,15 +3499,18 @@ run_sim_un (sregs, icount, dis)
 		  ebase.bpcpu = sregs->cpu;
 		}
 	    }
-#ifdef STAT
-	  sregs->fholdt += sregs->fhold;
-	  sregs->holdt += sregs->hold;
-	  sregs->icntt += sregs->icnt;
-#endif
+	  if (stat)
+	    {
+	      sregs->fholdt += sregs->fhold;
+	      sregs->holdt += sregs->hold;
+	      sregs->icntt += sregs->icnt;
+	    }
 	  sregs->simtime += sregs->icnt + sregs->hold + sregs->fhold;
 	}
       if (sregs->simtime >= ebase.evtime)
 	advance_time (sregs->simtime);
+      if (!deb && !cov && !noidle)
+	icount -= idle_check (sregs, icount);
       if (ctrl_c)
 	{
 	  icount = 0;
@@ -1284,17 +3538,17 @@ sim_timeout (int32 arg)
   ctrl_c = arg;
 }
 
-/* simulate one core time-wise */
+/* simulate one core time-wise, variants as for run_sim_un, and l1
+   when the L1 cache model is on */
 
-static void
-run_sim_core (sregs, ntime, deb, dis)
-     struct pstate *sregs;
-     uint64 ntime;
-     int deb;
-     int dis;
+static ALWAYS_INLINE void
+run_sim_core (struct pstate *sregs, uint64 ntime, int dis,
+	      int (*dispatch) (struct pstate *), int deb, int cov, int stat,
+	      int l1)
 {
   int mexc, irq;
   mexc = irq = 0;
+  simcore = sregs;
   if (sregs->pwd_mode == 0)
     while (ntime > sregs->simtime)
       {
@@ -1303,17 +3557,15 @@ run_sim_core (sregs, ntime, deb, dis)
 	else
 	  irq = 0;
 	sregs->icnt = 1;
-	mexc = ms->memory_iread (sregs->pc, &sregs->inst, &sregs->hold);
-#ifdef ENABLE_L1CACHE
-	if (sregs->l1itags[(sregs->pc >> L1ILINEBITS) & L1IMASK] !=
-	    (sregs->pc >> L1ILINEBITS))
+	mexc = fetch_inst (sregs);
+	if (l1 && (sregs->l1itags[(sregs->pc >> L1ILINEBITS) & L1IMASK] !=
+		   (sregs->pc >> L1ILINEBITS)))
 	  {
 	    sregs->hold = T_L1IMISS;
 	    sregs->l1itags[(sregs->pc >> L1ILINEBITS) & L1IMASK] =
 	      (sregs->pc >> L1ILINEBITS);
 	    sregs->l1imiss++;
 	  }
-#endif
 	sregs->fhold = 0;
 	if (!irq)
 	  {
@@ -1346,11 +3598,18 @@ run_sim_core (sregs, ntime, deb, dis)
 				sregs->simtime);
 			dis_mem (sregs->pc, 1);
 		      }
-		    arch->dispatch_instruction (sregs);
+		    if (stat)
+		      stat_inst (sregs, sregs->pd->flags, 1);
+		    dispatch (sregs);
 		  }
 		else
 		  {
-		    arch->dispatch_instruction (sregs);
+		    if (stat)
+		      stat_inst (sregs, sregs->pd->flags, 1);
+		    dispatch (sregs);
+		    if (!cov)
+		      run_block (sregs, (uint64) -1, &ntime, l1, dispatch, stat,
+				 0);
 		  }
 	      }
 	  }
@@ -1359,7 +3618,12 @@ run_sim_core (sregs, ntime, deb, dis)
 	if (sregs->trap)
 	  {
 	    irq = 0;
-	    if ((sregs->err_mode = arch->execute_trap (sregs)) == WPT_HIT)
+	    bus_lock ();
+	    sregs->err_mode = arch->execute_trap (sregs);
+	    if (sregs->err_mode && (sregs->err_mode != WPT_HIT))
+	      ms->error_mode (sregs->pc);
+	    bus_unlock ();
+	    if (sregs->err_mode == WPT_HIT)
 	      {
 		sregs->err_mode = 0;
 		sregs->trap = 0;
@@ -1376,7 +3640,6 @@ run_sim_core (sregs, ntime, deb, dis)
 	      }
 	    if (sregs->err_mode)
 	      {
-		ms->error_mode (sregs->pc);
 		sregs->pwd_mode = 1;
 		sregs->pwdstart = sregs->simtime;
 		sregs->simtime = ntime;
@@ -1385,11 +3648,12 @@ run_sim_core (sregs, ntime, deb, dis)
 		break;
 	      }
 	  }
-#ifdef STAT
-	sregs->fholdt += sregs->fhold;
-	sregs->holdt += sregs->hold;
-	sregs->icntt += sregs->icnt;
-#endif
+	if (stat)
+	  {
+	    sregs->fholdt += sregs->fhold;
+	    sregs->holdt += sregs->hold;
+	    sregs->icntt += sregs->icnt;
+	  }
 	sregs->simtime += sregs->icnt + sregs->hold + sregs->fhold;
       }
   else
@@ -1402,16 +3666,157 @@ run_sim_core (sregs, ntime, deb, dis)
 
 }
 
-/* time slice simulation of cpu cores in MP system */
+/* Run loop variants, one per architecture and combination of debug
+   checks, coverage, statistics and L1 cache model.  run_sim () picks
+   one per run, so a plain run goes through a loop without any of the
+   checks.  The cache model only applies to MP runs, so it has no
+   run_sim_un variant. */
+
+struct run_loop
+{
+  int (*un) (struct pstate * sregs, uint64 icount, int dis);
+  void (*core) (struct pstate * sregs, uint64 ntime, int dis);
+};
+
+#define RUN_LOOPS(name, dispatch, deb, cov, stat) \
+static int \
+run_un_##name (struct pstate *sregs, uint64 icount, int dis) \
+{ \
+  return run_sim_un (sregs, icount, dis, dispatch, deb, cov, stat); \
+} \
+static void \
+run_core_##name (struct pstate *sregs, uint64 ntime, int dis) \
+{ \
+  run_sim_core (sregs, ntime, dis, dispatch, deb, cov, stat, 0); \
+} \
+static void \
+run_core_##name##_l1 (struct pstate *sregs, uint64 ntime, int dis) \
+{ \
+  run_sim_core (sregs, ntime, dis, dispatch, deb, cov, stat, 1); \
+}
+
+RUN_LOOPS (sparc, sparc_dispatch_instruction, 0, 0, 0)
+RUN_LOOPS (sparc_stat, sparc_dispatch_instruction, 0, 0, 1)
+RUN_LOOPS (sparc_cov, sparc_dispatch_instruction, 0, 1, 0)
+RUN_LOOPS (sparc_cov_stat, sparc_dispatch_instruction, 0, 1, 1)
+RUN_LOOPS (sparc_deb, sparc_dispatch_instruction, 1, 0, 0)
+RUN_LOOPS (sparc_deb_stat, sparc_dispatch_instruction, 1, 0, 1)
+RUN_LOOPS (riscv, riscv_dispatch_instruction, 0, 0, 0)
+RUN_LOOPS (riscv_stat, riscv_dispatch_instruction, 0, 0, 1)
+RUN_LOOPS (riscv_cov, riscv_dispatch_instruction, 0, 1, 0)
+RUN_LOOPS (riscv_cov_stat, riscv_dispatch_instruction, 0, 1, 1)
+RUN_LOOPS (riscv_deb, riscv_dispatch_instruction, 1, 0, 0)
+RUN_LOOPS (riscv_deb_stat, riscv_dispatch_instruction, 1, 0, 1)
+
+#define RUN_LOOP(name) \
+  {{ run_un_##name, run_core_##name }, \
+   { run_un_##name, run_core_##name##_l1 }}
+
+/* indexed by [riscv][plain, coverage, debug][stat][l1] */
+static const struct run_loop run_loops[2][3][2][2] = {
+  {{RUN_LOOP (sparc), RUN_LOOP (sparc_stat)},
+   {RUN_LOOP (sparc_cov), RUN_LOOP (sparc_cov_stat)},
+   {RUN_LOOP (sparc_deb), RUN_LOOP (sparc_deb_stat)}},
+  {{RUN_LOOP (riscv), RUN_LOOP (riscv_stat)},
+   {RUN_LOOP (riscv_cov), RUN_LOOP (riscv_cov_stat)},
+   {RUN_LOOP (riscv_deb), RUN_LOOP (riscv_deb_stat)}}
+};
+
+/* With -mt, cores 1 .. ncpu - 1 run on host threads.  For each time
+   slice the main thread publishes ntime by bumping gen, runs core 0
+   itself and waits until the others have counted themselves done.
+   Events are only run in between, by the main thread. */
+
+#define MT_SPIN 100		/* polls before yielding the host cpu */
+
+static struct
+{
+  const struct run_loop *loop;
+  uint64 ntime;
+  uint32 idle;			/* cores to skip in this slice */
+  int gen, done, stop;
+} mtq;
+
+static void *
+mt_worker (void *arg)
+{
+  struct pstate *sregs = (struct pstate *) arg;
+  int gen, spin;
+
+  gen = 0;
+  while (1)
+    {
+      for (spin = 0; __atomic_load_n (&mtq.gen, __ATOMIC_ACQUIRE) == gen;
+	   spin++)
+	if (spin > MT_SPIN)
+	  sched_yield ();
+      gen++;
+      if (mtq.stop)
+	break;
+      if (!(mtq.idle & (1u << sregs->cpu)))
+	mtq.loop->core (sregs, mtq.ntime, 0);
+      __atomic_add_fetch (&mtq.done, 1, __ATOMIC_RELEASE);
+    }
+  sparc_sync_accex ();
+  riscv_sync_fflags ();
+  return NULL;
+}
+
+/* Start the host threads, returns the number started */
+
+static int
+mt_start (const struct run_loop *loop, pthread_t * tid)
+{
+  int i;
+
+  pthread_once (&bus_once, bus_init);
+  mtq.loop = loop;
+  mtq.gen = mtq.done = mtq.stop = 0;
+  mt_running = 1;
+  for (i = 1; i < ncpu; i++)
+    if (pthread_create (&tid[i], NULL, mt_worker, &sregs[i]))
+      {
+	printf ("cannot create host thread, running cores serially\n");
+	break;
+      }
+  return i - 1;
+}
+
+static void
+mt_stop (pthread_t * tid, int n)
+{
+  int i;
+
+  mtq.stop = 1;
+  __atomic_add_fetch (&mtq.gen, 1, __ATOMIC_RELEASE);
+  for (i = 1; i <= n; i++)
+    pthread_join (tid[i], NULL);
+  mt_running = 0;
+}
+
+/* time slice simulation of cpu cores in MP system.  The slice starts
+   at delta cycles and doubles up to delta_max while the cores run
+   without touching each other.  An IPI, a core start, a CLINT msip
+   write, an atomic instruction or an L1 snoop hit sets mp_xcpu, which
+   drops the next slice back to delta.
+
+   Cores in power-down without a pending interrupt are kept in mp_idle
+   and not run at all until mp_wake () takes them out.  When every core
+   is idle, nothing can happen before the next event, so the slice
+   reaches straight to it. */
 
 static int
-run_sim_mp (icount, dis)
+run_sim_mp (loop, icount, dis, mt)
+     const struct run_loop *loop;
      uint64 icount;
      int dis;
+     int mt;
 {
-  uint64 ntime, etime;
-  int deb, i, j;
+  uint64 ntime, etime, quantum, qmax;
+  uint32 all, idle;
+  int i, spin;
   int err_mode, bphit, wphit, oldcpu;
+  pthread_t tid[NCPU];
 
   err_mode = bphit = wphit = 0;
   icount += ebase.simtime;
@@ -1423,30 +3828,90 @@ run_sim_mp (icount, dis)
 	  err_mode = 1;
 	}
     }
+  if (mt && (icount > ebase.simtime)
+      && ((i = mt_start (loop, tid)) != ncpu - 1))
+    {
+      mt_stop (tid, i);
+      mt = 0;
+    }
+  else if (icount <= ebase.simtime)
+    mt = 0;
+  quantum = delta;
+  qmax = (delta_max > delta) ? delta_max : delta;
+  all = (ncpu < 32) ? (1u << ncpu) - 1 : ~0u;
+  mp_idle = 0;
+  for (i = 0; i < ncpu; i++)
+    if (sregs[i].pwd_mode && !ext_irl[i])
+      mp_idle |= 1u << i;
   while (icount > ebase.simtime)
     {
-      ntime = ebase.simtime + delta;
-      if (ntime > icount)
-	ntime = icount;
-      if (ntime > ebase.evtime)
-	ntime = ebase.evtime;
+      if (mp_idle == all)
+	{
+	  ntime = (icount < ebase.evtime) ? icount : ebase.evtime;
+	  qstat.idle++;
+	}
+      else
+	{
+	  ntime = ebase.simtime + quantum;
+	  if (ntime > icount)
+	    ntime = icount;
+	  if (ntime > ebase.evtime)
+	    ntime = ebase.evtime;
+	  qstat.n++;
+	  qstat.cycles += ntime - ebase.simtime;
+	  if ((ntime - ebase.simtime) > qstat.max)
+	    qstat.max = ntime - ebase.simtime;
+	}
+      mp_xcpu = 0;
+      etime = ntime;
+      idle = mp_idle;
+      if (mt && (idle != all))
+	{
+	  mtq.ntime = ntime;
+	  mtq.idle = idle;
+	  mtq.done = 0;
+	  __atomic_add_fetch (&mtq.gen, 1, __ATOMIC_RELEASE);
+	  if (!(idle & 1))
+	    loop->core (&sregs[0], ntime, dis);
+	  for (spin = 0;
+	       __atomic_load_n (&mtq.done, __ATOMIC_ACQUIRE) < ncpu - 1;
+	       spin++)
+	    if (spin > MT_SPIN)
+	      sched_yield ();
+	}
+      /* serially, a core woken by a lower one still runs in this slice;
+         on host threads it waits for the next */
       for (i = 0; i < ncpu; i++)
 	{
-	  deb = dis || ebase.histlen || ebase.bptnum;
-	  etime = ntime;
-	  run_sim_core (&sregs[i], ntime, deb, dis);
+	  if ((mt ? idle : mp_idle) & (1u << i))
+	    continue;
+	  if (!mt)
+	    loop->core (&sregs[i], ntime, dis);
 	  err_mode |= sregs[i].err_mode;
 	  bphit |= sregs[i].bphit;
 	  wphit |= ebase.wphit;
 	  if (sregs[i].simtime < etime)
 	    etime = sregs[i].simtime;
+	  if (sregs[i].pwd_mode && !ext_irl[i])
+	    __atomic_fetch_or (&mp_idle, 1u << i, __ATOMIC_RELAXED);
+	}
+      if (mp_xcpu)
+	{
+	  quantum = delta;
+	  qstat.shrunk++;
 	}
+      else if (quantum < qmax)
+	quantum = (2 * quantum < qmax) ? 2 * quantum : qmax;
       advance_time (etime);
       if (ctrl_c)
 	{
 	  icount = 0;
 	}
     }
+  if (mt)
+    mt_stop (tid, ncpu - 1);
+  for (i = 0; i < ncpu; i++)
+    mp_wake (i);
 
   oldcpu = cpu;
   cpu = ebase.bpcpu;
@@ -1471,22 +3936,43 @@ run_sim (icount, dis)
      uint64 icount;
      int dis;
 {
-  int res;
+  const struct run_loop *loop;
+  int res, mode, mt, i;
+  uint64 timeout = 0;
 
   ctrl_c = 0;
   sim_run = 1;
   ebase.starttime = get_time ();
+  ebase.startcyc = get_cycles ();
   ms->init_stdio ();
   if (ebase.tlimit > ebase.simtime)
-    event (sim_timeout, 2, ebase.tlimit - ebase.simtime);
+    timeout = event (sim_timeout, 2, ebase.tlimit - ebase.simtime);
   if (ebase.coven)
     cov_start (sregs[0].pc);
+  if (dis || ebase.histlen || ebase.bptnum)
+    mode = 2;
+  else if (ebase.coven)
+    mode = 1;
+  else
+    mode = 0;
+  loop = &run_loops[arch == &riscv][mode][ebase.stat != 0]
+    [l1cache && (ncpu > 1)];
+  /* watchpoints and the debug loop stop all cores at one instruction */
+  mt = mtsim && (mode == 0) && !ebase.wprnum && !ebase.wpwnum;
+  if (l1cache)
+    mt = 0;			/* the cache model snoops the other cores */
   if ((ncpu == 1) || (icount == 1))
-    res = run_sim_un (&sregs[cpu], icount, dis);
+    res = loop->un (&sregs[cpu], icount, dis);
   else
-    res = run_sim_mp (icount, dis);
-  remove_event (sim_timeout, -1);
+    res = run_sim_mp (loop, icount, dis, mt);
+  cancel_event (timeout);
+  for (i = 0; i < ncpu; i++)
+    SYNC_CC (&sregs[i]);
+  sparc_sync_accex ();
+  riscv_sync_fflags ();
+  simcore = NULL;
   ebase.tottime += get_time () - ebase.starttime;
+  ebase.totcyc += get_cycles () - ebase.startcyc;
   ms->restore_stdio ();
   if ((res == CTRL_C) && (ctrl_c == 2))
     printf ("\nTime-out limit reached\n");
@@ -1506,6 +3992,18 @@ get_time (void)
   return usec / 1E6;
 }
 
+/* Host cycle counter, or 0 where none is available */
+
+uint64
+get_cycles (void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  return __builtin_ia32_rdtsc ();
+#else
+  return 0;
+#endif
+}
+
 /* Local version of getline() since not all systems supports it */
 
 static const int line_size = 128;
@@ -1573,39 +4071,37 @@ mygetline (char **lineptr, size_t * n, FILE * stream)
 #define COV_BT		8
 #define COV_BNT		16
 
-unsigned char covram[MAX_RAM_SIZE / 4];
-
 void
 cov_start (int address)
 {
-  covram[(address >> 2) & MAX_RAM_MASK] |= (COV_START | COV_EXEC);
+  covram[(address >> 2) & ((ebase.ramsize >> 2) - 1)] |= (COV_START | COV_EXEC);
 }
 
 void
 cov_exec (int address)
 {
-  covram[(address >> 2) & MAX_RAM_MASK] |= COV_EXEC;
+  covram[(address >> 2) & ((ebase.ramsize >> 2) - 1)] |= COV_EXEC;
 }
 
 
 void
 cov_bt (int address1, int address2)
 {
-  covram[(address1 >> 2) & MAX_RAM_MASK] |= (COV_BT | COV_EXEC);
-  covram[(address2 >> 2) & MAX_RAM_MASK] |= (COV_START | COV_EXEC);
+  covram[(address1 >> 2) & ((ebase.ramsize >> 2) - 1)] |= (COV_BT | COV_EXEC);
+  covram[(address2 >> 2) & ((ebase.ramsize >> 2) - 1)] |= (COV_START | COV_EXEC);
 }
 
 void
 cov_bnt (int address)
 {
-  covram[(address >> 2) & MAX_RAM_MASK] |= (COV_BNT | COV_EXEC);
+  covram[(address >> 2) & ((ebase.ramsize >> 2) - 1)] |= (COV_BNT | COV_EXEC);
 }
 
 void
 cov_jmp (int address1, int address2)
 {
-  covram[(address1 >> 2) & MAX_RAM_MASK] |= (COV_JMP | COV_EXEC);
-  covram[(address2 >> 2) & MAX_RAM_MASK] |= (COV_START | COV_EXEC);
+  covram[(address1 >> 2) & ((ebase.ramsize >> 2) - 1)] |= (COV_JMP | COV_EXEC);
+  covram[(address2 >> 2) & ((ebase.ramsize >> 2) - 1)] |= (COV_START | COV_EXEC);
 }
 
 void
@@ -1619,7 +4115,7 @@ cov_save (char *name)
   strcat (filename, ".cov");
   fp = fopen (filename, "w");
   state = 0;
-  for (i = 0; i < MAX_RAM_SIZE / 4; i += 32)
+  for (i = 0; i < ebase.ramsize / 4; i += 32)
     {
       k = 0;
       for (j = 0; j < 32; j++)
@@ -64,6 +64,7 @@ static uint32 greth_rxbuf;
 static unsigned char *greth_rxbufptr;
 static unsigned char greth_mac[6];
 static uint64 mac;
+static uint64 greth_tx_event;
 static const char broadcast[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
 int greth_irq;
 
@@ -154,7 +155,31 @@ greth_tx (void)
 	  ms->memory_read (greth_txbase, &greth_txdesc, &ws);
 	}
     }
-  event (greth_tx, 1, 5000);
+  greth_tx_event = event (greth_tx, 1, 5000);
+}
+
+/* Register the GRETH state for checkpoints.  The buffer pointers are
+   looked up again for every packet, and the tap device is not part of
+   a checkpoint. */
+
+void
+greth_init (void)
+{
+  CKPT_VAR (greth_ctrl);
+  CKPT_VAR (greth_status);
+  CKPT_VAR (greth_macmsb);
+  CKPT_VAR (greth_maclsb);
+  CKPT_VAR (greth_mdio);
+  CKPT_VAR (greth_txbase);
+  CKPT_VAR (greth_txdesc);
+  CKPT_VAR (greth_txbuf);
+  CKPT_VAR (greth_rxbase);
+  CKPT_VAR (greth_rxdesc);
+  CKPT_VAR (greth_rxbuf);
+  CKPT_VAR (greth_mac);
+  CKPT_VAR (mac);
+  CKPT_VAR (greth_tx_event);
+  CKPT_EVENT (greth_tx);
 }
 
 /* Write GRETH APB registers */
@@ -180,7 +205,8 @@ greth_write (uint32 address, uint32 data)
 	      mac |= greth_maclsb;
 	      sis_tap_init (mac);
 	      mac = 1;
-	      event (greth_tx, 1, 100);
+	      cancel_event (greth_tx_event);
+	      greth_tx_event = event (greth_tx, 1, 100);
 	      sync_rt = 1;
 	    }
 	  greth_ctrl = data;
@@ -282,6 +308,7 @@ greth_rxready (unsigned char *buffer, int len)
 	{
 	  ms->memory_read (greth_rxbase + 4, &greth_rxbuf, &ws);
 	  greth_rxbufptr = ms->get_mem_ptr (greth_rxbuf, 1536);
+	  PDC_WRITE (greth_rxbuf, 1536);
 	  /* endian swap on host/target endian mismatch */
 	  if (arch->bswap)
 	    {
@@ -103,18 +103,74 @@ grlib_ahbpnp_read (uint32 addr)
 
 }
 
-static struct grlib_buscore ahbmcores[16];
+static struct grlib_buscore ahbmcores[64];	/* as in the plug&play area */
 static struct grlib_buscore ahbscores[16];
 static struct grlib_buscore apbcores[16];
 static int ahbmi;
 static int ahbsi;
 static int apbi;
 
+/* Bus decode maps.  Each entry holds the index + 1 of the first core
+   that covers the whole page, 0 if no core decodes it, or BUSMAP_SCAN
+   if a core only covers part of the page. */
+
+#define BUSMAP_SCAN	0xff
+#define AHBMAP_BITS	20	/* 1 MiB AHB pages */
+#define APBMAP_BITS	8	/* 256 byte APB pages */
+
+static unsigned char ahbmap[1 << (32 - AHBMAP_BITS)];
+static unsigned char apbmap[1 << (24 - APBMAP_BITS)];
+
+/* APB cores all decode below 16 MiB */
+#define APBMAP_FIND(addr) ((addr) >> 24 ? -1 : \
+	busmap_find (apbmap, APBMAP_BITS, apbcores, apbi, addr))
+
+static void
+busmap_build (unsigned char *map, int bits, int npages,
+	      const struct grlib_buscore *cores, int ncores)
+{
+  uint32 lo, hi;
+  int p, i;
+
+  for (p = 0; p < npages; p++)
+    {
+      lo = (uint32) p << bits;
+      hi = lo + ((1 << bits) - 1);
+      map[p] = 0;
+      for (i = 0; i < ncores; i++)
+	if ((cores[i].start <= hi) && (lo < cores[i].end))
+	  {
+	    if ((cores[i].start <= lo) && (hi < cores[i].end))
+	      map[p] = i + 1;
+	    else
+	      map[p] = BUSMAP_SCAN;
+	    break;
+	  }
+    }
+}
+
+/* Find the core decoding addr, or -1 */
+
+static inline int
+busmap_find (const unsigned char *map, int bits,
+	     const struct grlib_buscore *cores, int ncores, uint32 addr)
+{
+  int i = map[addr >> bits];
+
+  if (i != BUSMAP_SCAN)
+    return i - 1;
+  for (i = 0; i < ncores; i++)
+    if ((addr >= cores[i].start) && (addr < cores[i].end))
+      return i;
+  return -1;
+}
+
 void
 grlib_init ()
 {
   int i;
 
+  busmap_build (ahbmap, AHBMAP_BITS, sizeof (ahbmap), ahbscores, ahbsi);
   for (i = 0; i < ahbmi; i++)
     if (ahbmcores[i].core->init)
       ahbmcores[i].core->init ();
@@ -136,6 +192,30 @@ grlib_reset ()
       ahbscores[i].core->reset ();
 }
 
+/* Show or clear the per-device access counters */
+
+static void
+bus_stat (struct grlib_buscore *cores, int n, int clear)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    if (clear)
+      cores[i].reads = cores[i].writes = 0;
+    else if (cores[i].reads || cores[i].writes)
+      printf ("   %-10s : %9" PRIu64 " reads %9" PRIu64 " writes\n",
+	      cores[i].core->name, cores[i].reads, cores[i].writes);
+}
+
+void
+grlib_bus_stat (int clear)
+{
+  if (!clear)
+    printf ("\n Device accesses\n");
+  bus_stat (ahbscores, ahbsi, clear);
+  bus_stat (apbcores, apbi, clear);
+}
+
 
 void
 grlib_ahbm_add (const struct grlib_ipcore *core, int irq)
@@ -167,15 +247,16 @@ grlib_read (uint32 addr, uint32 * data)
   int i;
   int res = 0;
 
-  for (i = 0; i < ahbsi; i++)
-    if ((addr >= ahbscores[i].start) && (addr < ahbscores[i].end))
-      {
-	if (ahbscores[i].core->read)
-	  res = ahbscores[i].core->read (addr & ahbscores[i].mask, data);
-	else
-	  res = 1;
-	return !res;
-      }
+  i = busmap_find (ahbmap, AHBMAP_BITS, ahbscores, ahbsi, addr);
+  if (i >= 0)
+    {
+      ahbscores[i].reads++;
+      if (ahbscores[i].core->read)
+	res = ahbscores[i].core->read (addr & ahbscores[i].mask, data);
+      else
+	res = 1;
+      return !res;
+    }
 
   if (!res && ((addr >= AHBPP_START) && (addr <= AHBPP_END)))
     {
@@ -194,17 +275,17 @@ grlib_write (uint32 addr, uint32 * data, uint32 sz)
   int i;
   int res = 0;
 
-  for (i = 0; i < ahbsi; i++)
-    if ((addr >= ahbscores[i].start) && (addr < ahbscores[i].end))
-      {
-	if (ahbscores[i].core->write)
-	  res = ahbscores[i].core->write (addr & ahbscores[i].mask, data, sz);
-	else
-	  res = 1;
-	if (sis_verbose > 2)
-	  printf ("AHB write a: %08x, d: %08x\n", addr, *data);
-	break;
-      }
+  i = busmap_find (ahbmap, AHBMAP_BITS, ahbscores, ahbsi, addr);
+  if (i >= 0)
+    {
+      ahbscores[i].writes++;
+      if (ahbscores[i].core->write)
+	res = ahbscores[i].core->write (addr & ahbscores[i].mask, data, sz);
+      else
+	res = 1;
+      if (sis_verbose > 2)
+	printf ("AHB write a: %08x, d: %08x\n", addr, *data);
+    }
   return !res;
 }
 
@@ -252,7 +333,7 @@ greth_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore greth = {
-  NULL, NULL, grlib_greth_read, grlib_greth_write, greth_add
+  greth_init, NULL, grlib_greth_read, grlib_greth_write, greth_add, "GRETH"
 };
 
 /* ------------------- L2C -----------------------*/
@@ -286,7 +367,7 @@ l2c_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore l2c = {
-  NULL, NULL, grlib_l2c_read, NULL, l2c_add
+  NULL, NULL, grlib_l2c_read, NULL, l2c_add, "L2C"
 };
 
 
@@ -301,7 +382,7 @@ leon3_add ()
 }
 
 const struct grlib_ipcore leon3s = {
-  NULL, NULL, NULL, NULL, leon3_add
+  NULL, NULL, NULL, NULL, leon3_add, "LEON3"
 };
 
 /* ------------------- APBMST ----------------------*/
@@ -311,6 +392,7 @@ apbmst_init ()
 {
   int i;
 
+  busmap_build (apbmap, APBMAP_BITS, sizeof (apbmap), apbcores, apbi);
   for (i = 0; i < apbi; i++)
     if (apbcores[i].core->init)
       apbcores[i].core->init ();
@@ -332,15 +414,13 @@ apbmst_read (uint32 addr, uint32 * data)
   int i;
   int res = 0;
 
-  for (i = 0; i < apbi; i++)
+  i = APBMAP_FIND (addr);
+  if (i >= 0)
     {
-      if ((addr >= apbcores[i].start) && (addr < apbcores[i].end))
-	{
-	  res = 1;
-	  if (apbcores[i].core->read)
-	    apbcores[i].core->read (addr & apbcores[i].mask, data);
-	  break;
-	}
+      res = 1;
+      apbcores[i].reads++;
+      if (apbcores[i].core->read)
+	apbcores[i].core->read (addr & apbcores[i].mask, data);
     }
   if (!res && (addr >= 0xFF000))
     {
@@ -356,13 +436,13 @@ apbmst_write (uint32 addr, uint32 * data, uint32 size)
 {
   int i;
 
-  for (i = 0; i < apbi; i++)
-    if ((addr >= apbcores[i].start) && (addr < apbcores[i].end))
-      {
-	if (apbcores[i].core->write)
-	  apbcores[i].core->write (addr & apbcores[i].mask, data, size);
-	break;
-      }
+  i = APBMAP_FIND (addr);
+  if (i >= 0)
+    {
+      apbcores[i].writes++;
+      if (apbcores[i].core->write)
+	apbcores[i].core->write (addr & apbcores[i].mask, data, size);
+    }
   return 1;
 }
 
@@ -376,7 +456,7 @@ apbmst_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore apbmst = {
-  apbmst_init, apbmst_reset, apbmst_read, apbmst_write, apbmst_add
+  apbmst_init, apbmst_reset, apbmst_read, apbmst_write, apbmst_add, "APBMST"
 };
 
 /* ------------------- IRQMP -----------------------*/
@@ -386,29 +466,25 @@ const struct grlib_ipcore apbmst = {
 #define IRQMP_ICR 	0x0C
 #define IRQMP_ISR 	0x10
 #define IRQMP_IBR 	0x14
+/* per-cpu registers, one word per cpu from these offsets */
 #define IRQMP_IMR 	0x40
-#define IRQMP_IMR1	0x44
-#define IRQMP_IMR2	0x48
-#define IRQMP_IMR3	0x4C
 #define IRQMP_IFR0 	0x80
-#define IRQMP_IFR1 	0x84
-#define IRQMP_IFR2 	0x88
-#define IRQMP_IFR3 	0x8C
 #define IRQMP_PEXTACK0 	0xC0
-#define IRQMP_PEXTACK1 	0xC4
-#define IRQMP_PEXTACK2 	0xC8
-#define IRQMP_PEXTACK3 	0xCC
 
 static void irqmp_intack (int level, int cpu);
-static void chk_irq (void);
+static void chk_irq (uint32 cpus);
 
 /* IRQMP registers.  */
 
 static uint32 irqmp_ipr;
 static uint32 irqmp_ibr;
-static uint32 irqmp_imr[NCPU];
-static uint32 irqmp_ifr[NCPU];
-static uint32 irqmp_pextack[NCPU];
+static uint32 irqmp_imr[IRQMP_NCPU];
+static uint32 irqmp_ifr[IRQMP_NCPU];
+static uint32 irqmp_pextack[IRQMP_NCPU];
+
+/* Cpus with a non-zero interrupt mask, the only ones that pending
+   interrupts can reach */
+static uint32 irqmp_cpus;
 
 /* Mask with the supported interrupts */
 static uint32 irqmp_mask;
@@ -421,7 +497,7 @@ irqmp_init (void)
 {
   int i;
 
-  for (i = 0; i < NCPU; i++)
+  for (i = 0; i < ncpu_alloc; i++)
     {
       sregs[i].intack = irqmp_intack;
     }
@@ -430,6 +506,13 @@ irqmp_init (void)
     irqmp_mask = 0xfffffffe;
   else
     irqmp_mask = 0x0000fffe;
+
+  CKPT_VAR (irqmp_ipr);
+  CKPT_VAR (irqmp_ibr);
+  CKPT_VAR (irqmp_imr);
+  CKPT_VAR (irqmp_ifr);
+  CKPT_VAR (irqmp_pextack);
+  CKPT_VAR (irqmp_cpus);
 }
 
 static void
@@ -438,7 +521,8 @@ irqmp_reset (void)
   int i;
 
   irqmp_ipr = 0;
-  for (i = 0; i < NCPU; i++)
+  irqmp_cpus = 0;
+  for (i = 0; i < IRQMP_NCPU; i++)
     {
       irqmp_imr[i] = 0;
       irqmp_ifr[i] = 0;
@@ -473,21 +557,29 @@ irqmp_intack (int level, int cpu)
     }
 
   if (irqmp_ifr[cpu] & bit)
-    irqmp_ifr[cpu] &= ~bit;
+    {
+      irqmp_ifr[cpu] &= ~bit;
+      chk_irq (1u << cpu);
+    }
   else
-    irqmp_ipr &= ~bit;
-  chk_irq ();
+    {
+      irqmp_ipr &= ~bit;
+      chk_irq (irqmp_cpus | (1u << cpu));
+    }
 }
 
+/* Update the interrupt level of the cpus in the mask */
+
 static void
-chk_irq ()
+chk_irq (uint32 cpus)
 {
   int32 i, cpu;
   uint32 itmp;
   int old_irl;
 
-  for (cpu = 0; cpu < ncpu; cpu++)
+  for (; cpus; cpus &= cpus - 1)
     {
+      cpu = __builtin_ctz (cpus);
       old_irl = ext_irl[cpu];
       itmp = ((irqmp_ipr | irqmp_ifr[cpu]) & irqmp_imr[cpu]) & irqmp_mask;
       if (itmp & 0xffff0000)
@@ -511,6 +603,7 @@ chk_irq ()
 		  break;
 		}
 	    }
+	  mp_wake (cpu);
 	}
     }
 }
@@ -525,7 +618,7 @@ grlib_set_irq (int32 level)
       irqmp_ifr[i] |= (1 << level);
   else
     irqmp_ipr |= (1 << level);
-  chk_irq ();
+  chk_irq (irqmp_cpus);
 }
 
 static int
@@ -553,56 +646,16 @@ irqmp_read (uint32 addr, uint32 * data)
       *data = irqmp_ibr;
       break;
 
-    case IRQMP_IMR:		/* 0x40 */
-      *data = irqmp_imr[0];
-      break;
-
-    case IRQMP_IMR1:		/* 0x44 */
-      *data = irqmp_imr[1];
-      break;
-
-    case IRQMP_IMR2:		/* 0x48 */
-      *data = irqmp_imr[2];
-      break;
-
-    case IRQMP_IMR3:		/* 0x4C */
-      *data = irqmp_imr[3];
-      break;
-
-    case IRQMP_IFR0:		/* 0x80 */
-      *data = irqmp_ifr[0];
-      break;
-
-    case IRQMP_IFR1:		/* 0x84 */
-      *data = irqmp_ifr[1];
-      break;
-
-    case IRQMP_IFR2:		/* 0x88 */
-      *data = irqmp_ifr[2];
-      break;
-
-    case IRQMP_IFR3:		/* 0x8C */
-      *data = irqmp_ifr[3];
-      break;
-
-    case IRQMP_PEXTACK0:	/* 0xC0 */
-      *data = irqmp_pextack[0];
-      break;
-
-    case IRQMP_PEXTACK1:	/* 0xC4 */
-      *data = irqmp_pextack[1];
-      break;
-
-    case IRQMP_PEXTACK2:	/* 0xC8 */
-      *data = irqmp_pextack[2];
-      break;
-
-    case IRQMP_PEXTACK3:	/* 0xCC */
-      *data = irqmp_pextack[3];
-      break;
-
     default:
-      *data = 0;
+      i = (addr & 0x3f) >> 2;
+      if (((addr & 0xff) < IRQMP_IMR) || (i >= ncpu))
+	*data = 0;
+      else if ((addr & 0xc0) == IRQMP_IMR)
+	*data = irqmp_imr[i];
+      else if ((addr & 0xc0) == IRQMP_IFR0)
+	*data = irqmp_ifr[i];
+      else
+	*data = irqmp_pextack[i];
     }
 }
 
@@ -610,40 +663,43 @@ static int
 irqmp_write (uint32 addr, uint32 * data, uint32 size)
 {
   int i;
+  uint32 cpus;
 
   switch (addr & 0xff)
     {
 
     case IRQMP_IPR:		/* 0x04 */
       irqmp_ipr = *data & irqmp_mask;
-      chk_irq ();
+      chk_irq (irqmp_cpus);
       break;
 
     case IRQMP_IFR:		/* 0x08 */
       irqmp_ifr[0] = *data & 0xfffe;
-      chk_irq ();
+      mp_xcpu = 1;
+      chk_irq (1);
       break;
 
     case IRQMP_ICR:		/* 0x0C */
       irqmp_ipr &= ~*data & irqmp_mask;
-      chk_irq ();
+      chk_irq (irqmp_cpus);
       break;
 
     case IRQMP_ISR:		/* 0x10 */
-      for (i = 0; i < ncpu; i++)
+      for (cpus = *data & 0xffff; cpus; cpus &= cpus - 1)
 	{
-	  if ((*data >> i) & 1)
+	  i = __builtin_ctz (cpus);
+	  if (i >= ncpu)
+	    break;
+	  mp_xcpu = 1;
+	  mp_wake (i);
+	  if (sregs[i].pwd_mode)
 	    {
-	      if (sregs[i].pwd_mode)
-		{
-		  sregs[i].simtime = ebase.simtime;
-		  if (sis_verbose > 1)
-		    printf ("%8" PRIu64 " cpu %d starting\n", ebase.simtime,
-			    i);
-		  sregs[i].pwdtime += ebase.simtime - sregs[i].pwdstart;
-		}
-	      sregs[i].pwd_mode = 0;
+	      sregs[i].simtime = ebase.simtime;
+	      if (sis_verbose > 1)
+		printf ("%8" PRIu64 " cpu %d starting\n", ebase.simtime, i);
+	      sregs[i].pwdtime += ebase.simtime - sregs[i].pwdstart;
 	    }
+	  sregs[i].pwd_mode = 0;
 	}
       break;
 
@@ -651,45 +707,25 @@ irqmp_write (uint32 addr, uint32 * data, uint32 size)
       irqmp_ibr = *data & 0xfffe;
       break;
 
-    case IRQMP_IMR:		/* 0x40 */
-      irqmp_imr[0] = *data & irqmp_mask;
-      chk_irq ();
-      break;
-
-    case IRQMP_IMR1:		/* 0x44 */
-      irqmp_imr[1] = *data & irqmp_mask;
-      chk_irq ();
-      break;
-
-    case IRQMP_IMR2:		/* 0x48 */
-      irqmp_imr[2] = *data & irqmp_mask;
-      chk_irq ();
-      break;
-
-    case IRQMP_IMR3:		/* 0x4C */
-      irqmp_imr[3] = *data & irqmp_mask;
-      chk_irq ();
-      break;
-
-    case IRQMP_IFR0:		/* 0x80 */
-      irqmp_ifr[0] = *data & 0xfffe;
-      chk_irq ();
-      break;
-
-    case IRQMP_IFR1:		/* 0x84 */
-      irqmp_ifr[1] = *data & 0xfffe;
-      chk_irq ();
-      break;
-
-    case IRQMP_IFR2:		/* 0x88 */
-      irqmp_ifr[2] = *data & 0xfffe;
-      chk_irq ();
-      break;
-
-    case IRQMP_IFR3:		/* 0x8C */
-      irqmp_ifr[3] = *data & 0xfffe;
-      chk_irq ();
-      break;
+    default:
+      i = (addr & 0x3f) >> 2;
+      if (((addr & 0xff) < IRQMP_IMR) || (i >= ncpu))
+	break;
+      if ((addr & 0xc0) == IRQMP_IMR)
+	{
+	  irqmp_imr[i] = *data & irqmp_mask;
+	  if (irqmp_imr[i])
+	    irqmp_cpus |= 1u << i;
+	  else
+	    irqmp_cpus &= ~(1u << i);
+	  chk_irq (1u << i);
+	}
+      else if ((addr & 0xc0) == IRQMP_IFR0)
+	{
+	  irqmp_ifr[i] = *data & 0xfffe;
+	  mp_xcpu = 1;
+	  chk_irq (1u << i);
+	}
     }
 }
 
@@ -703,7 +739,7 @@ irqmp_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore irqmp = {
-  irqmp_init, irqmp_reset, irqmp_read, irqmp_write, irqmp_add
+  irqmp_init, irqmp_reset, irqmp_read, irqmp_write, irqmp_add, "IRQMP"
 };
 
 /* ------------------- GPTIMER -----------------------*/
@@ -711,13 +747,58 @@ const struct grlib_ipcore irqmp = {
 gp_timer_apbctrl1 gptimer1;
 gp_timer_apbctrl2 gptimer2;
 
+static void gptimer_apbctrl1_intr (int32 arg);
+static void gptimer_apbctrl2_intr (int32 arg);
+
+/* pending interrupt event of each unit */
+static uint64 gptimer_apbctrl1_event;
+static uint64 gptimer_apbctrl2_event;
+
+/* The timer units are not stepped every cycle. Their state is brought up to
+   date when accessed, and a single event is kept at the next underflow that
+   raises an interrupt. */
+
+static void
+gptimer_schedule (uint64 *handle, void (*intr) (), gp_timer_core *core, gp_timer *timers, uint32 size)
+{
+  uint64 next = gptimer_next_interrupt (core, timers, size);
+
+  cancel_event (*handle);
+  *handle = 0;
+  if (next != GPTIMER_NO_INTERRUPT)
+    *handle = event (intr, 0, (next > ebase.simtime) ? next - ebase.simtime : 0);
+}
+
+static void
+gptimer_apbctrl1_schedule (void)
+{
+  gptimer_schedule (&gptimer_apbctrl1_event, gptimer_apbctrl1_intr,
+                    &gptimer1.core, gptimer1.timers, GPTIMER_APBCTRL1_SIZE);
+}
+
+/* Latching depends on the interrupt controller state, so while it is armed
+   the unit is evaluated every cycle as before. */
+static void
+gptimer_apbctrl2_schedule (void)
+{
+  if (gptimer_get_flag (gptimer2.core.configuration_register, GPT_EL) &&
+      gptimer_read_core_register (&gptimer2.core, GPTIMER_LATCH_CONFIGURATION_REGISTER_ADDRESS))
+  {
+    cancel_event (gptimer_apbctrl2_event);
+    gptimer_apbctrl2_event = event (gptimer_apbctrl2_intr, 0, 1);
+  }
+  else
+    gptimer_schedule (&gptimer_apbctrl2_event, gptimer_apbctrl2_intr,
+                      &gptimer2.core, gptimer2.timers, GPTIMER_APBCTRL2_SIZE);
+}
+
 static void
 gptimer_apbctrl1_intr (int32 arg)
 {
   // unused parameter
   (void)(arg);
 
-  gptimer_update (&gptimer1.core, gptimer1.timers, GPTIMER_APBCTRL1_SIZE);
+  gptimer_advance (&gptimer1.core, gptimer1.timers, GPTIMER_APBCTRL1_SIZE, ebase.simtime);
   uint32_t separate_irq_flag = gptimer_get_flag (gptimer1.core.configuration_register, GPT_SI);
 
   for (int i = 0; i < GPTIMER_APBCTRL1_SIZE; i++)
@@ -730,7 +811,7 @@ gptimer_apbctrl1_intr (int32 arg)
     }
   }
 
-  event (gptimer_apbctrl1_intr, 0, 1);
+  gptimer_apbctrl1_schedule ();
 }
 
 static void
@@ -739,7 +820,7 @@ gptimer_apbctrl2_intr (int32 arg)
   // unused parameter
   (void)(arg);
 
-  gptimer_update (&gptimer2.core, gptimer2.timers, GPTIMER_APBCTRL2_SIZE);
+  gptimer_advance (&gptimer2.core, gptimer2.timers, GPTIMER_APBCTRL2_SIZE, ebase.simtime);
 
   bool timers_latched = false;
   uint32_t latch_configuration_register = gptimer_read_core_register (&gptimer2.core, GPTIMER_LATCH_CONFIGURATION_REGISTER_ADDRESS);
@@ -777,19 +858,43 @@ gptimer_apbctrl2_intr (int32 arg)
     }
   }
 
-  event (gptimer_apbctrl2_intr, 0, 1);
+  gptimer_apbctrl2_schedule ();
+}
+
+/* Register the timer registers for checkpoints, leaving out the chain
+   pointers */
+static void
+gptimer_ckpt (const char *unit, gp_timer_core *core, gp_timer *timers, uint32 size)
+{
+  char name[CKPT_NAMELEN];
+
+  snprintf (name, sizeof (name), "%s.core", unit);
+  ckpt_state (name, core, sizeof (*core));
+  for (uint32 i = 0; i < size; i++)
+  {
+    snprintf (name, sizeof (name), "%s.timers[%d]", unit, i);
+    ckpt_state (name, &timers[i], offsetof (gp_timer, timer_chain_underflow_ptr));
+    snprintf (name, sizeof (name), "%s.timers[%d].uf", unit, i);
+    ckpt_state (name, &timers[i].timer_underflow, sizeof (timers[i].timer_underflow));
+  }
 }
 
 static void
 gptimer_apbctrl1_init (void)
 {
   gptimer_apbctrl1_timer_reset ();
+  gptimer_ckpt ("gptimer1", &gptimer1.core, gptimer1.timers, GPTIMER_APBCTRL1_SIZE);
+  CKPT_VAR (gptimer_apbctrl1_event);
+  CKPT_EVENT (gptimer_apbctrl1_intr);
 }
 
 static void
 gptimer_apbctrl2_init (void)
 {
   gptimer_apbctrl2_timer_reset ();
+  gptimer_ckpt ("gptimer2", &gptimer2.core, gptimer2.timers, GPTIMER_APBCTRL2_SIZE);
+  CKPT_VAR (gptimer_apbctrl2_event);
+  CKPT_EVENT (gptimer_apbctrl2_intr);
 }
 
 static void
@@ -817,9 +922,8 @@ static void
 gptimer_apbctrl1_reset (void)
 {
   gptimer_apbctrl1_timer_reset ();
-
-  remove_event (gptimer_apbctrl1_intr, -1);
-  event (gptimer_apbctrl1_intr, 0, 1);
+  gptimer1.core.last_update = ebase.simtime;
+  gptimer_apbctrl1_schedule ();
 
   if (sis_verbose)
   {
@@ -831,9 +935,8 @@ static void
 gptimer_apbctrl2_reset (void)
 {
   gptimer_apbctrl2_timer_reset ();
-
-  remove_event (gptimer_apbctrl2_intr, -1);
-  event (gptimer_apbctrl2_intr, 0, 1);
+  gptimer2.core.last_update = ebase.simtime;
+  gptimer_apbctrl2_schedule ();
 
   if (sis_verbose)
   {
@@ -842,8 +945,12 @@ gptimer_apbctrl2_reset (void)
 }
 
 static int
-gptimer_read (gp_timer_core *core, gp_timer *timers, uint32 addr, uint32 * data)
+gptimer_read (gp_timer_core *core, gp_timer *timers, uint32 size, uint32 addr, uint32 * data)
 {
+  gptimer_advance (core, timers, size, sim_time ());
+  /* counters are updated lazily, so they change without an event */
+  ebase.iosfx++;
+
   uint32_t address_masked = addr & GPTIMER_REGISTERS_MASK;
   switch (address_masked & GPTIMER_OFFSET_MASK)
   {
@@ -882,13 +989,13 @@ gptimer_read (gp_timer_core *core, gp_timer *timers, uint32 addr, uint32 * data)
 static int 
 gptimer_apbctrl1_read (uint32 addr, uint32 * data)
 {
-  gptimer_read (&gptimer1.core, gptimer1.timers, addr, data);
+  gptimer_read (&gptimer1.core, gptimer1.timers, GPTIMER_APBCTRL1_SIZE, addr, data);
 }
 
 static int 
 gptimer_apbctrl2_read (uint32 addr, uint32 * data)
 {
-  gptimer_read (&gptimer2.core, gptimer2.timers, addr, data);
+  gptimer_read (&gptimer2.core, gptimer2.timers, GPTIMER_APBCTRL2_SIZE, addr, data);
 }
 
 static int
@@ -926,6 +1033,8 @@ gptimer_timer_write (gp_timer *timers, uint32 addr, uint32 * data)
 static int
 gptimer_apbctrl1_write (uint32 addr, uint32 * data, uint32 sz)
 {
+  gptimer_advance (&gptimer1.core, gptimer1.timers, GPTIMER_APBCTRL1_SIZE, sim_time ());
+
   if ((addr & GPTIMER_OFFSET_MASK) == CORE_OFFSET)
   {
     gptimer_apbctrl1_write_core_register (addr, data);
@@ -934,11 +1043,15 @@ gptimer_apbctrl1_write (uint32 addr, uint32 * data, uint32 sz)
   {
     gptimer_timer_write (gptimer1.timers, addr, data);
   }
+
+  gptimer_apbctrl1_schedule ();
 }
 
 static int
 gptimer_apbctrl2_write (uint32 addr, uint32 * data, uint32 sz)
 {
+  gptimer_advance (&gptimer2.core, gptimer2.timers, GPTIMER_APBCTRL2_SIZE, sim_time ());
+
   if ((addr & GPTIMER_OFFSET_MASK) == CORE_OFFSET)
   {
     gptimer_apbctrl2_write_core_register (addr, data);
@@ -947,14 +1060,16 @@ gptimer_apbctrl2_write (uint32 addr, uint32 * data, uint32 sz)
   {
     gptimer_timer_write (gptimer2.timers, addr, data);
   }
+
+  gptimer_apbctrl2_schedule ();
 }
 
 const struct grlib_ipcore gptimer_apbctrl1 = {
-  gptimer_apbctrl1_init, gptimer_apbctrl1_reset, gptimer_apbctrl1_read, gptimer_apbctrl1_write, gptimer_apbctrl1_add
+  gptimer_apbctrl1_init, gptimer_apbctrl1_reset, gptimer_apbctrl1_read, gptimer_apbctrl1_write, gptimer_apbctrl1_add, "GPTIMER1"
 };
 
 const struct grlib_ipcore gptimer_apbctrl2 = {
-  gptimer_apbctrl2_init, gptimer_apbctrl2_reset, gptimer_apbctrl2_read, gptimer_apbctrl2_write, gptimer_apbctrl2_add
+  gptimer_apbctrl2_init, gptimer_apbctrl2_reset, gptimer_apbctrl2_read, gptimer_apbctrl2_write, gptimer_apbctrl2_add, "GPTIMER2"
 };
 
 /* APBUART.  */
@@ -991,40 +1106,74 @@ apbuart_restore_stdio (void)
   uart_restore_stdio(&uarts[5]);
 }
 
+static void uart_rx_event (int32 arg);
+static void fast_uart_rx_event (int32 arg);
+static void uart_tx_event (int32_t arg);
+static void fast_uart_tx_event (int32 arg);
+
+/* Register the UART registers, pending events and buffered characters
+   for checkpoints */
+static void
+apbuart_ckpt (int n)
+{
+  apbuart_type *uart = &uarts[n];
+  char name[CKPT_NAMELEN];
+
+  snprintf (name, sizeof (name), "uarts[%d]", n);
+  ckpt_state (name, &uart->status_register,
+              sizeof (*uart) - offsetof (apbuart_type, status_register));
+  snprintf (name, sizeof (name), "uarts[%d].in", n);
+  ckpt_state (name, uart->uart_io.in.buffer,
+              sizeof (io_stream) - offsetof (io_stream, buffer));
+  snprintf (name, sizeof (name), "uarts[%d].out", n);
+  ckpt_state (name, uart->uart_io.out.buffer,
+              sizeof (io_stream) - offsetof (io_stream, buffer));
+  CKPT_EVENT (uart_rx_event);
+  CKPT_EVENT (fast_uart_rx_event);
+  CKPT_EVENT (uart_tx_event);
+  CKPT_EVENT (fast_uart_tx_event);
+}
+
 static void
 apbuart0_init (void)
 {
   uart_init(&uarts[0]);
+  apbuart_ckpt (0);
 }
 
 static void
 apbuart1_init (void)
 {
   uart_init(&uarts[1]);
+  apbuart_ckpt (1);
 }
 
 static void
 apbuart2_init (void)
 {
   uart_init(&uarts[2]);
+  apbuart_ckpt (2);
 }
 
 static void
 apbuart3_init (void)
 {
   uart_init(&uarts[3]);
+  apbuart_ckpt (3);
 }
 
 static void
 apbuart4_init (void)
 {
   uart_init(&uarts[4]);
+  apbuart_ckpt (4);
 }
 
 static void
 apbuart5_init (void)
 {
   uart_init(&uarts[5]);
+  apbuart_ckpt (5);
 }
 
 static void
@@ -1038,7 +1187,7 @@ uart_rx_event (int32 arg)
     grlib_set_irq (uart->irq);
   }
 
-  event (uart_rx_event, uart->irq, UART_RX_TIME);
+  uart->rx_event = event (uart_rx_event, uart->irq, UART_RX_TIME);
 }
 
 static void
@@ -1052,7 +1201,7 @@ fast_uart_rx_event (int32 arg)
     grlib_set_irq (uart->irq);
   }
 
-  event (fast_uart_rx_event, uart->irq, UART_RX_TIME);
+  uart->rx_event = event (fast_uart_rx_event, uart->irq, UART_RX_TIME);
 
 }
 
@@ -1064,6 +1213,7 @@ uart_read (apbuart_type *uart, uint32_t addr, uint32_t *data)
   switch (addr & APBUART_REGISTER_TYPE_MASK)
   {
     case APBUART_DATA_REGISTER_ADDRESS:
+      ebase.iosfx++;
       apbuart_reset_flag(&uart->status_register, APBUART_DR);
       *data = uart->uart_io.in.buffer[uart->uart_io.in.buffer_index];
       result = 0;
@@ -1139,7 +1289,7 @@ uart_tx_event (int32_t arg)
     grlib_set_irq (uart->irq);
   }
 
-  event (uart_tx_event, uart->irq, UART_TX_TIME);
+  uart->tx_event = event (uart_tx_event, uart->irq, UART_TX_TIME);
 }
 
 static void
@@ -1153,7 +1303,7 @@ fast_uart_tx_event (int32 arg)
     grlib_set_irq (uart->irq);
   }
 
-  event (fast_uart_tx_event, uart->irq, UART_FLUSH_TIME);
+  uart->tx_event = event (fast_uart_tx_event, uart->irq, UART_FLUSH_TIME);
 }
 
 int
@@ -1245,13 +1395,18 @@ apbuart5_write (uint32 addr, uint32 * data, uint32 sz)
 static void
 uart_event_start (int uart_irq)
 {
+  apbuart_type *uart = get_uart_by_irq (uart_irq);
+  assert(uart);
+
+  cancel_event (uart->rx_event);
+  cancel_event (uart->tx_event);
 #ifdef FAST_UART
-  event (fast_uart_rx_event, uart_irq, UART_RX_TIME);
-  event (fast_uart_tx_event, uart_irq, UART_FLUSH_TIME);
+  uart->rx_event = event (fast_uart_rx_event, uart_irq, UART_RX_TIME);
+  uart->tx_event = event (fast_uart_tx_event, uart_irq, UART_FLUSH_TIME);
 #else
 #ifndef _WIN32
-  event (uart_rx_event, uart_irq, UART_RX_TIME);
-  event (uart_tx_event, uart_irq, UART_TX_TIME);
+  uart->rx_event = event (uart_rx_event, uart_irq, UART_RX_TIME);
+  uart->tx_event = event (uart_tx_event, uart_irq, UART_TX_TIME);
 #endif
 #endif
 }
@@ -1345,27 +1500,27 @@ apbuart_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore apbuart0 = {
-  apbuart0_init, apbuart0_reset, apbuart0_read, apbuart0_write, apbuart_add
+  apbuart0_init, apbuart0_reset, apbuart0_read, apbuart0_write, apbuart_add, "APBUART0"
 };
 
 const struct grlib_ipcore apbuart1 = {
-  apbuart1_init, apbuart1_reset, apbuart1_read, apbuart1_write, apbuart_add
+  apbuart1_init, apbuart1_reset, apbuart1_read, apbuart1_write, apbuart_add, "APBUART1"
 };
 
 const struct grlib_ipcore apbuart2 = {
-  apbuart2_init, apbuart2_reset, apbuart2_read, apbuart2_write, apbuart_add
+  apbuart2_init, apbuart2_reset, apbuart2_read, apbuart2_write, apbuart_add, "APBUART2"
 };
 
 const struct grlib_ipcore apbuart3 = {
-  apbuart3_init, apbuart3_reset, apbuart3_read, apbuart3_write, apbuart_add
+  apbuart3_init, apbuart3_reset, apbuart3_read, apbuart3_write, apbuart_add, "APBUART3"
 };
 
 const struct grlib_ipcore apbuart4 = {
-  apbuart4_init, apbuart4_reset, apbuart4_read, apbuart4_write, apbuart_add
+  apbuart4_init, apbuart4_reset, apbuart4_read, apbuart4_write, apbuart_add, "APBUART4"
 };
 
 const struct grlib_ipcore apbuart5 = {
-  apbuart5_init, apbuart5_reset, apbuart5_read, apbuart5_write, apbuart_add
+  apbuart5_init, apbuart5_reset, apbuart5_read, apbuart5_write, apbuart_add, "APBUART5"
 };
 
 /* ------------------- SDCTRL -----------------------*/
@@ -1401,6 +1556,7 @@ grlib_store_bytes (char *mem, uint32 waddr, uint32 * data, int32 sz)
 static int
 sdctrl_write (uint32 addr, uint32 * data, uint32 sz)
 {
+  PDC_WRITE (ebase.ramstart + addr, 1 << sz);
   grlib_store_bytes (ramb, addr, data, sz);
   return 1;
 }
@@ -1423,7 +1579,7 @@ sdctrl_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore sdctrl = {
-  NULL, NULL, sdctrl_read, sdctrl_write, sdctrl_add
+  NULL, NULL, sdctrl_read, sdctrl_write, sdctrl_add, "SDCTRL"
 };
 
 /* ------------------- srctrl -----------------------*/
@@ -1432,6 +1588,7 @@ const struct grlib_ipcore sdctrl = {
 static int
 srctrl_write (uint32 addr, uint32 * data, uint32 sz)
 {
+  PDC_WRITE (addr, 1 << sz);
   grlib_store_bytes (romb, addr, data, sz);
   return 1;
 }
@@ -1454,7 +1611,7 @@ srctrl_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore srctrl = {
-  NULL, NULL, srctrl_read, srctrl_write, srctrl_add
+  NULL, NULL, srctrl_read, srctrl_write, srctrl_add, "SRCTRL"
 };
 
 /* ------------------- boot init --------------------*/
@@ -1539,6 +1696,15 @@ ns16550_read (uint32 addr, uint32 * data)
   return 4;
 }
 
+static void
+ns16550_init (void)
+{
+  CKPT_VAR (uart_lcr);
+  CKPT_VAR (uart_ie);
+  CKPT_VAR (uart_mcr);
+  CKPT_VAR (uart_txctrl);
+}
+
 static void
 ns16550_reset (void)
 {
@@ -1548,7 +1714,7 @@ ns16550_reset (void)
 }
 
 const struct grlib_ipcore ns16550 = {
-  NULL, ns16550_reset, ns16550_read, ns16550_write, ns16550_add
+  ns16550_init, ns16550_reset, ns16550_read, ns16550_write, ns16550_add, "NS16550"
 };
 
 /* ------------------- clint -------------------------*/
@@ -1573,7 +1739,7 @@ clint_read (uint32 addr, uint32 * data)
   int reg, cpuid;
 
   reg = (addr >> 2) & 1;
-  cpuid = ((addr >> 3) % NCPU);
+  *data = 0;
   if ((addr >= CLINT_TIMEBASE) && (addr < CLINTEND))
     {
       tmp = ebase.simtime >> 32;
@@ -1584,6 +1750,9 @@ clint_read (uint32 addr, uint32 * data)
     }
   else if ((addr >= CLINT_TIMECMP) && (addr < CLINT_TIMEBASE))
     {
+      cpuid = (addr - CLINT_TIMECMP) >> 3;
+      if (cpuid >= ncpu)
+	return 4;
       tmp = sregs[cpuid].mtimecmp >> 32;
       if (reg)
 	*data = tmp & 0xffffffff;
@@ -1592,13 +1761,17 @@ clint_read (uint32 addr, uint32 * data)
     }
   else if ((addr >= 0) && (addr < CLINT_TIMECMP))
     {
-      cpuid = ((addr >> 2) % NCPU);
-      *data = ((sregs[cpuid].mip & MIP_MSIP) >> 4) & 1;
+      cpuid = addr >> 2;
+      if (cpuid < ncpu)
+	*data = ((sregs[cpuid].mip & MIP_MSIP) >> 4) & 1;
     }
 
   return 4;
 }
 
+/* pending set_mtip event per hart */
+static uint64 mtip_event[NCPU];
+
 static void
 set_mtip (int32 arg)
 {
@@ -1606,6 +1779,13 @@ set_mtip (int32 arg)
   rv32_check_lirq (arg);
 }
 
+static void
+clint_init (void)
+{
+  CKPT_VAR (mtip_event);
+  CKPT_EVENT (set_mtip);
+}
+
 static int
 clint_write (uint32 addr, uint32 * data, uint32 sz)
 {
@@ -1617,7 +1797,9 @@ clint_write (uint32 addr, uint32 * data, uint32 sz)
       reg = (addr >> 2) & 1;
       if ((addr >= CLINT_TIMECMP) && (addr <= CLINT_TIMEBASE))
 	{
-	  cpuid = ((addr >> 3) % NCPU);
+	  cpuid = (addr - CLINT_TIMECMP) >> 3;
+	  if (cpuid >= ncpu)
+	    return 1;
 	  if (reg)
 	    {
 	      tmp = sregs[cpuid].mtimecmp & 0xffffffff;
@@ -1630,17 +1812,21 @@ clint_write (uint32 addr, uint32 * data, uint32 sz)
 	      tmp = sregs[cpuid].mtimecmp >> 32;
 	      sregs[cpuid].mtimecmp = (tmp << 32) | *data;
 	    }
-	  remove_event (set_mtip, cpuid);
+	  cancel_event (mtip_event[cpuid]);
 	  sregs[cpuid].mip &= ~MIP_MTIP;
 	  if (sregs[cpuid].mtimecmp <= sregs[cpuid].simtime)
 	    sregs[cpuid].mip |= MIP_MTIP;
 	  else
-	    event (set_mtip, cpuid,
-		   sregs[cpuid].mtimecmp - sregs[cpuid].simtime);
+	    mtip_event[cpuid] = event (set_mtip, cpuid,
+				       sregs[cpuid].mtimecmp -
+				       sregs[cpuid].simtime);
 	}
       else if ((addr >= CLINTSTART) && (addr <= CLINT_TIMECMP))
 	{
-	  cpuid = ((addr >> 2) % NCPU);
+	  cpuid = addr >> 2;
+	  if (cpuid >= ncpu)
+	    return 1;
+	  mp_xcpu = 1;
 	  if ((*data & 1) == 1)
 	    sregs[cpuid].mip |= MIP_MSIP;
 	  else
@@ -1653,7 +1839,7 @@ clint_write (uint32 addr, uint32 * data, uint32 sz)
 }
 
 const struct grlib_ipcore clint = {
-  NULL, NULL, clint_read, clint_write, clint_add
+  clint_init, NULL, clint_read, clint_write, clint_add, "CLINT"
 };
 
 /* ------------------- plic --------------------------*/
@@ -1672,6 +1858,20 @@ static uint32 plic_ip[2];
 static uint32 plic_thres[NCPU];
 static uint32 plic_claim[NCPU];
 
+/* Harts with any interrupt enabled, the only ones plic_irq () reaches */
+static uint32 plic_harts;
+
+static void
+plic_init (void)
+{
+  CKPT_VAR (plic_prio);
+  CKPT_VAR (plic_ie);
+  CKPT_VAR (plic_ip);
+  CKPT_VAR (plic_thres);
+  CKPT_VAR (plic_claim);
+  CKPT_VAR (plic_harts);
+}
+
 static void
 plic_check_irq (uint32 hart)
 {
@@ -1691,9 +1891,12 @@ static void
 plic_irq (int irq)
 {
   int i;
+  uint32 harts;
+
   plic_ip[0] |= (1 << irq);
-  for (i = 0; i < NCPU; i++)
+  for (harts = plic_harts; harts; harts &= harts - 1)
     {
+      i = __builtin_ctz (harts);
       plic_check_irq (i);
       rv32_check_lirq (i);
     }
@@ -1705,19 +1908,24 @@ plic_read (uint32 addr, uint32 * data)
   int hart;
   if (addr >= PLIC_THRES)
     {
-      hart = ((addr >> 12) & 0x0F) % NCPU;
+      hart = (addr - PLIC_THRES) >> 12;
+      if (hart >= ncpu)
+	return 4;
       if ((addr & PLIC_MASK1) == 0)
 	*data = plic_thres[hart];	// irq threshold, not used for now
       else
 	{
 	  *data = plic_claim[hart];
 	  plic_claim[hart] = 0;
+	  ebase.iosfx++;
 	  plic_ip[0] &= ~(1 << *data);
 	}
     }
   else if (addr >= PLIC_IENA)
     {
-      hart = ((addr >> 7) & 0x0F) % NCPU;
+      hart = (addr - PLIC_IENA) >> 7;
+      if (hart >= ncpu)
+	return 4;
       if (addr & 4)
 	*data = plic_ie[hart][1];	// irq enable
       else
@@ -1725,7 +1933,6 @@ plic_read (uint32 addr, uint32 * data)
     }
   else if (addr >= PLIC_IPEND)
     {
-      hart = ((addr >> 7) & 0x0F) % NCPU;
       if (addr & 4)
 	*data = plic_ip[1];	// irq pending
       else
@@ -1746,7 +1953,9 @@ plic_write (uint32 addr, uint32 * data, uint32 sz)
   int hart;
   if (addr >= PLIC_THRES)
     {
-      hart = ((addr >> 12) & 0x0F) % NCPU;
+      hart = (addr - PLIC_THRES) >> 12;
+      if (hart >= ncpu)
+	return 1;
       if ((addr & PLIC_MASK1) == 0)
 	plic_thres[hart] = *data;	// irq threshold, not used for now
       else
@@ -1754,11 +1963,17 @@ plic_write (uint32 addr, uint32 * data, uint32 sz)
     }
   else if (addr >= PLIC_IENA)
     {
-      hart = ((addr >> 7) & 0x0F) % NCPU;
+      hart = (addr - PLIC_IENA) >> 7;
+      if (hart >= ncpu)
+	return 1;
       if (addr & 4)
 	plic_ie[hart][1] = *data;	// irq enable
       else
 	plic_ie[hart][0] = *data;
+      if (plic_ie[hart][0])
+	plic_harts |= 1u << hart;
+      else
+	plic_harts &= ~(1u << hart);
     }
   else if (addr < PLIC_IPEND)
     {
@@ -1777,7 +1992,7 @@ plic_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore plic = {
-  NULL, NULL, plic_read, plic_write, plic_add
+  plic_init, NULL, plic_read, plic_write, plic_add, "PLIC"
 };
 
 /* ------------------- sifive test module --------------*/
@@ -1813,5 +2028,5 @@ s5test_add (int irq, uint32 addr, uint32 mask)
 }
 
 const struct grlib_ipcore s5test = {
-  NULL, NULL, NULL, s5test_write, s5test_add
+  NULL, NULL, NULL, s5test_write, s5test_add, "TEST"
 };
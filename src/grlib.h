@@ -79,6 +79,7 @@ struct grlib_ipcore
   int (*read) (uint32 addr, uint32 * data);
   int (*write) (uint32 addr, uint32 * data, uint32 size);
   void (*add) (int irq, uint32 addr, uint32 mask);
+  const char *name;
 };
 
 struct grlib_buscore
@@ -87,6 +88,8 @@ struct grlib_buscore
   uint32 start;
   uint32 end;
   uint32 mask;
+  uint64 reads;			/* accesses, for perf */
+  uint64 writes;
 };
 
 extern void grlib_ahbs_add (const struct grlib_ipcore *core, int irq,
@@ -101,6 +104,7 @@ extern void grlib_store_bytes (char *mem, uint32 waddr, uint32 * data,
 			       int32 sz);
 extern void grlib_boot_init (void);
 extern void grlib_reset (void);
+extern void grlib_bus_stat (int clear);
 extern void apbuart_init_stdio (void);
 extern void apbuart_restore_stdio (void);
 extern const struct grlib_ipcore gptimer_apbctrl1, gptimer_apbctrl2, irqmp,
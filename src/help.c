@@ -26,10 +26,12 @@ sis_usage ()
 
   printf ("usage: sis [-uart1 uart_device1] [-uart2 uart_device2]\n");
   printf ("[-m <n>] [-dumbio] [-gdb] [-port port]\n");
-  printf ("[-cov] [-nfp] [-ift] [-wrp] [-rom8] [-uben]\n");
-  printf ("[-freq frequency] [-c batch_file]\n");
+  printf ("[-cov] [-nfp] [-fpexact] [-ift] [-wrp] [-rom8] [-uben]\n");
+  printf ("[-freq frequency] [-ram size] [-rom size] [-hugepage] [-image file]\n");
+  printf ("[-c batch_file]\n");
   printf ("[-erc32] [-leon2] [-leon3] [-griscv] [-rv32]\n");
-  printf ("[-d] [-v] [-rt] [-bridge name] [files]\n");
+  printf ("[-d cycles] [-dmax cycles] [-v] [-rt] [-jit] [-jitthreaded] [-mt]\n");
+  printf ("[-stat] [-noidle] [-l1] [-bridge name] [files]\n");
 }
 
 void
@@ -37,6 +39,7 @@ gen_help ()
 {
 
   printf ("\n batch <file>          execute a batch file of SIS commands\n");
+  printf (" baseline              mark the state that rewind returns to\n");
   printf (" +bp <addr>            add a breakpoint at <addr>\n");
   printf (" -bp <num>             delete breakpoint <num>\n");
   printf (" bp                    print all breakpoints\n");
@@ -46,8 +49,10 @@ gen_help ()
   printf (" deb <level>           set debug level\n");
   printf
     (" dis [addr] [count]    disassemble [count] instructions at address [addr]\n");
+  printf (" dump <file>           save RAM and ROM to a memory image for -image\n");
   printf (" echo <string>         print <string> to the simulator window\n");
   printf (" float                 print the FPU registers\n");
+  printf (" fork <n> <script>     run one child per script line, n at a time\n");
   printf
     (" go <addr> [icnt]      start execution at <addr> for [icnt] instructions\n");
   printf (" hist [trace_length]   enable/show trace history\n");
@@ -58,8 +63,11 @@ gen_help ()
   printf (" perf [reset]          show/reset performance statistics\n");
   printf
     (" reg [w<0-7>]          show integer registers (or windows, eg 're w2')\n");
+  printf (" restore <file>        continue from a checkpoint taken with save\n");
+  printf (" rewind                return to the baseline, restoring written pages\n");
   printf
-    (" run [inst_count]      reset and start execution for [icnt] instruction\n");
+    (" run [inst_count]      reset or rewind, then run for [icnt] instruction\n");
+  printf (" save <file>           save a checkpoint of the whole system\n");
   printf (" step                  single step\n");
   printf (" tra [inst_count]      trace [inst_count] instructions\n");
   printf ("\n type Ctrl-C to interrupt execution\n\n");
@@ -70,6 +70,8 @@ sim_create_inferior ()
 
   if (sis_verbose)
     printf ("interf: sim_create_inferior()");
+  if (baseline_rewind () >= 0)
+    return;
   ebase.simtime = 0;
   ebase.simstart = 0;
   reset_all ();
@@ -141,6 +141,7 @@ static void set_irq (int32 level);
 static int32 apb_read (uint32 addr, uint32 * data);
 static int apb_write (uint32 addr, uint32 data);
 static void port_init (void);
+static void ckpt_init (void);
 static uint32 grlib_read_uart (uint32 addr);
 static void grlib_write_uart (uint32 addr, uint32 data);
 static void flush_uart (void);
@@ -166,9 +167,45 @@ init_sim (void)
   mem_init ();
   port_init ();
   gpt_init ();
+  ckpt_init ();
   ebase.ramstart = RAM_START;
 }
 
+/* Device state saved in checkpoints.  */
+
+static void
+ckpt_init (void)
+{
+  CKPT_VAR (irqctrl_ipr);
+  CKPT_VAR (irqctrl_imr);
+  CKPT_VAR (irqctrl_ifr);
+  CKPT_VAR (gpt_scaler);
+  CKPT_VAR (gpt_scaler_start);
+  CKPT_VAR (gpt_counter);
+  CKPT_VAR (gpt_reload);
+  CKPT_VAR (gpt_ctrl);
+  CKPT_VAR (cache_ctrl);
+  CKPT_VAR (Ucontrol);
+  CKPT_VAR (aq);
+  CKPT_VAR (bq);
+  CKPT_VAR (anum);
+  CKPT_VAR (aind);
+  CKPT_VAR (bnum);
+  CKPT_VAR (bind);
+  CKPT_VAR (wbufa);
+  CKPT_VAR (wbufb);
+  CKPT_VAR (wnuma);
+  CKPT_VAR (wnumb);
+  CKPT_VAR (uarta_sreg);
+  CKPT_VAR (uarta_hreg);
+  CKPT_VAR (uart_stat_reg);
+  CKPT_VAR (uarta_data);
+  CKPT_EVENT (uarta_tx);
+  CKPT_EVENT (uart_rx);
+  CKPT_EVENT (uart_intr);
+  CKPT_EVENT (gpt_intr);
+}
+
 /* Power-on reset init. */
 
 static void
@@ -194,7 +231,7 @@ error_mode (uint32 pc)
 static void
 mem_init (void)
 {
-
+  mem_alloc (RAM_SIZE, ROM_SIZE);
   if (sis_verbose)
     printf ("RAM start: 0x%x, RAM size: %d K, ROM size: %d K\n",
 	    RAM_START, (RAM_MASK + 1) / 1024, (ROM_MASK + 1) / 1024);
@@ -300,6 +337,7 @@ apb_read (uint32 addr, uint32 * data)
     case APBUART_RXTX:		/* 0x100 */
     case APBUART_STATUS:	/* 0x104 */
       *data = grlib_read_uart (addr);
+      ebase.iosfx++;
       break;
 
     case IRQCTRL_IPR:		/* 0x204 */
@@ -316,6 +354,7 @@ apb_read (uint32 addr, uint32 * data)
 
     case TIMER_SCALER:		/* 0x300 */
       *data = gpt_scaler - (now () - gpt_scaler_start);
+      ebase.iosfx++;		/* changes without an event */
       break;
 
     case TIMER_SCLOAD:		/* 0x304 */
@@ -889,6 +928,7 @@ memory_write (uint32 addr, uint32 * data, int32 sz, int32 * ws)
   if ((addr >= RAM_START) && (addr < RAM_END))
     {
       waddr = addr & RAM_MASK;
+      PDC_WRITE (addr, 1 << sz);
       store_bytes (ramb, waddr, data, sz, ws);
       return 0;
     }
@@ -906,6 +946,7 @@ memory_write (uint32 addr, uint32 * data, int32 sz, int32 * ws)
   else if (addr < ROM_END)
     {
       *ws = 0;
+      PDC_WRITE (addr, 1 << sz);
       store_bytes (romb, addr, data, sz, ws);
       return 0;
     }
@@ -929,6 +970,26 @@ get_mem_ptr (uint32 addr, uint32 size)
   return (char *) -1;
 }
 
+/* RAM and ROM pages for the software TLB */
+
+static int
+map_page (uint32 addr, struct tlbent *e)
+{
+  e->rws = 0;
+  e->wws[0] = e->wws[1] = e->wws[2] = e->wws[3] = 0;
+  if ((addr >= RAM_START) && (addr < RAM_END))
+    {
+      e->mem = &ramb[addr & RAM_MASK];
+      return TLB_R | TLB_W;
+    }
+  else if (addr < ROM_END)
+    {
+      e->mem = &romb[addr];
+      return TLB_R | TLB_W;
+    }
+  return 0;
+}
+
 static int
 sis_memory_write (uint32 addr, const char *data, uint32 length)
 {
@@ -937,6 +998,7 @@ sis_memory_write (uint32 addr, const char *data, uint32 length)
   if ((mem = get_mem_ptr (addr, length)) == ((char *) -1))
     return 0;
 
+  PDC_WRITE (addr, length);
   memcpy (mem, data, length);
   return length;
 }
@@ -992,5 +1054,8 @@ const struct memsys leon2 = {
   memory_write,
   sis_memory_write,
   sis_memory_read,
-  boot_init
+  boot_init,
+  get_mem_ptr,
+  NULL,
+  map_page
 };
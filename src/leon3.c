@@ -66,6 +66,8 @@ init_sim (void)
 {
   int i;
 
+  mem_alloc (RAM_SIZE, ROM_SIZE);
+
   /* Use extended interrupt line of GR712RC */
   irqmp_extirq = 12;
 
@@ -179,11 +181,13 @@ memory_write (uint32 addr, uint32 * data, int32 sz, int32 * ws)
   if ((addr >= RAM_START) && (addr < RAM_END))
     {
       waddr = addr & RAM_MASK;
+      PDC_WRITE (addr, 1 << sz);
       grlib_store_bytes (ramb, waddr, data, sz);
       return 0;
     }
   else if ((addr >= ROM_START) && (addr < ROM_END))
     {
+      PDC_WRITE (addr, 1 << sz);
       grlib_store_bytes (romb, addr, data, sz);
       return 0;
     }
@@ -216,6 +220,27 @@ get_mem_ptr (uint32 addr, uint32 size)
   return NULL;
 }
 
+/* RAM and ROM pages for the software TLB */
+
+static int
+map_page (uint32 addr, struct tlbent *e)
+{
+  e->wws[0] = e->wws[1] = e->wws[2] = e->wws[3] = 0;
+  if ((addr >= RAM_START) && (addr < RAM_END))
+    {
+      e->mem = &ramb[addr & RAM_MASK];
+      e->rws = 0;
+      return TLB_R | TLB_W;
+    }
+  else if ((addr >= ROM_START) && (addr < ROM_END))
+    {
+      e->mem = &romb[addr & ROM_MASK];
+      e->rws = 2;
+      return TLB_R | TLB_W;
+    }
+  return 0;
+}
+
 static int
 sis_memory_write (uint32 addr, const char *data, uint32 length)
 {
@@ -224,6 +249,7 @@ sis_memory_write (uint32 addr, const char *data, uint32 length)
 
   if ((mem = get_mem_ptr (addr, length)) != NULL)
     {
+      PDC_WRITE (addr, length);
       memcpy (mem, data, length);
       return length;
     }
@@ -258,7 +284,7 @@ boot_init (void)
   int i;
 
   grlib_boot_init ();
-  for (i = 0; i < NCPU; i++)
+  for (i = 0; i < ncpu_alloc; i++)
     {
       sregs[i].wim = 2;
       sregs[i].psr = 0xF30010e0;
@@ -284,5 +310,7 @@ const struct memsys leon3 = {
   sis_memory_read,
   boot_init,
   get_mem_ptr,
-  grlib_set_irq
+  grlib_set_irq,
+  map_page,
+  grlib_bus_stat
 };
@@ -52,7 +52,8 @@ riscv_get_accex ()
   return accx;
 }
 
-/* How to map RISCV FSR onto the host */
+/* How to map RISCV FSR onto the host.  Only reprograms the host
+   when the rounding mode differs from the one in effect. */
 static void
 riscv_set_fsr (fsr)
      uint32 fsr;
@@ -76,7 +77,37 @@ riscv_set_fsr (fsr)
       fround = FE_UPWARD;
       break;
     }
-  fesetround (fround);
+  set_fround (fround);
+}
+
+/* fflags only accrue, so FP instructions leave the host exception
+   flags to accumulate, and riscv_sync_fflags () folds them into the
+   fflags of the core that raised them when fflags or fcsr is
+   accessed, another core uses the FPU, or the simulation stops. */
+
+static __thread struct pstate *fflags_owner;	/* core with pending host flags */
+
+void
+riscv_sync_fflags (void)
+{
+  if (fflags_owner == NULL)
+    return;
+  fflags_owner->fsr |= riscv_get_accex ();
+  clear_accex ();
+  fflags_owner = NULL;
+}
+
+/* Prepare the host FPU for an FP instruction of sregs */
+static inline void
+riscv_fp_begin (struct pstate *sregs)
+{
+  riscv_set_fsr (sregs->fsr);
+  if (fflags_owner != sregs)
+    {
+      riscv_sync_fflags ();
+      clear_accex ();
+      fflags_owner = sregs;
+    }
 }
 
 static int
@@ -86,6 +117,9 @@ set_csr (address, sregs, value)
      uint32 value;
 {
   int res = 0;
+
+  /* devices update mip from other threads with -mt */
+  bus_lock ();
   switch (address)
     {
     case CSR_MSTATUS:
@@ -110,6 +144,7 @@ set_csr (address, sregs, value)
       sregs->mcause = value;
       break;
     case CSR_FFLAGS:
+      riscv_sync_fflags ();
       sregs->fsr = (sregs->fsr & ~0x1f) | value;
       riscv_set_fsr (sregs->fsr);
       break;
@@ -118,6 +153,7 @@ set_csr (address, sregs, value)
       riscv_set_fsr (sregs->fsr);
       break;
     case CSR_FCSR:
+      riscv_sync_fflags ();
       sregs->fsr = value;
       riscv_set_fsr (sregs->fsr);
       break;
@@ -128,6 +164,7 @@ set_csr (address, sregs, value)
     printf (" %8" PRIu64 " set csr 0x%03X :  %08X\n",
 	    sregs->simtime, address, value);
   rv32_check_lirq (sregs->cpu);
+  bus_unlock ();
   return res;
 }
 
@@ -167,9 +204,11 @@ get_csr (address, sregs)
       return (0x40000100);
       break;
     case CSR_TIME:
+      ebase.iosfx++;		/* changes without an event */
       return (sregs->simtime & 0xffffffff);
       break;
     case CSR_TIMEH:
+      ebase.iosfx++;
       tmp = sregs->simtime >> 32;
       return tmp & 0xffffffff;
       break;
@@ -180,12 +219,14 @@ get_csr (address, sregs)
       return (sregs->mscratch);
       break;
     case CSR_FFLAGS:
+      riscv_sync_fflags ();
       return (sregs->fsr & 0x1f);
       break;
     case CSR_FRM:
       return ((sregs->fsr >> 5) & 0x7);
       break;
     case CSR_FCSR:
+      riscv_sync_fflags ();
       return (sregs->fsr);
       break;
     default:
@@ -207,6 +248,8 @@ rv32_check_lirq (int cpu)
 	ext_irl[cpu] = 0x13;
       else if (tmpirq & MIP_MTIP)
 	ext_irl[cpu] = 0x17;
+      if (ext_irl[cpu])
+	mp_wake (cpu);
       if ((ext_irl[cpu]) && sregs[cpu].pwd_mode)
 	{
 	  sregs[cpu].pwdtime += sregs[cpu].simtime - sregs[cpu].pwdstart;
@@ -215,35 +258,131 @@ rv32_check_lirq (int cpu)
     }
 }
 
+/* New memory value of an AMO from the old one and the operand in val,
+   returns 1 for an unknown operation */
+
 static int
+amo_alu (uint32 funct5, uint32 data, uint32 * val)
+{
+  switch (funct5)
+    {
+    case AMOSWAP:
+      break;
+    case AMOADD:
+      *val = (int32) data + (int32) * val;
+      break;
+    case AMOXOR:
+      *val = data ^ *val;
+      break;
+    case AMOOR:
+      *val = data | *val;
+      break;
+    case AMOAND:
+      *val = data & *val;
+      break;
+    case AMOMIN:
+      if ((int32) data < (int32) * val)
+	*val = data;
+      break;
+    case AMOMAX:
+      if ((int32) data > (int32) * val)
+	*val = data;
+      break;
+    case AMOMINU:
+      if (data < *val)
+	*val = data;
+      break;
+    case AMOMAXU:
+      if (data > *val)
+	*val = data;
+      break;
+    default:
+      return 1;
+    }
+  return 0;
+}
+
+int
 riscv_dispatch_instruction (sregs)
      struct pstate *sregs;
 {
 
-  uint32 op1, op2, op3, rd, rs1, rs2, npc, btrue, inst, *wdata;
+  uint32 op1, op2, op3, rd, rs1, rs2, npc, btrue, inst, *wdata, *p, old;
   int32 sop1, sop2, result, offset;
   int32 pc, data, address, ws, mexc, fcc;
   unsigned char op, funct3, funct5, rs1p, rs2p, funct2, frs1, frs2, frd;
   int64 sop64a, sop64b;
   uint64 op64a, op64b;
+  struct pdinst *pd;
+#ifdef THREADED_DISPATCH
+  uint32 ipc;
 
+  /* Handlers by major opcode, and by quadrant and funct3 for
+     compressed instructions.  Entries without a handler of their own
+     go through the switch. */
+  static const void *const td_rv[32] = {
+    [0 ... 31] = &&td_switch,
+    [OP_LUI] = &&td_OP_LUI,
+    [OP_BRANCH] = &&td_OP_BRANCH,
+    [OP_JAL] = &&td_OP_JAL,
+    [OP_JALR] = &&td_OP_JALR,
+    [OP_AUIPC] = &&td_OP_AUIPC,
+    [OP_IMM] = &&td_OP_IMM,
+    [OP_REG] = &&td_OP_REG,
+    [OP_STORE] = &&td_OP_STORE,
+    [OP_FSW] = &&td_OP_FSW,
+    [OP_LOAD] = &&td_OP_LOAD,
+    [OP_AMO] = &&td_OP_AMO,
+    [OP_SYS] = &&td_OP_SYS,
+    [OP_FLOAD] = &&td_OP_FLOAD,
+    [OP_FENCE] = &&td_OP_FENCE,
+  };
+  static const void *const td_rvc[24] = {
+    [0 ... 7] = &&td_c0,
+    [8 ... 23] = &&td_switch_rvc,
+    [8 + CADDI] = &&td_CADDI,
+    [8 + CLI] = &&td_CLI,
+    [8 + CJAL] = &&td_CJAL,
+    [8 + CJNL] = &&td_CJNL,
+    [8 + CADDI16SP] = &&td_CADDI16SP,
+    [8 + CARITH] = &&td_CARITH,
+    [8 + CBEQZ] = &&td_CBEQZ,
+    [8 + CBNEZ] = &&td_CBNEZ,
+    [16] = &&td_cslli,
+    [18] = &&td_clwsp,
+    [20] = &&td_cr,
+    [22] = &&td_cswsp,
+  };
+
+  /* GCC assumes any handler can be reached from any computed goto, and
+     would see these used before they are set */
+  op = rs1p = rs2p = 0;
+  rd = 0;
+td_start:
+  ipc = sregs->pc;
+#endif
+  pd = sregs->pd;
   sregs->ninst++;
 
 #ifdef C_EXTENSION
-  if ((sregs->inst & 3) != 3)
+  if (pd->len == 2)
     {
       /* Compressed instructions  (RV32C) */
       npc = sregs->pc + 2;
-      funct3 = (sregs->inst >> 13) & 7;
-      rs1p = ((sregs->inst >> 7) & 7) | 8;
-      rs2p = ((sregs->inst >> 2) & 7) | 8;
-      rs1 = ((sregs->inst >> 7) & 0x1f);
-      rs2 = ((sregs->inst >> 2) & 0x1f);
-      switch (sregs->inst & 3)
+      funct3 = pd->fn;
+      rs1 = pd->rs1;
+      rs2 = pd->rs2;
+      rs1p = (rs1 & 7) | 8;
+      rs2p = (rs2 & 7) | 8;
+#ifdef THREADED_DISPATCH
+      goto *td_rvc[(pd->op << 3) | funct3];
+td_switch_rvc:
+#endif
+      switch (pd->op)
 	{
 	case 0:
-	  address =
-	    (int32) sregs->r[rs1p] + (int32) EXTRACT_RVC_LW_IMM (sregs->inst);
+	TD_LABEL (td_c0)
+	  address = (int32) sregs->r[rs1p] + pd->imm;
 	  switch (funct3)
 	    {
 	    case CADDI4SPN:	/* addi rd', x2, nzuimm[9:2] */
@@ -254,7 +393,7 @@ riscv_dispatch_instruction (sregs)
 		}
 	      sregs->r[rs2p] =
 		(int32) sregs->r[2] +
-		(int32) EXTRACT_RVC_ADDI4SPN_IMM (sregs->inst);
+		pd->imm;
 	      break;
 	    case CLW:		/* lw rd', offset[6:2](rs1') */
 	      if (address & 0x3)
@@ -263,7 +402,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -282,7 +421,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_write (address, &sregs->r[rs2p], 2, &ws);
+	      mexc = tlb_write (sregs, address, &sregs->r[rs2p], 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -297,7 +436,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -314,17 +453,15 @@ riscv_dispatch_instruction (sregs)
 	      break;
 #ifdef FPU_D_ENABLED
 	    case CFLD:		/* ld frd', offset[7:3](rs1') */
-	      address = (int32) sregs->r[rs1p] +
-		(int32) EXTRACT_RVC_LD_IMM (sregs->inst);
 	      if (address & LDDM)
 		{
 		  sregs->trap = TRAP_LMALI;
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
-	      mexc |= ms->memory_read (address + 4, &op2, &ws);
+	      mexc |= tlb_read (sregs, address + 4, &op2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -346,9 +483,9 @@ riscv_dispatch_instruction (sregs)
 		  break;
 		}
 	      mexc =
-		ms->memory_write (address,
-				  (uint32 *) & sregs->fsi[(rs2p << 1) + BEH],
-				  2, &ws);
+		tlb_write (sregs, address,
+			   (uint32 *) & sregs->fsi[(rs2p << 1) + BEH],
+			   2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -358,8 +495,6 @@ riscv_dispatch_instruction (sregs)
 	      break;
 #ifdef FPU_D_ENABLED
 	    case CFSD:		/* sd frs2', offset[7:3](rs1') */
-	      address = (int32) sregs->r[rs1p] +
-		(int32) EXTRACT_RVC_LD_IMM (sregs->inst);
 	      if (address & LDDM)
 		{
 		  sregs->trap = TRAP_SMALI;
@@ -367,14 +502,14 @@ riscv_dispatch_instruction (sregs)
 		  break;
 		}
 	      mexc =
-		ms->memory_write (address,
-				  (uint32 *) & sregs->fsi[(rs2p << 1) + BEH],
-				  2, &ws);
+		tlb_write (sregs, address,
+			   (uint32 *) & sregs->fsi[(rs2p << 1) + BEH],
+			   2, &ws);
 	      sregs->hold += ws;
 	      mexc |=
-		ms->memory_write (address + 4,
-				  (uint32 *) & sregs->fsi[(rs2p << 1) + 1 -
-							  BEH], 2, &ws);
+		tlb_write (sregs, address + 4,
+			   (uint32 *) & sregs->fsi[(rs2p << 1) + 1 -
+						   BEH], 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -390,20 +525,17 @@ riscv_dispatch_instruction (sregs)
 	case 1:
 	  switch (funct3)
 	    {
-	    case CADDI:	/* addi rd, rd, nzimm[5:0] */
+	    TCASE (CADDI):	/* addi rd, rd, nzimm[5:0] */
 	      sop1 = sregs->r[rs1];
-	      sop2 = EXTRACT_RVC_IMM (sregs->inst);
+	      sop2 = pd->imm;
 	      sregs->r[rs1] = sop1 + sop2;
 	      break;
-	    case CLI:		/* addi rd, x0, imm[5:0] */
-	      sregs->r[rs1] = EXTRACT_RVC_IMM (sregs->inst);
+	    TCASE (CLI):		/* addi rd, x0, imm[5:0] */
+	      sregs->r[rs1] = pd->imm;
 	      break;
-	    case CJAL:		/* jal x1, offset[11:1] */
-	    case CJNL:		/* jal x0, offset[11:1] */
-#ifdef STAT
-	      sregs->nbranch++;
-#endif
-	      offset = EXTRACT_RVC_J_IMM (sregs->inst);
+	    TCASE (CJAL):		/* jal x1, offset[11:1] */
+	    TCASE (CJNL):		/* jal x0, offset[11:1] */
+	      offset = pd->imm;
 	      if (funct3 == CJAL)
 		sregs->r[1] = npc;
 	      npc = sregs->pc + offset;
@@ -413,20 +545,20 @@ riscv_dispatch_instruction (sregs)
 	      if (ebase.coven)
 		cov_jmp (sregs->pc, npc);
 	      break;
-	    case CADDI16SP:	/* addi x2, x2, nzimm[9:4] */
+	    TCASE (CADDI16SP):	/* addi x2, x2, nzimm[9:4] */
 	      if (rs1 == 2)
 		{
 		  sop1 = sregs->r[rs1];
-		  sop2 = EXTRACT_RVC_ADDI16SP_IMM (sregs->inst);
+		  sop2 = pd->imm;
 		  sregs->r[rs1] = sop1 + sop2;
 		}
 	      else
 		{		/* CLUI:  lui rd, nzuimm[17:12 */
-		  sregs->r[rs1] = EXTRACT_RVC_LUI_IMM (sregs->inst);
+		  sregs->r[rs1] = pd->imm;
 		}
 	      break;
-	    case CARITH:
-	      sop2 = EXTRACT_RVC_IMM (sregs->inst);
+	    TCASE (CARITH):
+	      sop2 = pd->imm;
 	      switch ((sregs->inst >> 10) & 7)
 		{
 		case 0:	/* srli rd', rd', shamt[5:0] */
@@ -462,8 +594,8 @@ riscv_dispatch_instruction (sregs)
 		  sregs->trap = TRAP_ILLEG;
 		}
 	      break;
-	    case CBEQZ:	/* beq rs1', x0, offset[8:1] */
-	      offset = EXTRACT_RVC_B_IMM (sregs->inst);
+	    TCASE (CBEQZ):	/* beq rs1', x0, offset[8:1] */
+	      offset = pd->imm;
 	      if (!sregs->r[rs1p])
 		{
 		  npc = sregs->pc + offset;
@@ -484,8 +616,8 @@ riscv_dispatch_instruction (sregs)
 		}
 	      npc &= ~1;
 	      break;
-	    case CBNEZ:	/* bne rs1', x0, offset[8:1] */
-	      offset = EXTRACT_RVC_B_IMM (sregs->inst);
+	    TCASE (CBNEZ):	/* bne rs1', x0, offset[8:1] */
+	      offset = pd->imm;
 	      if (sregs->r[rs1p])
 		{
 		  npc = sregs->pc + offset;
@@ -514,18 +646,20 @@ riscv_dispatch_instruction (sregs)
 	  switch (funct3)
 	    {
 	    case 0:		/* slli rd', rd', shamt[5:0] */
-	      sop2 = EXTRACT_RVC_IMM (sregs->inst);
+	    TD_LABEL (td_cslli)
+	      sop2 = pd->imm;
 	      sregs->r[rs1] <<= sop2;	/* SLL */
 	      break;
 	    case 2:		/* LWSP: lw rd, offset[7:2](x2) */
-	      address = sregs->r[2] + EXTRACT_RVC_LWSP_IMM (sregs->inst);
+	    TD_LABEL (td_clwsp)
+	      address = sregs->r[2] + pd->imm;
 	      if (address & 0x3)
 		{
 		  sregs->trap = TRAP_LMALI;
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -539,17 +673,17 @@ riscv_dispatch_instruction (sregs)
 	      break;
 #ifdef FPU_D_ENABLED
 	    case 1:		/* FLDSP: ld frd, offset[8:3](x2) */
-	      address = sregs->r[2] + EXTRACT_RVC_LDSP_IMM (sregs->inst);
+	      address = sregs->r[2] + pd->imm;
 	      if (address & LDDM)
 		{
 		  sregs->trap = TRAP_LMALI;
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (!mexc)
-		mexc = ms->memory_read (address + 4, &op2, &ws);
+		mexc = tlb_read (sregs, address + 4, &op2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -564,14 +698,14 @@ riscv_dispatch_instruction (sregs)
 	      break;
 #endif
 	    case 3:		/* FLWSP: lw frd, offset[7:2](x2) */
-	      address = sregs->r[2] + EXTRACT_RVC_LWSP_IMM (sregs->inst);
+	      address = sregs->r[2] + pd->imm;
 	      if (address & 0x3)
 		{
 		  sregs->trap = TRAP_LMALI;
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -584,6 +718,7 @@ riscv_dispatch_instruction (sregs)
 		}
 	      break;
 	    case 4:
+	    TD_LABEL (td_cr)
 	      if ((sregs->inst >> 12) & 1)
 		{
 		  if (rs1)
@@ -595,9 +730,6 @@ riscv_dispatch_instruction (sregs)
 			}
 		      else
 			{	/* jalr x1, rs1, 0 */
-#ifdef STAT
-			  sregs->nbranch++;
-#endif
 			  sregs->r[1] = npc;
 			  npc = sregs->r[rs1];
 			  npc &= ~1;
@@ -632,14 +764,15 @@ riscv_dispatch_instruction (sregs)
 		}
 	      break;
 	    case 6:		/* SWSP: sw rs2, offset[7:2](x2) */
-	      address = sregs->r[2] + EXTRACT_RVC_SWSP_IMM (sregs->inst);
+	    TD_LABEL (td_cswsp)
+	      address = sregs->r[2] + pd->imm;
 	      if (address & 0x3)
 		{
 		  sregs->trap = TRAP_SMALI;
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_write (address, &sregs->r[rs2], 2, &ws);
+	      mexc = tlb_write (sregs, address, &sregs->r[rs2], 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -649,7 +782,7 @@ riscv_dispatch_instruction (sregs)
 	      break;
 #ifdef FPU_D_ENABLED
 	    case 5:		/* FSDSP: sw frs2, offset[8:3](x2) */
-	      address = sregs->r[2] + EXTRACT_RVC_SDSP_IMM (sregs->inst);
+	      address = sregs->r[2] + pd->imm;
 	      if (address & LDDM)
 		{
 		  sregs->trap = TRAP_SMALI;
@@ -657,14 +790,14 @@ riscv_dispatch_instruction (sregs)
 		  break;
 		}
 	      mexc =
-		ms->memory_write (address,
-				  (uint32 *) & sregs->fsi[(rs2 << 1) + BEH],
-				  2, &ws);
+		tlb_write (sregs, address,
+			   (uint32 *) & sregs->fsi[(rs2 << 1) + BEH],
+			   2, &ws);
 	      sregs->hold += ws;
 	      mexc |=
-		ms->memory_write (address + 4,
-				  (uint32 *) & sregs->fsi[(rs2 << 1) + 1 -
-							  BEH], 2, &ws);
+		tlb_write (sregs, address + 4,
+			   (uint32 *) & sregs->fsi[(rs2 << 1) + 1 -
+						   BEH], 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -674,7 +807,7 @@ riscv_dispatch_instruction (sregs)
 	      break;
 #endif
 	    case 7:		/* FSWSP: sw frs2, offset[7:2](x2) */
-	      address = sregs->r[2] + EXTRACT_RVC_SWSP_IMM (sregs->inst);
+	      address = sregs->r[2] + pd->imm;
 	      if (address & 0x3)
 		{
 		  sregs->trap = TRAP_SMALI;
@@ -682,9 +815,9 @@ riscv_dispatch_instruction (sregs)
 		  break;
 		}
 	      mexc =
-		ms->memory_write (address,
-				  (uint32 *) & sregs->fsi[(rs2 << 1) + BEH],
-				  2, &ws);
+		tlb_write (sregs, address,
+			   (uint32 *) & sregs->fsi[(rs2 << 1) + BEH],
+			   2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -706,28 +839,28 @@ riscv_dispatch_instruction (sregs)
 #endif
     {
       /* Regular instructions  (RV32IA) */
-      op = (sregs->inst >> 2) & 0x1f;
-      funct3 = (sregs->inst >> 12) & 0x7;
-      rd = (sregs->inst >> 7) & 0x1f;
-      rs1 = (sregs->inst >> 15) & 0x1f;
-      rs2 = (sregs->inst >> 20) & 0x1f;
+      op = pd->op;
+      funct3 = pd->fn;
+      rd = pd->rd;
+      rs1 = pd->rs1;
+      rs2 = pd->rs2;
       npc = sregs->pc + 4;
 
       op1 = sregs->r[rs1];
       op2 = sregs->r[rs2];
 
+#ifdef THREADED_DISPATCH
+      goto *td_rv[op];
+td_switch:
+#endif
       switch (op)
 	{
-	case OP_LUI:
-	  sop1 = sregs->inst;
-	  sregs->r[rd] = ((sop1 >> 12) << 12);
+	TCASE (OP_LUI):
+	  sregs->r[rd] = pd->imm;
 	  break;
-	case OP_BRANCH:
-#ifdef STAT
-	  sregs->nbranch++;
-#endif
+	TCASE (OP_BRANCH):
 	  btrue = 0;
-	  offset = EXTRACT_SBTYPE_IMM (sregs->inst);
+	  offset = pd->imm;
 	  sop1 = op1;
 	  sop2 = op2;
 	  switch (funct3)
@@ -779,11 +912,8 @@ riscv_dispatch_instruction (sregs)
 	    }
 	  npc &= ~1;
 	  break;
-	case OP_JAL:		/* JAL */
-#ifdef STAT
-	  sregs->nbranch++;
-#endif
-	  offset = EXTRACT_UJTYPE_IMM (sregs->inst);
+	TCASE (OP_JAL):		/* JAL */
+	  offset = pd->imm;
 	  sregs->r[rd] = npc;
 	  npc = sregs->pc + offset;
 	  npc &= ~1;
@@ -793,11 +923,8 @@ riscv_dispatch_instruction (sregs)
 	    cov_jmp (sregs->pc, npc);
 	  break;
 
-	case OP_JALR:		/* JALR */
-#ifdef STAT
-	  sregs->nbranch++;
-#endif
-	  offset = EXTRACT_ITYPE_IMM (sregs->inst);
+	TCASE (OP_JALR):		/* JALR */
+	  offset = pd->imm;
 	  sregs->r[rd] = npc;
 	  npc = op1 + offset;
 	  npc &= ~1;
@@ -808,13 +935,11 @@ riscv_dispatch_instruction (sregs)
 	  sregs->icnt += T_JALR;
 	  break;
 
-	case OP_AUIPC:		/* AUIPC */
-	  sop1 = sregs->inst;
-	  sop1 = ((sop1 >> 12) << 12);
-	  sregs->r[rd] = sregs->pc + sop1;
+	TCASE (OP_AUIPC):		/* AUIPC */
+	  sregs->r[rd] = sregs->pc + pd->imm;
 	  break;
-	case OP_IMM:		/* IMM */
-	  sop2 = EXTRACT_ITYPE_IMM (sregs->inst);
+	TCASE (OP_IMM):		/* IMM */
+	  sop2 = pd->imm;
 	  switch (funct3)
 	    {
 	    case IXOR:
@@ -860,7 +985,7 @@ riscv_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_ILLEG;
 	    }
 	  break;
-	case OP_REG:		/* REG */
+	TCASE (OP_REG):		/* REG */
 	  switch ((sregs->inst >> 25) & 3)
 	    {
 	    case 0:
@@ -966,7 +1091,7 @@ riscv_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_ILLEG;
 	    }
 	  break;
-	case OP_STORE:		/* store instructions */
+	TCASE (OP_STORE):		/* store instructions */
 
 	  /* skip store if we resume after a write watchpoint */
 	  if (sis_gdb_break && ebase.wphit)
@@ -975,10 +1100,7 @@ riscv_dispatch_instruction (sregs)
 	      break;
 	    }
 
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;
-#endif
-	  offset = EXTRACT_STYPE_IMM (sregs->inst);
+	  offset = pd->imm;
 	  address = op1 + offset;
 	  wdata = &(sregs->r[rs2]);
 
@@ -1003,7 +1125,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_write (address, wdata, 2, &ws);
+	      mexc = tlb_write (sregs, address, wdata, 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1012,7 +1134,7 @@ riscv_dispatch_instruction (sregs)
 		}
 	      break;
 	    case SB:
-	      mexc = ms->memory_write (address, wdata, 0, &ws);
+	      mexc = tlb_write (sregs, address, wdata, 0, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1027,7 +1149,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_write (address, wdata, 1, &ws);
+	      mexc = tlb_write (sregs, address, wdata, 1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1038,25 +1160,20 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-#ifdef ENABLE_L1CACHE
-	  if (ncpu > 1)
+	  if (l1cache && (ncpu > 1))
 	    {
 	      l1data_update (address, sregs->cpu);
 	      l1data_snoop (address, sregs->cpu);
 	    }
-#endif
 	  break;
-	case OP_FSW:		/* F store instructions */
+	TCASE (OP_FSW):		/* F store instructions */
 
 	  if (sis_gdb_break && ebase.wphit)
 	    {
 	      ebase.wphit = 0;
 	      break;
 	    }
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;
-#endif
-	  offset = EXTRACT_STYPE_IMM (sregs->inst);
+	  offset = pd->imm;
 	  address = op1 + offset;
 	  wdata = (uint32 *) & sregs->fsi[rs2 << 1];
 
@@ -1079,7 +1196,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_write (address, &wdata[BEH], 2, &ws);
+	      mexc = tlb_write (sregs, address, &wdata[BEH], 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1094,9 +1211,9 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_write (address, &wdata[BEH], 2, &ws);
+	      mexc = tlb_write (sregs, address, &wdata[BEH], 2, &ws);
 	      sregs->hold += ws;
-	      mexc |= ms->memory_write (address + 4, &wdata[1 - BEH], 2, &ws);
+	      mexc |= tlb_write (sregs, address + 4, &wdata[1 - BEH], 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1107,19 +1224,14 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-#ifdef ENABLE_L1CACHE
-	  if (ncpu > 1)
+	  if (l1cache && (ncpu > 1))
 	    {
 	      l1data_update (address, sregs->cpu);
 	      l1data_snoop (address, sregs->cpu);
 	    }
-#endif
 	  break;
-	case OP_LOAD:		/* load instructions */
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nload++;
-#endif
-	  offset = EXTRACT_ITYPE_IMM (sregs->inst);
+	TCASE (OP_LOAD):		/* load instructions */
+	  offset = pd->imm;
 	  address = op1 + offset;
 	  if (ebase.wprnum)
 	    {
@@ -1142,7 +1254,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1160,7 +1272,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->trap = TRAP_ILLEG;
 		  break;
 		}
-	      mexc = ms->memory_read (address & ~3, (uint32 *) & data, &ws);
+	      mexc = tlb_read (sregs, address & ~3, (uint32 *) & data, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1173,7 +1285,7 @@ riscv_dispatch_instruction (sregs)
 	      sregs->r[rd] = data;
 	      break;
 	    case LBU:
-	      mexc = ms->memory_read (address & ~3, &op1, &ws);
+	      mexc = tlb_read (sregs, address & ~3, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1191,7 +1303,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address & ~3, (uint32 *) & data, &ws);
+	      mexc = tlb_read (sregs, address & ~3, (uint32 *) & data, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1210,7 +1322,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address & ~3, &op1, &ws);
+	      mexc = tlb_read (sregs, address & ~3, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1226,20 +1338,15 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-#ifdef ENABLE_L1CACHE
-	  if (ncpu > 1)
+	  if (l1cache && (ncpu > 1))
 	    {
 	      l1data_update (address, sregs->cpu);
 	    }
-#endif
 	  break;
-	case OP_AMO:		/* atomic instructions */
+	TCASE (OP_AMO):		/* atomic instructions */
 	  address = op1;
 	  funct5 = (sregs->inst >> 27) & 0x1f;
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;
-	  sregs->nload++;
-#endif
+	  mp_xcpu = 1;
 	  sregs->icnt = T_AMO;
 	  switch (funct5)
 	    {
@@ -1250,7 +1357,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1261,6 +1368,7 @@ riscv_dispatch_instruction (sregs)
 		{
 		  sregs->r[rd] = op1;
 		  sregs->lrqa = address;
+		  sregs->lrqv = op1;
 		  sregs->lrq = 1;
 #ifdef DEBUG
 		  if (sis_verbose)
@@ -1276,9 +1384,20 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      if (sregs->lrq && (sregs->lrqa == address))
+	      if (sregs->lrq && (sregs->lrqa == address) && mt_running
+		  && (p = mt_word (sregs, address, &ws)))
 		{
-		  mexc = ms->memory_write (address, &op2, 2, &ws);
+		  /* the reservation holds if nobody changed the word */
+		  old = sregs->lrqv;
+		  sregs->r[rd] =
+		    !__atomic_compare_exchange_n (p, &old, op2, 0,
+						  __ATOMIC_SEQ_CST,
+						  __ATOMIC_SEQ_CST);
+		  sregs->hold += ws;
+		}
+	      else if (sregs->lrq && (sregs->lrqa == address))
+		{
+		  mexc = tlb_write (sregs, address, &op2, 2, &ws);
 		  sregs->hold += ws;
 		  if (mexc)
 		    {
@@ -1315,7 +1434,28 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, (uint32 *) & data, &ws);
+	      if (mt_running && (p = mt_word (sregs, address, &ws)))
+		{
+		  op1 = op2;
+		  if (amo_alu (funct5, 0, &op1))
+		    {
+		      sregs->trap = TRAP_ILLEG;
+		      break;
+		    }
+		  old = __atomic_load_n (p, __ATOMIC_RELAXED);
+		  do
+		    {
+		      op1 = op2;
+		      amo_alu (funct5, old, &op1);
+		    }
+		  while (!__atomic_compare_exchange_n (p, &old, op1, 1,
+						       __ATOMIC_SEQ_CST,
+						       __ATOMIC_RELAXED));
+		  sregs->hold += ws;
+		  sregs->r[rd] = old;
+		  break;
+		}
+	      mexc = tlb_read (sregs, address, (uint32 *) & data, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1323,44 +1463,12 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      switch (funct5)
+	      if (amo_alu (funct5, data, &op2))
 		{
-		case AMOSWAP:
-		  break;
-		case AMOADD:
-		  op2 = (int32) data + (int32) op2;
-		  break;
-		case AMOXOR:
-		  op2 = data ^ op2;
-		  break;
-		case AMOOR:
-		  op2 = data | op2;
-		  break;
-		case AMOAND:
-		  op2 = data & op2;
-		  break;
-		case AMOMIN:
-		  if ((int32) data < (int32) op2)
-		    op2 = data;
-		  break;
-		case AMOMAX:
-		  if ((int32) data > (int32) op2)
-		    op2 = data;
-		  break;
-		case AMOMINU:
-		  if ((uint32) data < (uint32) op2)
-		    op2 = data;
-		  break;
-		case AMOMAXU:
-		  if ((uint32) data > (uint32) op2)
-		    op2 = data;
-		  break;
-		default:
 		  sregs->trap = TRAP_ILLEG;
+		  break;
 		}
-	      if (sregs->trap)
-		break;
-	      mexc = ms->memory_write (address, &op2, 2, &ws);
+	      mexc = tlb_write (sregs, address, &op2, 2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1371,7 +1479,7 @@ riscv_dispatch_instruction (sregs)
 	      sregs->r[rd] = data;
 	    }
 	  break;
-	case OP_SYS:
+	TCASE (OP_SYS):
 	  address = sregs->inst >> 20;
 	  switch (funct3)
 	    {
@@ -1395,7 +1503,9 @@ riscv_dispatch_instruction (sregs)
 		  sregs->mode = sregs->mpp;
 		  sregs->mstatus |= (sregs->mstatus >> 4) & MSTATUS_MIE;
 		  sregs->mstatus |= MSTATUS_MPIE;	// set mstatus.mpie
+		  bus_lock ();
 		  rv32_check_lirq (sregs->cpu);
+		  bus_unlock ();
 		  if (ebase.coven)
 		    cov_jmp (sregs->pc, npc);
 		  break;
@@ -1457,11 +1567,8 @@ riscv_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_ILLEG;
 	    }
 	  break;
-	case OP_FLOAD:		/* float load instructions */
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nload++;
-#endif
-	  offset = EXTRACT_ITYPE_IMM (sregs->inst);
+	TCASE (OP_FLOAD):		/* float load instructions */
+	  offset = pd->imm;
 	  address = op1 + offset;
 	  if (ebase.wprnum)
 	    {
@@ -1484,7 +1591,7 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1504,10 +1611,10 @@ riscv_dispatch_instruction (sregs)
 		  sregs->wpaddress = address;
 		  break;
 		}
-	      mexc = ms->memory_read (address, &op1, &ws);
+	      mexc = tlb_read (sregs, address, &op1, &ws);
 	      sregs->hold += ws;
 	      if (!mexc)
-		mexc = ms->memory_read (address + 4, &op2, &ws);
+		mexc = tlb_read (sregs, address + 4, &op2, &ws);
 	      sregs->hold += ws;
 	      if (mexc)
 		{
@@ -1523,17 +1630,15 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-#ifdef ENABLE_L1CACHE
-	  if (ncpu > 1)
+	  if (l1cache && (ncpu > 1))
 	    {
 	      l1data_update (address, sregs->cpu);
 	    }
-#endif
 	  break;
 #ifdef FPU_ENABLED
 	case OP_FPU:
 	  sregs->finst++;
-	  clear_accex ();
+	  riscv_fp_begin (sregs);
 	  funct2 = (sregs->inst >> 25) & 3;
 	  funct5 = (sregs->inst >> 27);
 	  switch (funct2)
@@ -1903,12 +2008,10 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-	  sregs->fsr |= riscv_get_accex ();
-	  clear_accex ();
 	  break;
 	case OP_FMADD:
 	  sregs->finst++;
-	  clear_accex ();
+	  riscv_fp_begin (sregs);
 	  switch ((sregs->inst >> 25) & 3)
 	    {
 	    case 0:		/* OP_FMADDS */
@@ -1928,12 +2031,10 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-	  sregs->fsr |= riscv_get_accex ();
-	  clear_accex ();
 	  break;
 	case OP_FMSUB:
 	  sregs->finst++;
-	  clear_accex ();
+	  riscv_fp_begin (sregs);
 	  switch ((sregs->inst >> 25) & 3)
 	    {
 	    case 0:		/* OP_FMSUBS */
@@ -1953,12 +2054,10 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-	  sregs->fsr |= riscv_get_accex ();
-	  clear_accex ();
 	  break;
 	case OP_FNMSUB:
 	  sregs->finst++;
-	  clear_accex ();
+	  riscv_fp_begin (sregs);
 	  switch ((sregs->inst >> 25) & 3)
 	    {
 	    case 0:		/* OP_FNMSUBS */
@@ -1978,12 +2077,10 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-	  sregs->fsr |= riscv_get_accex ();
-	  clear_accex ();
 	  break;
 	case OP_FNMADD:
 	  sregs->finst++;
-	  clear_accex ();
+	  riscv_fp_begin (sregs);
 	  switch ((sregs->inst >> 25) & 3)
 	    {
 	    case 0:		/* OP_FNMADDS */
@@ -2003,11 +2100,9 @@ riscv_dispatch_instruction (sregs)
 	    default:
 	      sregs->trap = TRAP_ILLEG;
 	    }
-	  sregs->fsr |= riscv_get_accex ();
-	  clear_accex ();
 	  break;
 #endif
-	case OP_FENCE:
+	TCASE (OP_FENCE):
 	  sregs->icnt = TRAP_C;
 	  break;
 	default:
@@ -2021,6 +2116,10 @@ riscv_dispatch_instruction (sregs)
     {
       sregs->pc = npc;
     }
+#ifdef THREADED_DISPATCH
+  if (sregs->tdleft && td_next (sregs, ipc))
+    goto td_start;
+#endif
   return 0;
 }
 
@@ -2229,6 +2328,7 @@ riscv_set_rega (struct pstate *sregs, char *reg, uint32 rval)
     sregs->pc = rval;
   else if (strcmp (reg, "fsr") == 0)
     {
+      riscv_sync_fflags ();
       sregs->fsr = rval;
       riscv_set_fsr (rval);
     }
@@ -2345,6 +2445,7 @@ riscv_display_fpu (struct pstate *sregs)
   int i;
   float t;
 
+  riscv_sync_fflags ();
   printf ("\n fsr: %08X\n\n", sregs->fsr);
   printf
     ("                 hex                   single             double\n");
@@ -3364,6 +3465,996 @@ riscv_print_insn (uint32 addr)
   printf (" %s", tmp);
 }
 
+/* Extract register indices and immediates for riscv_dispatch_instruction.
+   Compressed instructions get the immediate of their expanded form. */
+
+static void
+riscv_predecode (struct pdinst *pd)
+{
+  uint32 inst = pd->inst;
+
+#ifdef C_EXTENSION
+  if ((inst & 3) != 3)
+    {
+      pd->op = inst & 3;
+      pd->fn = (inst >> 13) & 7;
+      pd->rd = pd->rs1 = (inst >> 7) & 0x1f;
+      pd->rs2 = (inst >> 2) & 0x1f;
+      pd->len = 2;
+      switch (pd->op)
+	{
+	case 0:
+	  if (pd->fn == CADDI4SPN)
+	    pd->imm = EXTRACT_RVC_ADDI4SPN_IMM (inst);
+	  else if ((pd->fn == CFLD) || (pd->fn == CFSD))
+	    pd->imm = EXTRACT_RVC_LD_IMM (inst);
+	  else
+	    pd->imm = EXTRACT_RVC_LW_IMM (inst);
+	  if ((pd->fn >= CFLD) && (pd->fn <= CFLW))
+	    pd->flags |= PD_LOAD;
+	  else if (pd->fn >= CFSD)
+	    pd->flags |= PD_STORE;
+	  break;
+	case 1:
+	  switch (pd->fn)
+	    {
+	    case CJAL:
+	    case CJNL:
+	      pd->imm = EXTRACT_RVC_J_IMM (inst);
+	      pd->flags |= PD_BLKEND | PD_BRANCH;
+	      break;
+	    case CADDI16SP:
+	      if (pd->rs1 == 2)
+		pd->imm = EXTRACT_RVC_ADDI16SP_IMM (inst);
+	      else
+		pd->imm = EXTRACT_RVC_LUI_IMM (inst);
+	      break;
+	    case CBEQZ:
+	    case CBNEZ:
+	      pd->imm = EXTRACT_RVC_B_IMM (inst);
+	      pd->flags |= PD_BLKEND | PD_BRANCH;
+	      break;
+	    default:
+	      pd->imm = EXTRACT_RVC_IMM (inst);
+	    }
+	  break;
+	default:
+	  switch (pd->fn)
+	    {
+	    case 0:
+	      pd->imm = EXTRACT_RVC_IMM (inst);
+	      break;
+	    case 1:
+	      pd->imm = EXTRACT_RVC_LDSP_IMM (inst);
+	      pd->flags |= PD_LOAD;
+	      break;
+	    case 2:
+	    case 3:
+	      pd->imm = EXTRACT_RVC_LWSP_IMM (inst);
+	      pd->flags |= PD_LOAD;
+	      break;
+	    case 5:
+	      pd->imm = EXTRACT_RVC_SDSP_IMM (inst);
+	      pd->flags |= PD_STORE;
+	      break;
+	    case 6:
+	    case 7:
+	      pd->imm = EXTRACT_RVC_SWSP_IMM (inst);
+	      pd->flags |= PD_STORE;
+	      break;
+	    default:
+	      pd->imm = 0;
+	      if ((pd->fn == 4) && (pd->rs2 == 0))	/* jr, jalr, ebreak */
+		pd->flags |= PD_BLKEND | ((pd->rs1 != 0) ? PD_BRANCH : 0);
+	    }
+	}
+      return;
+    }
+#endif
+
+  pd->op = (inst >> 2) & 0x1f;
+  pd->fn = (inst >> 12) & 0x7;
+  pd->rd = (inst >> 7) & 0x1f;
+  pd->rs1 = (inst >> 15) & 0x1f;
+  pd->rs2 = (inst >> 20) & 0x1f;
+  pd->len = 4;
+  switch (pd->op)
+    {
+    case OP_LUI:
+    case OP_AUIPC:
+      pd->imm = inst & 0xfffff000;
+      break;
+    case OP_BRANCH:
+      pd->imm = EXTRACT_SBTYPE_IMM (inst);
+      pd->flags |= PD_BLKEND | PD_BRANCH;
+      break;
+    case OP_JAL:
+      pd->imm = EXTRACT_UJTYPE_IMM (inst);
+      pd->flags |= PD_BLKEND | PD_BRANCH;
+      break;
+    case OP_JALR:
+      pd->imm = EXTRACT_ITYPE_IMM (inst);
+      pd->flags |= PD_BLKEND | PD_BRANCH;
+      break;
+    case OP_SYS:
+      pd->imm = EXTRACT_ITYPE_IMM (inst);
+      pd->flags |= PD_BLKEND;
+      break;
+    case OP_STORE:
+    case OP_FSW:
+      pd->imm = EXTRACT_STYPE_IMM (inst);
+      pd->flags |= PD_STORE;
+      break;
+    case OP_LOAD:
+    case OP_FLOAD:
+      pd->imm = EXTRACT_ITYPE_IMM (inst);
+      pd->flags |= PD_LOAD;
+      break;
+    case OP_AMO:
+      pd->imm = EXTRACT_ITYPE_IMM (inst);
+      pd->flags |= PD_LOAD | PD_STORE;
+      break;
+    default:
+      pd->imm = EXTRACT_ITYPE_IMM (inst);
+    }
+}
+
+/* Threaded-code handlers for translated blocks (see jit_run).  Each
+   performs one instruction exactly as riscv_dispatch_instruction does
+   and returns what it adds to the static cost of the block, or
+   JIT_LEAVE where that would trap or take the slow path. */
+
+#define JIT_BFWD	1	/* branch offset >= 0, taken costs T_BMISS */
+#define JIT_LEAVE	(JIT_EXIT | (op->idx << 22))
+
+static uint32
+jit_li (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = op->imm;
+  return 0;
+}
+
+static uint32
+jit_addi (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = (int32) sregs->r[op->rs1] + op->imm;
+  return 0;
+}
+
+static uint32
+jit_xori (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] ^ op->imm;
+  return 0;
+}
+
+static uint32
+jit_ori (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] | op->imm;
+  return 0;
+}
+
+static uint32
+jit_andi (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] & op->imm;
+  return 0;
+}
+
+static uint32
+jit_slti (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = (int32) sregs->r[op->rs1] < op->imm;
+  return 0;
+}
+
+static uint32
+jit_sltiu (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] < (uint32) op->imm;
+  return 0;
+}
+
+static uint32
+jit_slli (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] << op->imm;
+  return 0;
+}
+
+static uint32
+jit_srli (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] >> op->imm;
+  return 0;
+}
+
+static uint32
+jit_srai (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = (int32) sregs->r[op->rs1] >> op->imm;
+  return 0;
+}
+
+static uint32
+jit_add (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] + sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_sub (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] - sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_xor (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] ^ sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_or (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] | sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_and (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] & sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_sll (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] << (sregs->r[op->rs2] & 0x1f);
+  return 0;
+}
+
+static uint32
+jit_srl (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] >> (sregs->r[op->rs2] & 0x1f);
+  return 0;
+}
+
+static uint32
+jit_sra (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] =
+    (int32) sregs->r[op->rs1] >> (sregs->r[op->rs2] & 0x1f);
+  return 0;
+}
+
+static uint32
+jit_slt (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = (int32) sregs->r[op->rs1] < (int32) sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_sltu (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] < sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_mul (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[op->rd] = sregs->r[op->rs1] * sregs->r[op->rs2];
+  return 0;
+}
+
+static uint32
+jit_mulh (struct pstate *sregs, const struct jitop *op)
+{
+  int64 sop64a;
+
+  sop64a = (int64) sregs->r[op->rs1] *(int64) sregs->r[op->rs2];
+  sregs->r[op->rd] = (sop64a >> 32) & 0xffffffff;
+  return 0;
+}
+
+static uint32
+jit_mulhsu (struct pstate *sregs, const struct jitop *op)
+{
+  int64 sop64a;
+
+  sop64a = (int64) sregs->r[op->rs1] *(uint64) sregs->r[op->rs2];
+  sregs->r[op->rd] = (sop64a >> 32) & 0xffffffff;
+  return 0;
+}
+
+static uint32
+jit_mulhu (struct pstate *sregs, const struct jitop *op)
+{
+  uint64 op64a;
+
+  op64a = (uint64) sregs->r[op->rs1] *(uint64) sregs->r[op->rs2];
+  sregs->r[op->rd] = (op64a >> 32) & 0xffffffff;
+  return 0;
+}
+
+/* Branches end their block, so pc already holds the fall-through
+   address and only needs updating when taken. */
+
+static inline uint32
+jit_branch (struct pstate *sregs, const struct jitop *op, int taken)
+{
+  if (taken)
+    {
+      sregs->pc = op->imm;
+      return (op->rd & JIT_BFWD) ? JIT_CYC (T_BMISS) : 0;
+    }
+  return (op->rd & JIT_BFWD) ? 0 : JIT_CYC (T_BMISS);
+}
+
+static uint32
+jit_beq (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_branch (sregs, op, sregs->r[op->rs1] == sregs->r[op->rs2]);
+}
+
+static uint32
+jit_bne (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_branch (sregs, op, sregs->r[op->rs1] != sregs->r[op->rs2]);
+}
+
+static uint32
+jit_blt (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_branch (sregs, op,
+		     (int32) sregs->r[op->rs1] < (int32) sregs->r[op->rs2]);
+}
+
+static uint32
+jit_bge (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_branch (sregs, op,
+		     (int32) sregs->r[op->rs1] >= (int32) sregs->r[op->rs2]);
+}
+
+static uint32
+jit_bltu (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_branch (sregs, op, sregs->r[op->rs1] < sregs->r[op->rs2]);
+}
+
+static uint32
+jit_bgeu (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_branch (sregs, op, sregs->r[op->rs1] >= sregs->r[op->rs2]);
+}
+
+static uint32
+jit_jal (struct pstate *sregs, const struct jitop *op)
+{
+  if (op->rd)
+    sregs->r[op->rd] = op->addr;
+  sregs->pc = op->imm;
+  return 0;
+}
+
+/* Loads and stores go through the TLB only, and leave misaligned
+   addresses, misses and pages with predecoded code to the interpreter.
+   They return the waitstates of the access. */
+
+#define JIT_LOAD(name, align, expr) \
+static uint32 \
+jit_##name (struct pstate *sregs, const struct jitop *op) \
+{ \
+  uint32 address = sregs->r[op->rs1] + op->imm, data; \
+  struct tlbent *e; \
+ \
+  if ((address & (align)) || !(e = jit_tlb_read (sregs, address & ~3))) \
+    return JIT_LEAVE; \
+  memcpy (&data, &e->mem[address & (TLB_PAGESIZE - 4)], 4); \
+  if (op->rd) \
+    sregs->r[op->rd] = (expr); \
+  return e->rws; \
+}
+
+JIT_LOAD (lw, 3, data)
+JIT_LOAD (lb, 0, (int32) (data << (24 - (address & 3) * 8)) >> 24)
+JIT_LOAD (lbu, 0, (data >> ((address & 3) * 8)) & 0x0ff)
+JIT_LOAD (lh, 1, (int32) (data << (16 - (address & 2) * 8)) >> 16)
+JIT_LOAD (lhu, 1, (data >> ((address & 2) * 8)) & 0x0ffff)
+
+#define JIT_STORE(name, sz, expr) \
+static uint32 \
+jit_##name (struct pstate *sregs, const struct jitop *op) \
+{ \
+  uint32 address = sregs->r[op->rs1] + op->imm; \
+  uint32 off = address & (TLB_PAGESIZE - 1); \
+  struct tlbent *e = jit_tlb_write (sregs, address, sz); \
+ \
+  if (e == NULL) \
+    return JIT_LEAVE; \
+  expr; \
+  return e->wws[sz]; \
+}
+
+JIT_STORE (sw, 2, memcpy (&e->mem[off], &sregs->r[op->rs2], 4))
+JIT_STORE (sb, 0, e->mem[off ^ arch->bswap] = sregs->r[op->rs2])
+JIT_STORE (sh, 1, *((uint16 *) & e->mem[off ^ (arch->bswap & 2)]) =
+	   sregs->r[op->rs2])
+
+/* Set up a conditional branch to pc-relative offset imm */
+
+static void
+jit_setbranch (struct jitop *op, uint32 addr, int32 imm, uint32 * extra)
+{
+  op->imm = (addr + imm) & ~1;
+  op->rd = (imm >= 0) ? JIT_BFWD : 0;
+  *extra += T_BMISS;
+}
+
+/* Map one predecoded instruction at addr to a handler.  Integer ALU
+   operations, multiplies, direct jumps, conditional branches and
+   integer loads and stores are translated; loads and stores leave the
+   block where they would trap or take the slow path, and anything
+   else that can trap, touches CSRs or has a data-dependent cost ends
+   the block.  Returns the static cycle count of the instruction, or 0
+   if it cannot be translated. */
+
+static uint32
+riscv_translate (struct pdinst *pd, uint32 addr, struct jitop *op,
+		 uint32 * extra)
+{
+  uint32 inst = pd->inst, icnt = 1;
+  int side = 0;			/* has effects beyond writing rd */
+
+  op->fn = NULL;
+  op->imm = pd->imm;
+  op->addr = addr + pd->len;
+  op->rd = pd->rd;
+  op->rs1 = pd->rs1;
+  op->rs2 = pd->rs2;
+
+#ifdef C_EXTENSION
+  if (pd->len == 2)
+    {
+      unsigned char rs1p = (pd->rs1 & 7) | 8, rs2p = (pd->rs2 & 7) | 8;
+
+      switch (pd->op)
+	{
+	case 0:
+	  switch (pd->fn)
+	    {
+	    case CADDI4SPN:
+	      if ((inst & 0x0ffff) == 0)
+		return 0;
+	      op->fn = jit_addi;
+	      op->rd = rs2p;
+	      op->rs1 = 2;
+	      break;
+	    case CLW:
+	      op->fn = jit_lw;
+	      op->rd = rs2p;
+	      op->rs1 = rs1p;
+	      side = 1;
+	      break;
+	    case CSW:
+	      op->fn = jit_sw;
+	      op->rs1 = rs1p;
+	      op->rs2 = rs2p;
+	      side = 1;
+	      break;
+	    default:
+	      return 0;
+	    }
+	  break;
+	case 1:
+	  switch (pd->fn)
+	    {
+	    case CADDI:
+	      op->fn = jit_addi;
+	      break;
+	    case CLI:
+	      op->fn = jit_li;
+	      break;
+	    case CJAL:
+	    case CJNL:
+	      op->imm = (addr + pd->imm) & ~1;
+	      if (!op->imm)
+		return 0;
+	      op->rd = (pd->fn == CJAL) ? 1 : 0;
+	      op->fn = jit_jal;
+	      break;
+	    case CADDI16SP:
+	      op->fn = (pd->rs1 == 2) ? jit_addi : jit_li;
+	      break;
+	    case CARITH:
+	      op->rd = op->rs1 = rs1p;
+	      op->rs2 = rs2p;
+	      switch ((inst >> 10) & 7)
+		{
+		case 0:
+		case 1:
+		  if ((uint32) pd->imm >= 32)
+		    return 0;
+		  op->fn = ((inst >> 10) & 1) ? jit_srai : jit_srli;
+		  break;
+		case 2:
+		case 6:
+		  op->fn = jit_andi;
+		  break;
+		case 3:
+		  switch ((inst >> 5) & 3)
+		    {
+		    case 0:
+		      op->fn = jit_sub;
+		      break;
+		    case 1:
+		      op->fn = jit_xor;
+		      break;
+		    case 2:
+		      op->fn = jit_or;
+		      break;
+		    case 3:
+		      op->fn = jit_and;
+		      break;
+		    }
+		  break;
+		default:
+		  return 0;
+		}
+	      break;
+	    case CBEQZ:
+	    case CBNEZ:
+	      op->rs1 = rs1p;
+	      op->rs2 = 0;
+	      jit_setbranch (op, addr, pd->imm, extra);
+	      op->fn = (pd->fn == CBEQZ) ? jit_beq : jit_bne;
+	      break;
+	    default:
+	      return 0;
+	    }
+	  break;
+	case 2:
+	  if ((pd->fn == 0) && ((uint32) pd->imm < 32))
+	    op->fn = jit_slli;
+	  else if ((pd->fn == 2) || (pd->fn == 6))
+	    {			/* lwsp, swsp */
+	      op->fn = (pd->fn == 2) ? jit_lw : jit_sw;
+	      op->rs1 = 2;
+	      side = 1;
+	    }
+	  else if ((pd->fn == 4) && ((inst >> 12) & 1) && pd->rs1 && pd->rs2)
+	    op->fn = jit_add;
+	  else if ((pd->fn == 4) && !((inst >> 12) & 1) && pd->rs2)
+	    {			/* mv */
+	      op->fn = jit_addi;
+	      op->rs1 = pd->rs2;
+	      op->imm = 0;
+	    }
+	  else
+	    return 0;
+	  break;
+	default:
+	  return 0;
+	}
+    }
+  else
+#endif
+    switch (pd->op)
+      {
+      case OP_LUI:
+	op->fn = jit_li;
+	break;
+      case OP_AUIPC:
+	op->fn = jit_li;
+	op->imm = addr + pd->imm;
+	break;
+      case OP_IMM:
+	switch (pd->fn)
+	  {
+	  case ADD:
+	    op->fn = jit_addi;
+	    break;
+	  case SLT:
+	    op->fn = jit_slti;
+	    break;
+	  case SLTU:
+	    op->fn = jit_sltiu;
+	    break;
+	  case IXOR:
+	    op->fn = jit_xori;
+	    break;
+	  case IOR:
+	    op->fn = jit_ori;
+	    break;
+	  case IAND:
+	    op->fn = jit_andi;
+	    break;
+	  case SLL:
+	    op->fn = jit_slli;
+	    op->imm = pd->rs2;
+	    break;
+	  case SRL:
+	    op->fn = ((inst >> 30) & 1) ? jit_srai : jit_srli;
+	    op->imm = pd->rs2;
+	    break;
+	  }
+	break;
+      case OP_REG:
+	switch ((inst >> 25) & 3)
+	  {
+	  case 0:
+	    switch (pd->fn)
+	      {
+	      case ADD:
+		op->fn = ((inst >> 30) & 1) ? jit_sub : jit_add;
+		break;
+	      case SLL:
+		op->fn = jit_sll;
+		break;
+	      case SLT:
+		op->fn = jit_slt;
+		break;
+	      case SLTU:
+		op->fn = jit_sltu;
+		break;
+	      case IXOR:
+		op->fn = jit_xor;
+		break;
+	      case SRL:
+		op->fn = ((inst >> 30) & 1) ? jit_sra : jit_srl;
+		break;
+	      case IOR:
+		op->fn = jit_or;
+		break;
+	      case IAND:
+		op->fn = jit_and;
+		break;
+	      }
+	    break;
+	  case 1:
+	    icnt = T_MUL;
+	    switch (pd->fn)
+	      {
+	      case 0:
+		op->fn = jit_mul;
+		break;
+	      case 1:
+		op->fn = jit_mulh;
+		break;
+	      case 2:
+		op->fn = jit_mulhsu;
+		break;
+	      case 3:
+		op->fn = jit_mulhu;
+		break;
+	      default:
+		return 0;
+	      }
+	    break;
+	  default:
+	    return 0;
+	  }
+	break;
+      case OP_BRANCH:
+	switch (pd->fn)
+	  {
+	  case B_BE:
+	    op->fn = jit_beq;
+	    break;
+	  case B_BNE:
+	    op->fn = jit_bne;
+	    break;
+	  case B_BLT:
+	    op->fn = jit_blt;
+	    break;
+	  case B_BGE:
+	    op->fn = jit_bge;
+	    break;
+	  case B_BLTU:
+	    op->fn = jit_bltu;
+	    break;
+	  case B_BGEU:
+	    op->fn = jit_bgeu;
+	    break;
+	  default:
+	    return 0;
+	  }
+	jit_setbranch (op, addr, pd->imm, extra);
+	break;
+      case OP_JAL:
+	op->imm = (addr + pd->imm) & ~1;
+	if (!op->imm)
+	  return 0;
+	op->fn = jit_jal;
+	break;
+      case OP_LOAD:
+	if (inst == 0)
+	  return 0;
+	switch (pd->fn)
+	  {
+	  case LW:
+	    op->fn = jit_lw;
+	    break;
+	  case LB:
+	    op->fn = jit_lb;
+	    break;
+	  case LBU:
+	    op->fn = jit_lbu;
+	    break;
+	  case LH:
+	    op->fn = jit_lh;
+	    break;
+	  case LHU:
+	    op->fn = jit_lhu;
+	    break;
+	  default:
+	    return 0;
+	  }
+	side = 1;
+	break;
+      case OP_STORE:
+	switch (pd->fn)
+	  {
+	  case SW:
+	    op->fn = jit_sw;
+	    break;
+	  case SB:
+	    op->fn = jit_sb;
+	    break;
+	  case SH:
+	    op->fn = jit_sh;
+	    break;
+	  default:
+	    return 0;
+	  }
+	side = 1;
+	break;
+      default:
+	return 0;
+      }
+
+  /* loads and stores add their waitstates, writes to x0 have no
+     effect */
+  if (side)
+    *extra += JIT_MAXWS;
+  else if (!(pd->flags & PD_BLKEND) && (op->rd == 0))
+    op->fn = NULL;
+  return icnt;
+}
+
+#ifdef JIT_X86
+#include "x86.h"
+
+/* Host code for translated blocks, see x86.h.  Each operation reads
+   its registers from sregs->r and writes rd back; x0 reads as 0 and
+   writes to it are dropped. */
+
+#define RX_OFF(field)	((int32) offsetof (struct pstate, field))
+#define RX_REG(n)	(RX_OFF (r) + 4 * (n))
+
+/* Host register h = guest register n */
+
+static void
+rx_get (struct x86 *x, int h, uint32 n)
+{
+  if (n == 0)
+    x86_alu (x, XOP_XOR, h, h);
+  else
+    x86_ld (x, 0, h, XBX, RX_REG (n));
+}
+
+/* Guest register n = host register h */
+
+static void
+rx_put (struct x86 *x, int h, uint32 n)
+{
+  if (n != 0)
+    x86_st (x, 0, h, XBX, RX_REG (n));
+}
+
+/* Operations with host code: ALU operations with their x86 operation,
+   shifts with theirs and set-less-than and branches with the x86
+   condition, with an immediate or a register operand */
+
+enum
+{ RX_ALU, RX_SHIFT, RX_SET, RX_BRANCH };
+
+static const struct
+{
+  uint32 (*fn) (struct pstate *, const struct jitop *);
+  int kind, xop, imm;
+} rx_ops[] = {
+  {jit_addi, RX_ALU, XOP_ADD, 1},
+  {jit_xori, RX_ALU, XOP_XOR, 1},
+  {jit_ori, RX_ALU, XOP_OR, 1},
+  {jit_andi, RX_ALU, XOP_AND, 1},
+  {jit_add, RX_ALU, XOP_ADD, 0},
+  {jit_sub, RX_ALU, XOP_SUB, 0},
+  {jit_xor, RX_ALU, XOP_XOR, 0},
+  {jit_or, RX_ALU, XOP_OR, 0},
+  {jit_and, RX_ALU, XOP_AND, 0},
+  {jit_slli, RX_SHIFT, XSH_SHL, 1},
+  {jit_srli, RX_SHIFT, XSH_SHR, 1},
+  {jit_srai, RX_SHIFT, XSH_SAR, 1},
+  {jit_sll, RX_SHIFT, XSH_SHL, 0},
+  {jit_srl, RX_SHIFT, XSH_SHR, 0},
+  {jit_sra, RX_SHIFT, XSH_SAR, 0},
+  {jit_slti, RX_SET, XCC_L, 1},
+  {jit_sltiu, RX_SET, XCC_B, 1},
+  {jit_slt, RX_SET, XCC_L, 0},
+  {jit_sltu, RX_SET, XCC_B, 0},
+  {jit_beq, RX_BRANCH, XCC_E, 0},
+  {jit_bne, RX_BRANCH, XCC_NE, 0},
+  {jit_blt, RX_BRANCH, XCC_L, 0},
+  {jit_bge, RX_BRANCH, XCC_GE, 0},
+  {jit_bltu, RX_BRANCH, XCC_B, 0},
+  {jit_bgeu, RX_BRANCH, XCC_AE, 0},
+};
+
+/* Branches end the block: when taken they set pc, and either way add
+   T_BMISS where jit_branch () does */
+
+static void
+rx_branch (struct x86 *x, const struct jitop *op, int cc)
+{
+  uint32 taken;
+
+  x86_alu (x, XOP_CMP, XAX, XCX);
+  taken = x86_jump (x, cc);
+  if (!(op->rd & JIT_BFWD))
+    x86_alui (x, 0, XOP_ADD, X14, JIT_CYC (T_BMISS));
+  x86_ret (x, XCC_ALWAYS);
+  x86_patch (x, taken, x86_here (x));
+  x86_sti (x, XBX, RX_OFF (pc), op->imm);
+  if (op->rd & JIT_BFWD)
+    x86_alui (x, 0, XOP_ADD, X14, JIT_CYC (T_BMISS));
+}
+
+static void
+rx_mem (struct x86 *x, const struct jitop *op)
+{
+  uint32 bswap = arch->bswap;
+
+  rx_get (x, XAX, op->rs1);
+  if (op->imm)
+    x86_alui (x, 0, XOP_ADD, XAX, op->imm);
+  if (op->fn == jit_lw)
+    {
+      x86_tlb (x, 0, 2, 3, JIT_MAXWS, 1, op->idx);
+      x86_mem (x, 0, 0x8b, XCX, XDX, XAX, 0);
+    }
+  else if ((op->fn == jit_lb) || (op->fn == jit_lbu))
+    {
+      x86_tlb (x, 0, 0, 0, JIT_MAXWS, 1, op->idx);
+      if (bswap)
+	x86_alui (x, 0, XOP_XOR, XAX, bswap);
+      x86_mem (x, 0, (op->fn == jit_lbu) ? 0x0fb6 : 0x0fbe, XCX, XDX, XAX,
+	       0);
+    }
+  else if ((op->fn == jit_lh) || (op->fn == jit_lhu))
+    {
+      x86_tlb (x, 0, 1, 1, JIT_MAXWS, 1, op->idx);
+      if (bswap & 2)
+	x86_alui (x, 0, XOP_XOR, XAX, bswap & 2);
+      x86_mem (x, 0, (op->fn == jit_lhu) ? 0x0fb7 : 0x0fbf, XCX, XDX, XAX,
+	       0);
+    }
+  else if (op->fn == jit_sw)
+    {
+      x86_tlb (x, 1, 2, 3, JIT_MAXWS, 1, op->idx);
+      rx_get (x, XCX, op->rs2);
+      x86_mem (x, 0, 0x89, XCX, XDX, XAX, 0);
+      return;
+    }
+  else if (op->fn == jit_sb)
+    {
+      x86_tlb (x, 1, 0, 0, JIT_MAXWS, 1, op->idx);
+      if (bswap)
+	x86_alui (x, 0, XOP_XOR, XAX, bswap);
+      rx_get (x, XCX, op->rs2);
+      x86_mem (x, 0, 0x88, XCX, XDX, XAX, 0);	/* mov byte, cl */
+      return;
+    }
+  else
+    {
+      x86_tlb (x, 1, 1, 1, JIT_MAXWS, 1, op->idx);
+      if (bswap & 2)
+	x86_alui (x, 0, XOP_XOR, XAX, bswap & 2);
+      rx_get (x, XCX, op->rs2);
+      x86_mem (x, 2, 0x89, XCX, XDX, XAX, 0);
+      return;
+    }
+  rx_put (x, XCX, op->rd);
+}
+
+static void
+rx_op (struct x86 *x, const struct jitop *op)
+{
+  uint32 i;
+
+  for (i = 0; i < sizeof (rx_ops) / sizeof (rx_ops[0]); i++)
+    if (op->fn == rx_ops[i].fn)
+      {
+	rx_get (x, XAX, op->rs1);
+	if (rx_ops[i].imm)
+	  {
+	    if (rx_ops[i].kind == RX_SHIFT)
+	      x86_shifti (x, rx_ops[i].xop, XAX, op->imm);
+	    else
+	      x86_alui (x, 0, (rx_ops[i].kind == RX_ALU) ? rx_ops[i].xop :
+			XOP_CMP, XAX, op->imm);
+	  }
+	else
+	  {
+	    rx_get (x, XCX, op->rs2);
+	    if (rx_ops[i].kind == RX_SHIFT)
+	      x86_shift (x, rx_ops[i].xop, XAX);
+	    else if (rx_ops[i].kind == RX_ALU)
+	      x86_alu (x, rx_ops[i].xop, XAX, XCX);
+	    else if (rx_ops[i].kind == RX_SET)
+	      x86_alu (x, XOP_CMP, XAX, XCX);
+	  }
+	if (rx_ops[i].kind == RX_BRANCH)
+	  rx_branch (x, op, rx_ops[i].xop);
+	else if (rx_ops[i].kind == RX_SET)
+	  {
+	    x86_movi (x, XDX, 0);	/* leaves the flags */
+	    x86_setcc (x, rx_ops[i].xop, XDX);
+	    rx_put (x, XDX, op->rd);
+	  }
+	else
+	  rx_put (x, XAX, op->rd);
+	return;
+      }
+
+  if (op->fn == jit_li)
+    {
+      x86_movi (x, XAX, op->imm);
+      rx_put (x, XAX, op->rd);
+    }
+  else if (op->fn == jit_mul)
+    {
+      rx_get (x, XAX, op->rs1);
+      rx_get (x, XCX, op->rs2);
+      x86_reg (x, 0, 0x0faf, XAX, XCX);	/* imul eax, ecx */
+      rx_put (x, XAX, op->rd);
+    }
+  else if (op->fn == jit_jal)
+    {
+      if (op->rd)
+	x86_sti (x, XBX, RX_REG (op->rd), op->addr);
+      x86_sti (x, XBX, RX_OFF (pc), op->imm);
+    }
+  else if ((op->fn == jit_lw) || (op->fn == jit_lb) || (op->fn == jit_lbu)
+	   || (op->fn == jit_lh) || (op->fn == jit_lhu) || (op->fn == jit_sw)
+	   || (op->fn == jit_sb) || (op->fn == jit_sh))
+    rx_mem (x, op);
+  else
+    x86_handler (x, op);
+}
+
+static uint32
+riscv_emit (struct jitblk *blk, unsigned char *buf, uint32 len)
+{
+  struct x86 x;
+  uint32 i;
+
+  x86_prologue (&x, buf, len);
+  for (i = 0; i < blk->nops; i++)
+    rx_op (&x, &blk->op[i]);
+  return x86_epilogue (&x);
+}
+#endif
+
 const struct cpu_arch riscv = {
 #ifdef HOST_LITTLE_ENDIAN
   0,
@@ -3379,5 +4470,12 @@ const struct cpu_arch riscv = {
   riscv_display_registers,
   riscv_display_ctrl,
   riscv_display_special,
-  riscv_display_fpu
+  riscv_display_fpu,
+  riscv_predecode,
+  riscv_translate,
+#ifdef JIT_X86
+  riscv_emit
+#else
+  NULL
+#endif
 };
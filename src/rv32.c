@@ -37,7 +37,6 @@
 #include <unistd.h>
 #include "riscv.h"
 #include "grlib.h"
-#include "rv32dtb.h"
 #include "uart.h"
 
 #define PLIC_START	0x0C000000
@@ -57,6 +56,336 @@
 /* Forward declarations. */
 static char *get_mem_ptr (uint32 addr, uint32 size);
 
+/* Flattened device tree passed to the guest in a1.  It has a cpu node,
+   with its interrupt controller, and PLIC and CLINT entries for each
+   hart; rv32.dts is the source of the tree built for four harts. */
+
+#define DTB_ADDR	(ROM_END - 0x10000)
+#define DTB_SIZE	0x10000
+
+#define FDT_BEGIN_NODE	1
+#define FDT_END_NODE	2
+#define FDT_PROP	3
+#define FDT_END		9
+
+static unsigned char dtb_struct[DTB_SIZE], dtb_strings[2048];
+static uint32 dtb_slen, dtb_tlen;
+static int dtb_ncpu;		/* harts in the tree in ROM */
+
+static void
+dtb_put (unsigned char *buf, uint32 * len, uint32 val)
+{
+  buf[(*len)++] = val >> 24;
+  buf[(*len)++] = val >> 16;
+  buf[(*len)++] = val >> 8;
+  buf[(*len)++] = val;
+}
+
+/* Offset of name in the strings block, shared with names it ends */
+
+static uint32
+dtb_string (const char *name)
+{
+  uint32 i, n = strlen (name) + 1;
+
+  for (i = 0; i + n <= dtb_slen; i++)
+    if (memcmp (&dtb_strings[i], name, n) == 0)
+      return i;
+  memcpy (&dtb_strings[dtb_slen], name, n);
+  dtb_slen += n;
+  return dtb_slen - n;
+}
+
+static void
+dtb_bytes (const void *data, uint32 len)
+{
+  memcpy (&dtb_struct[dtb_tlen], data, len);
+  dtb_tlen += len;
+  while (dtb_tlen & 3)
+    dtb_struct[dtb_tlen++] = 0;
+}
+
+static void
+dtb_node (const char *fmt, int n)
+{
+  char name[32];
+
+  dtb_put (dtb_struct, &dtb_tlen, FDT_BEGIN_NODE);
+  snprintf (name, sizeof (name), fmt, n);
+  dtb_bytes (name, strlen (name) + 1);
+}
+
+static void
+dtb_end (void)
+{
+  dtb_put (dtb_struct, &dtb_tlen, FDT_END_NODE);
+}
+
+static void
+dtb_prop (const char *name, const void *data, uint32 len)
+{
+  dtb_put (dtb_struct, &dtb_tlen, FDT_PROP);
+  dtb_put (dtb_struct, &dtb_tlen, len);
+  dtb_put (dtb_struct, &dtb_tlen, dtb_string (name));
+  dtb_bytes (data, len);
+}
+
+static void
+dtb_str (const char *name, const char *val)
+{
+  dtb_prop (name, val, strlen (val) + 1);
+}
+
+static void
+dtb_cells (const char *name, const uint32 * cell, int n)
+{
+  unsigned char buf[4 * 128];
+  uint32 len = 0;
+  int i;
+
+  for (i = 0; i < n; i++)
+    dtb_put (buf, &len, cell[i]);
+  dtb_prop (name, buf, len);
+}
+
+static void
+dtb_cell (const char *name, uint32 val)
+{
+  dtb_cells (name, &val, 1);
+}
+
+/* A soc device with a 4 KiB register window and a PLIC interrupt */
+
+static void
+dtb_plic_dev (const char *fmt, uint32 addr, uint32 irq, uint32 plic)
+{
+  const uint32 reg[4] = { 0, addr, 0, 0x1000 };
+
+  dtb_node (fmt, addr);
+  dtb_cell ("interrupts", irq);
+  dtb_cell ("interrupt-parent", plic);
+  dtb_cells ("reg", reg, 4);
+}
+
+static uint32
+dtb_build (int n)
+{
+  static const uint32 mem[4] = { 0, RAM_START, 0, 0x80000000 };
+  static const uint32 flash[8] =
+    { 0, ROM_START, 0, 0x2000000, 0, 0x22000000, 0, 0x2000000 };
+  static const uint32 uart[4] = { 0, NS16550_START, 0, 0x100 };
+  static const uint32 test[4] = { 0, TESTSTART, 0, 0x1000 };
+  static const uint32 clint[4] = { 0, CLINT_START, 0, 0x10000 };
+  static const uint32 pcimask[4] = { 0x1800, 0, 0, 7 };
+  static const uint32 pciranges[14] = {
+    0x1000000, 0, 0, 0, 0x3000000, 0, 0x10000,
+    0x2000000, 0, 0x40000000, 0, 0x40000000, 0, 0x40000000
+  };
+  static const uint32 pcireg[4] = { 0, 0x30000000, 0, 0x10000000 };
+  static const uint32 pcibus[2] = { 0, 0xff };
+  static const char testcompat[] = "sifive,test1\0sifive,test0\0syscon";
+  /* phandles: cpu i is 2 * (n - i) - 1 and its interrupt controller
+     2 * (n - i), then the PLIC and the test device */
+  uint32 plic = 2 * n + 1, syscon = 2 * n + 2;
+  uint32 cells[4 * NCPU], pcimap[96], plicreg[4];
+  unsigned char zero = 0;
+  int i, j;
+
+  dtb_slen = dtb_tlen = 0;
+  dtb_node ("", 0);
+  dtb_cell ("#address-cells", 2);
+  dtb_cell ("#size-cells", 2);
+  dtb_str ("compatible", "riscv-virtio");
+  dtb_str ("model", "riscv-virtio,qemu");
+
+  dtb_node ("chosen", 0);
+  dtb_prop ("bootargs", &zero, 1);
+  dtb_str ("stdout-path", "/soc/uart@10000000");
+  dtb_end ();
+
+  dtb_node ("memory@%x", RAM_START);
+  dtb_str ("device_type", "memory");
+  dtb_cells ("reg", mem, 4);
+  dtb_end ();
+
+  dtb_node ("cpus", 0);
+  dtb_cell ("#address-cells", 1);
+  dtb_cell ("#size-cells", 0);
+  dtb_cell ("timebase-frequency", 50000000);
+  for (i = 0; i < n; i++)
+    {
+      dtb_node ("cpu@%d", i);
+      dtb_cell ("phandle", 2 * (n - i) - 1);
+      dtb_str ("device_type", "cpu");
+      dtb_cell ("reg", i);
+      dtb_str ("status", "okay");
+      dtb_str ("compatible", "riscv");
+      dtb_str ("riscv,isa", "rv32imafdcsu");
+      dtb_str ("mmu-type", "riscv,sv32");
+      dtb_node ("interrupt-controller", 0);
+      dtb_cell ("#interrupt-cells", 1);
+      dtb_prop ("interrupt-controller", NULL, 0);
+      dtb_str ("compatible", "riscv,cpu-intc");
+      dtb_cell ("phandle", 2 * (n - i));
+      dtb_end ();
+      dtb_end ();
+    }
+  dtb_node ("cpu-map", 0);
+  dtb_node ("cluster0", 0);
+  for (i = 0; i < n; i++)
+    {
+      dtb_node ("core%d", i);
+      dtb_cell ("cpu", 2 * (n - i) - 1);
+      dtb_end ();
+    }
+  dtb_end ();
+  dtb_end ();
+  dtb_end ();
+
+  dtb_node ("soc", 0);
+  dtb_cell ("#address-cells", 2);
+  dtb_cell ("#size-cells", 2);
+  dtb_str ("compatible", "simple-bus");
+  dtb_prop ("ranges", NULL, 0);
+
+  dtb_node ("flash@%x", ROM_START);
+  dtb_cell ("bank-width", 4);
+  dtb_cells ("reg", flash, 8);
+  dtb_str ("compatible", "cfi-flash");
+  dtb_end ();
+
+  dtb_plic_dev ("rtc@%x", 0x101000, 11, plic);
+  dtb_str ("compatible", "google,goldfish-rtc");
+  dtb_end ();
+
+  dtb_node ("uart@%x", NS16550_START);
+  dtb_cell ("interrupts", 10);
+  dtb_cell ("interrupt-parent", plic);
+  dtb_cell ("clock-frequency", 3686400);
+  dtb_cell ("reg-shift", 2);
+  dtb_cells ("reg", uart, 4);
+  dtb_str ("compatible", "ns16550a");
+  dtb_end ();
+
+  dtb_node ("poweroff", 0);
+  dtb_cell ("value", 0x5555);
+  dtb_cell ("offset", 0);
+  dtb_cell ("regmap", syscon);
+  dtb_str ("compatible", "syscon-poweroff");
+  dtb_end ();
+
+  dtb_node ("reboot", 0);
+  dtb_cell ("value", 0x7777);
+  dtb_cell ("offset", 0);
+  dtb_cell ("regmap", syscon);
+  dtb_str ("compatible", "syscon-reboot");
+  dtb_end ();
+
+  dtb_node ("test@%x", TESTSTART);
+  dtb_cell ("phandle", syscon);
+  dtb_cells ("reg", test, 4);
+  dtb_prop ("compatible", testcompat, sizeof (testcompat));
+  dtb_end ();
+
+  /* slot i, pin j goes to PLIC interrupt 32 + (i + j) % 4 */
+  dtb_node ("pci@%x", 0x30000000);
+  dtb_cells ("interrupt-map-mask", pcimask, 4);
+  for (i = 0; i < 16; i++)
+    {
+      pcimap[6 * i] = (i / 4) << 11;
+      pcimap[6 * i + 1] = pcimap[6 * i + 2] = 0;
+      pcimap[6 * i + 3] = i % 4 + 1;
+      pcimap[6 * i + 4] = plic;
+      pcimap[6 * i + 5] = 32 + (i / 4 + i % 4) % 4;
+    }
+  dtb_cells ("interrupt-map", pcimap, 96);
+  dtb_cells ("ranges", pciranges, 14);
+  dtb_cells ("reg", pcireg, 4);
+  dtb_prop ("dma-coherent", NULL, 0);
+  dtb_cells ("bus-range", pcibus, 2);
+  dtb_cell ("linux,pci-domain", 0);
+  dtb_str ("device_type", "pci");
+  dtb_str ("compatible", "pci-host-ecam-generic");
+  dtb_cell ("#size-cells", 2);
+  dtb_cell ("#interrupt-cells", 1);
+  dtb_cell ("#address-cells", 3);
+  dtb_end ();
+
+  for (i = 8; i > 0; i--)
+    {
+      dtb_plic_dev ("virtio_mmio@%x", 0x10000000 + 0x1000 * i, i, plic);
+      dtb_str ("compatible", "virtio,mmio");
+      dtb_end ();
+    }
+
+  /* machine and supervisor external interrupt of each hart */
+  dtb_node ("plic@%x", PLIC_START);
+  dtb_cell ("phandle", plic);
+  dtb_cell ("riscv,ndev", 0x35);
+  plicreg[0] = plicreg[2] = 0;
+  plicreg[1] = PLIC_START;
+  plicreg[3] = 0x200000 + 0x2000 * ((n > 8) ? n : 8);
+  dtb_cells ("reg", plicreg, 4);
+  for (i = j = 0; i < n; i++)
+    {
+      cells[j++] = 2 * (n - i);
+      cells[j++] = 11;
+      cells[j++] = 2 * (n - i);
+      cells[j++] = 9;
+    }
+  dtb_cells ("interrupts-extended", cells, j);
+  dtb_prop ("interrupt-controller", NULL, 0);
+  dtb_str ("compatible", "riscv,plic0");
+  dtb_cell ("#interrupt-cells", 1);
+  dtb_cell ("#address-cells", 0);
+  dtb_end ();
+
+  /* machine software and timer interrupt of each hart */
+  dtb_node ("clint@%x", CLINT_START);
+  for (i = j = 0; i < n; i++)
+    {
+      cells[j++] = 2 * (n - i);
+      cells[j++] = 3;
+      cells[j++] = 2 * (n - i);
+      cells[j++] = 7;
+    }
+  dtb_cells ("interrupts-extended", cells, j);
+  dtb_cells ("reg", clint, 4);
+  dtb_str ("compatible", "riscv,clint0");
+  dtb_end ();
+
+  dtb_end ();
+  dtb_end ();
+  dtb_put (dtb_struct, &dtb_tlen, FDT_END);
+  return dtb_tlen;
+}
+
+/* Write the device tree for the current number of harts to ROM */
+
+static void
+dtb_load (void)
+{
+  unsigned char *dtb = (unsigned char *) &romb[DTB_ADDR & ROM_MASK];
+  uint32 len = 0, tlen, total;
+
+  dtb_ncpu = ncpu;
+  tlen = dtb_build (ncpu);
+  total = 0x38 + tlen + dtb_slen;
+  dtb_put (dtb, &len, 0xd00dfeed);	/* magic */
+  dtb_put (dtb, &len, total);
+  dtb_put (dtb, &len, 0x38);	/* structure block */
+  dtb_put (dtb, &len, 0x38 + tlen);	/* strings block */
+  dtb_put (dtb, &len, 0x28);	/* memory reservation map */
+  dtb_put (dtb, &len, 17);	/* version */
+  dtb_put (dtb, &len, 16);	/* last compatible version */
+  dtb_put (dtb, &len, 0);	/* boot cpu */
+  dtb_put (dtb, &len, dtb_slen);
+  dtb_put (dtb, &len, tlen);
+  memset (&dtb[len], 0, 16);	/* empty reservation map */
+  memcpy (&dtb[0x38], dtb_struct, tlen);
+  memcpy (&dtb[0x38 + tlen], dtb_strings, dtb_slen);
+}
+
 /* One-time init. */
 
 static void
@@ -64,6 +393,7 @@ init_sim (void)
 {
   int i;
 
+  mem_alloc (RAM_SIZE, ROM_SIZE);
   for (i = 0; i < ncpu; i++)
     grlib_ahbm_add (&leon3s, 0);
 
@@ -75,7 +405,7 @@ init_sim (void)
   grlib_ahbs_add (&sdctrl, 0, RAM_START, RAM_MASKPP);
 
   grlib_init ();
-  memcpy (&romb[(ROM_END - 0x10000) & ROM_MASK], rv32_dtb, sizeof (rv32_dtb));
+  dtb_load ();
   ebase.ramstart = RAM_START;
 }
 
@@ -161,11 +491,13 @@ memory_write (uint32 addr, uint32 * data, int32 sz, int32 * ws)
   if ((addr >= RAM_START) && (addr < RAM_END))
     {
       waddr = addr & RAM_MASK;
+      PDC_WRITE (addr, 1 << sz);
       grlib_store_bytes (ramb, waddr, data, sz);
       return 0;
     }
   else if ((addr >= ROM_START) && (addr < ROM_END))
     {
+      PDC_WRITE (addr, 1 << sz);
       grlib_store_bytes (romb, addr, data, sz);
       return 0;
     }
@@ -200,6 +532,27 @@ get_mem_ptr (uint32 addr, uint32 size)
   return NULL;
 }
 
+/* RAM and ROM pages for the software TLB */
+
+static int
+map_page (uint32 addr, struct tlbent *e)
+{
+  e->wws[0] = e->wws[1] = e->wws[2] = e->wws[3] = 0;
+  if ((addr >= RAM_START) && (addr < RAM_END))
+    {
+      e->mem = &ramb[addr & RAM_MASK];
+      e->rws = 0;
+      return TLB_R | TLB_W;
+    }
+  else if ((addr >= ROM_START) && (addr < ROM_END))
+    {
+      e->mem = &romb[addr & ROM_MASK];
+      e->rws = 0;
+      return TLB_R;		/* writes stay with memory_write () */
+    }
+  return 0;
+}
+
 static int
 sis_memory_write (uint32 addr, const char *data, uint32 length)
 {
@@ -208,6 +561,7 @@ sis_memory_write (uint32 addr, const char *data, uint32 length)
 
   if ((mem = get_mem_ptr (addr, length)) != NULL)
     {
+      PDC_WRITE (addr, length);
       memcpy (mem, data, length);
       return length;
     }
@@ -242,6 +596,9 @@ boot_init (void)
   int i;
 
   grlib_boot_init ();
+  /* the ncpu command may have changed the number of harts */
+  if (dtb_ncpu != ncpu)
+    dtb_load ();
   for (i = 0; i < ncpu; i++)
     {
       sregs[i].wim = 2;
@@ -250,7 +607,7 @@ boot_init (void)
       sregs[i].r[14] = sregs[i].r[30] - 96 * 4;
       sregs[i].cache_ctrl = 0x81000f;
       sregs[i].r[2] = sregs[i].r[30];	/* sp on RISCV-V */
-      sregs[i].r[11] = ROM_END - 0x10000;	/* dtb on RISCV-V */
+      sregs[i].r[11] = DTB_ADDR;	/* dtb on RISCV-V */
       sregs[i].pwd_mode = 0;
     }
 }
@@ -270,5 +627,7 @@ const struct memsys rv32 = {
   sis_memory_read,
   boot_init,
   get_mem_ptr,
-  grlib_set_irq
+  grlib_set_irq,
+  map_page,
+  grlib_bus_stat
 };
@@ -42,6 +42,28 @@
 /* Command history buffer length - MUST be binary */
 #define HIST_LEN	256
 
+/* Parse a memory size such as 65536, 256K or 128M */
+
+static uint32
+mem_size (const char *s, uint32 max)
+{
+  char *end;
+  uint64 size;
+
+  size = strtoul (s, &end, 0);
+  if ((*end == 'k') || (*end == 'K'))
+    size <<= 10;
+  else if ((*end == 'm') || (*end == 'M'))
+    size <<= 20;
+  if ((size < MIN_MEM_SIZE) || (size > max) || (size & (size - 1)))
+    {
+      printf ("invalid memory size %s, use a power of two from %dK to %dM\n",
+	      s, MIN_MEM_SIZE >> 10, max >> 20);
+      exit (1);
+    }
+  return size;
+}
+
 int
 main (argc, argv)
      int argc;
@@ -109,6 +131,14 @@ main (argc, argv)
 	    ebase.coven = 1;
 	  else if (strcmp (argv[stat], "-nfp") == 0)
 	    nfp = 1;
+	  else if (strcmp (argv[stat], "-fpexact") == 0)
+	    fpexact = 1;
+	  else if (strcmp (argv[stat], "-noidle") == 0)
+	    noidle = 1;
+	  else if (strcmp (argv[stat], "-l1") == 0)
+	    l1cache = 1;
+	  else if (strcmp (argv[stat], "-hugepage") == 0)
+	    hugepage = 1;
 	  else if (strcmp (argv[stat], "-ift") == 0)
 	    ift = 1;
 	  else if (strcmp (argv[stat], "-wrp") == 0)
@@ -159,6 +189,26 @@ main (argc, argv)
 				strcpy (uarts[5].uart_io.device.device_path, argv[++stat]);	
 			}
 		}
+	  else if (strcmp (argv[stat], "-image") == 0)
+	    {
+	      if ((stat + 1) < argc)
+		{
+		  last_load_addr = mem_image (argv[++stat]);
+		  if (last_load_addr == (uint32) -1)
+		    exit (1);
+		  daddr = last_load_addr;
+		}
+	    }
+	  else if (strcmp (argv[stat], "-ram") == 0)
+	    {
+	      if ((stat + 1) < argc)
+		ramsize = mem_size (argv[++stat], MAX_RAM_SIZE);
+	    }
+	  else if (strcmp (argv[stat], "-rom") == 0)
+	    {
+	      if ((stat + 1) < argc)
+		romsize = mem_size (argv[++stat], MAX_ROM_SIZE);
+	    }
 	  else if (strcmp (argv[stat], "-freq") == 0)
 	    {
 	      if ((stat + 1) < argc)
@@ -189,6 +239,23 @@ main (argc, argv)
 	    {
 	      sync_rt = 1;
 	    }
+	  else if (strcmp (argv[stat], "-jit") == 0)
+	    {
+	      jit = 1;
+	    }
+	  else if (strcmp (argv[stat], "-jitthreaded") == 0)
+	    {
+	      jit = 1;
+	      jithost = 0;
+	    }
+	  else if (strcmp (argv[stat], "-mt") == 0)
+	    {
+	      mtsim = 1;
+	    }
+	  else if (strcmp (argv[stat], "-stat") == 0)
+	    {
+	      ebase.stat = 1;
+	    }
 	  else if (strcmp (argv[stat], "-erc32") == 0)
 	    {
 	      cputype = CPU_ERC32;
@@ -238,7 +305,10 @@ main (argc, argv)
 	      if ((stat + 1) < argc)
 		ncpu = VAL (argv[++stat]);
 	      if ((ncpu < 1) || (ncpu > NCPU))
-		ncpu = 1;
+		{
+		  printf ("-m takes 1 to %d cpus\n", NCPU);
+		  ncpu = 1;
+		}
 	    }
 	  else if (strcmp (argv[stat], "-d") == 0)
 	    {
@@ -247,6 +317,11 @@ main (argc, argv)
 	      if (delta <= 0)
 		delta = 25;
 	    }
+	  else if (strcmp (argv[stat], "-dmax") == 0)
+	    {
+	      if ((stat + 1) < argc)
+		delta_max = VAL (argv[++stat]);
+	    }
 	  else
 	    {
 	      printf ("unknown option %s\n", argv[stat]);
@@ -293,6 +368,13 @@ main (argc, argv)
 	}
     }
 
+  if (((cputype == CPU_LEON3) || (cputype == CPU_LEON4))
+      && (ncpu > IRQMP_NCPU))
+    {
+      printf (" IRQMP serves at most %d cpus\n", IRQMP_NCPU);
+      ncpu = IRQMP_NCPU;
+    }
+
   switch (cputype)
     {
     case CPU_ERC32:
@@ -349,11 +431,9 @@ main (argc, argv)
 	freq = 14;
     }
 
-#ifdef ENABLE_L1CACHE
-  if (ncpu > 1)
+  if (l1cache && (ncpu > 1))
     printf (" L1 cache: %dK/%dK, %d bytes/line \n",
 	    (1 << (L1IBITS - 10)), (1 << (L1DBITS - 10)), (1 << L1ILINEBITS));
-#endif
 
   if (nfp)
     printf (" FPU disabled\n");
@@ -379,9 +459,7 @@ main (argc, argv)
       last_load_addr = elf_load (argv[lfile], 1);
       daddr = last_load_addr;
     }
-#ifdef STAT
-  reset_stat (&sregs);
-#endif
+  reset_stat (sregs);
 
   if (copt)
     {
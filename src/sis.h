@@ -15,6 +15,7 @@
 
 #include "config.h"
 #include <stdint.h>
+#include <string.h>
 
 #ifndef WORDS_BIGENDIAN
 #define HOST_LITTLE_ENDIAN
@@ -27,7 +28,7 @@
 #define I_ACC_EXC 1
 #define NWIN 8
 
-/* Maximum events in event queue */
+/* Initial size of event queue, grows on demand */
 #define MAX_EVENT	256
 
 /* Maximum # of floating point queue */
@@ -38,17 +39,39 @@
 #define WPR_MAX	256
 #define WPW_MAX	256
 
-/* Maximum number of cpus */
-#define NCPU 4
-
-/* size of simulated memory */
-#define ROM_MASK  (ROM_SIZE - 1)
-#define ROM_END   (ROM_START + ROM_SIZE)
-#define RAM_MASK  (RAM_SIZE - 1)
-#define RAM_END   (RAM_START + RAM_SIZE)
-#define MAX_ROM_SIZE 0x01000000
-#define MAX_RAM_SIZE 0x04000000
-#define MAX_RAM_MASK (MAX_RAM_SIZE - 1)
+/* Maximum number of cpus; their state is allocated for -m at start-up */
+#define NCPU 32
+
+/* Maximum number of cpus one IRQMP serves */
+#define IRQMP_NCPU 16
+
+/* size of simulated memory, ROM_SIZE and RAM_SIZE are the target
+   defaults passed to mem_alloc () */
+#define ROM_MASK  (ebase.romsize - 1)
+#define ROM_END   (ROM_START + ebase.romsize)
+#define RAM_MASK  (ebase.ramsize - 1)
+#define RAM_END   (RAM_START + ebase.ramsize)
+#define MIN_MEM_SIZE 0x00100000
+#define MAX_ROM_SIZE 0x10000000
+#define MAX_RAM_SIZE 0x40000000
+
+/* Memory image file written by the dump command: this header, then ROM
+   at IMG_ALIGN and RAM right after it, in host byte order */
+#define IMG_MAGIC	"SISIMG1"
+#define IMG_ORDER	0x01020304	/* tells host endianness */
+#define IMG_ALIGN	0x10000		/* multiple of any host page size */
+#define IMG_PAGE	4096		/* zero pages are left as holes */
+
+/* A checkpoint written by the save command is a memory image followed
+   by the processor, event queue and device state.  The state is only
+   meaningful to the same simulator build. */
+#define CKPT_NAMELEN	32	/* registered state and event names */
+#define CKPT_MAX	128	/* registered state blocks */
+#define CKPT_EVMAX	64	/* registered event callbacks */
+
+/* Register a static variable or an event callback under its own name */
+#define CKPT_VAR(v)	ckpt_state (#v, &(v), sizeof (v))
+#define CKPT_EVENT(f)	ckpt_event (#f, (void (*) ()) (f))
 
 /* cache config */
 
@@ -83,6 +106,134 @@ struct histype
   uint64 time;
 };
 
+/* Predecoded instruction, filled in by cpu_arch.predecode */
+
+struct pdinst
+{
+  uint32 inst;			/* raw instruction word */
+  int32 imm;			/* sign-extended immediate or displacement */
+  unsigned char op;		/* major opcode */
+  unsigned char fn;		/* minor opcode */
+  unsigned char rd, rs1, rs2;
+  unsigned char flags;
+  unsigned char len;		/* instruction length, 0 = invalid entry */
+  unsigned char hold;		/* fetch wait states */
+  unsigned char hx;		/* handler index of the threaded dispatcher */
+};
+
+#define PD_IMM		1	/* second operand is immediate */
+#define PD_BLKEND	2	/* control transfer, ends a basic block */
+#define PD_DELAY	4	/* control transfer with a delay slot */
+#define PD_BRANCH	8	/* statistics (-stat): counts in nbranch */
+#define PD_LOAD		16	/* counts in nload */
+#define PD_STORE	32	/* counts in nstore */
+#define PD_DOUBLE	64	/* the load or store counts twice */
+
+/* Translated code (-jit): a block is a run of instructions with a
+   static cycle cost, optionally ending with a direct branch or jump.
+   Each operation returns what it took beyond the static cost, as
+   memory waitstates plus JIT_CYC () cycles; branches also set the pc.
+   A branch with a delay slot keeps the slot's operation just past the
+   end of op[] and runs it itself, or returns JIT_ANNUL to have the
+   slot's cost backed out.  An operation that cannot complete here, a
+   load or store missing the TLB or an instruction that would trap,
+   returns JIT_EXIT with its index before changing any state; the
+   block is then left to the interpreter at that instruction.  On
+   hosts with JIT_X86, arch->emit turns the operations of a block into
+   host code with the same interface (see x86.h). */
+
+struct pstate;
+
+struct jitop
+{
+  uint32 (*fn) (struct pstate * sregs, const struct jitop * op);
+  int32 imm;			/* immediate, or branch target */
+  uint32 addr;			/* address of the next instruction */
+  unsigned char rd, rs1, rs2;
+  unsigned char idx;		/* index in op[] */
+  unsigned char flags;		/* JIT_SLOT */
+  unsigned char ild;		/* register the previous instruction loaded */
+  unsigned char lreg;		/* register this one loads, for the interlock */
+  uint32 pc;			/* address of the instruction */
+  /* the instructions before it in the block, for JIT_EXIT */
+  uint16 ninst, cycles, hold;
+  unsigned char mix[3];
+};
+
+struct jitblk
+{
+  uint32 pc;			/* start address */
+  uint32 ninst;			/* guest instructions */
+  uint32 nops;			/* operations in op[] */
+  uint32 end;			/* pc after the last instruction */
+  uint32 cycles;		/* static cycle cost, fetch waitstates included */
+  uint32 hold;			/* fetch waitstates */
+  uint32 extra;			/* worst case additional cycles */
+  uint32 lcycles, lhold;	/* cost of the last instruction */
+  uint32 lflags;		/* predecode flags of the last instruction */
+  uint32 ild;			/* register the last instruction loads */
+  uint32 mix[3];		/* branches, loads and stores, for -stat */
+  uint32 gen;			/* jit_gen when next[] was filled */
+  struct jitblk *next[2];	/* chained successors */
+  uint32 (*code) (struct pstate * sregs);	/* host code, or NULL */
+  struct jitop op[1];
+};
+
+#define JIT_HOT		16	/* executions before a block is translated */
+#define JIT_MAXINST	64	/* max instructions per block */
+#define JIT_MAXWS	32	/* max waitstates of a translated access */
+#define JIT_ANNUL	0x80000000	/* last instruction was annulled */
+#define JIT_EXIT	0x40000000	/* left at op[JIT_IDX ()] */
+#define JIT_IDX(r)	(((r) >> 22) & 0xff)
+#define JIT_CYC(n)	((n) << 14)	/* cycles beyond the static cost */
+#define JIT_CYCLES(r)	(((r) >> 14) & 0xff)
+#define JIT_WS(r)	((r) & 0x3fff)	/* waitstates */
+#define JIT_SLOT	1	/* jitop flags: in a delay slot */
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(WIN32)
+#define JIT_X86			/* arch->emit gives host code */
+#endif
+
+/* Predecode cache geometry: pages of 4 KiB, one entry per halfword */
+#define PDC_PAGEBITS	12
+#define PDC_PAGESIZE	(1 << PDC_PAGEBITS)
+#define PDC_SLOTS	512
+#define PDC_VALID	1	/* pdc_flags[]: page is in the cache */
+#define PDC_CLEAN	2	/* not written since the baseline */
+
+/* Software TLB: a direct-mapped table per core from guest pages to
+   host memory, for pages that are plain RAM or ROM.  Filled through
+   ms->map_page (); everything else goes through the memsys callbacks. */
+#define TLB_PAGEBITS	12
+#define TLB_PAGESIZE	(1 << TLB_PAGEBITS)
+#define TLB_ENTRIES	256
+#define TLB_NONE	0xffffffff	/* tag that matches no access */
+#define TLB_R		1	/* map_page () permissions */
+#define TLB_W		2
+
+struct tlbent
+{
+  uint32 rtag;			/* page address if readable */
+  uint32 wtag;			/* page address if writable */
+  char *mem;			/* host address of the page */
+  int32 rws;			/* waitstates of a word read */
+  int32 wws[4];			/* waitstates of a write, by size */
+};
+
+/* Memory image header, see IMG_MAGIC */
+struct memimg
+{
+  char magic[8];
+  uint32 order;
+  uint32 ramstart;
+  uint32 ramsize;
+  uint32 romsize;
+  uint32 entry;
+  uint32 cpu;			/* cputype and archtype of the dump */
+  uint32 arch;
+  uint32 state;			/* offset of checkpoint state, or 0 */
+};
+
 struct pstate
 {
 
@@ -101,6 +252,10 @@ struct pstate
   uint32 fpu_pres;		/* FPU present (0 = No, 1 = Yes) */
 
   uint32 psr;			/* IU registers */
+  uint32 ccop;			/* pending lazy condition code update */
+  int32 ccsrc1;			/* its operands and result */
+  int32 ccsrc2;
+  int32 ccres;
   uint32 tbr;
   uint32 wim;
   uint32 g[8];
@@ -162,6 +317,7 @@ struct pstate
   uint64 mtimecmp;
   uint32 lrq;
   uint32 lrqa;
+  uint32 lrqv;			/* value loaded by lr, for sc with -mt */
 
   uint32 bphit;
   uint32 l1itags[L1ITAGS];
@@ -170,6 +326,15 @@ struct pstate
   uint64 l1dmiss;
 
   uint32 sp[NWIN];
+
+  struct pdinst *pd;		/* predecoded current instruction */
+  struct pdinst pdtmp;		/* decode buffer for uncached fetches */
+  struct tlbent tlb[TLB_ENTRIES];	/* software TLB */
+  uint32 wmiss;			/* writes that missed the TLB */
+#ifdef THREADED_DISPATCH
+  uint64 tdleft;		/* instructions the dispatcher may chain */
+  const uint64 *tdlimit;	/* no chaining at or past this time */
+#endif
 };
 
 struct evcell
@@ -177,9 +342,13 @@ struct evcell
   void (*cfunc) ();
   int32 arg;
   uint64 time;
-  struct evcell *nxt;
+  uint64 seq;			/* insertion order, keeps equal times FIFO */
+  uint32 pos;			/* index in event heap */
+  uint32 nxt;			/* next free cell */
 };
 
+#define EVC_NONE	0xffffffff
+
 struct cpu_arch
 {
   int bswap;
@@ -194,18 +363,28 @@ struct cpu_arch
   void (*display_ctrl) (struct pstate * sregs);
   void (*display_special) (struct pstate * sregs);
   void (*display_fpu) (struct pstate * sregs);
+  void (*predecode) (struct pdinst * pd);
+  uint32 (*translate) (struct pdinst * pd, uint32 addr, struct jitop * op,
+		       uint32 * extra);
+  uint32 (*emit) (struct jitblk * blk, unsigned char *buf, uint32 len);
 
 };
 
 struct estate
 {
-  struct evcell eq;
-  struct evcell *freeq;
+  struct evcell *evcell;		/* event cell pool */
+  uint32 *eq;			/* event queue, binary heap of cell indices */
+  uint32 evnum;			/* number of queued events */
+  uint32 evmax;			/* allocated event cells */
+  uint32 freeq;			/* first free event cell */
+  uint64 evseq;			/* event insertion counter */
   uint64 simtime;		/* timestamp of last access to event queue */
   uint64 evtime;		/* timestamp of next event */
   float32 freq;			/* Simulated processor frequency */
   double starttime;
   double tottime;
+  uint64 startcyc;		/* host cycle counter, if there is one */
+  uint64 totcyc;
   uint64 simstart;
   uint64 tlimit;		/* Simulation time limit */
   uint32 bptnum;
@@ -222,7 +401,12 @@ struct estate
   uint32 wpaddress;
   uint32 histlen;
   uint32 coven;			/* coverage enable */
+  uint32 stat;			/* collect detailed statistics */
+  uint64 iosfx;			/* device reads with side effects or
+				   time-dependent values */
   uint32 ramstart;		/* start of RAM */
+  uint32 ramsize;		/* allocated RAM and ROM */
+  uint32 romsize;
   uint32 bpcpu;			/* cpu that hit breakpoint */
   uint32 bend;			/* cpu big endian */
   uint32 cpu;			/* cpu type from elf file */
@@ -232,6 +416,21 @@ struct estate
 extern const struct cpu_arch *arch;
 extern const struct cpu_arch sparc32;
 extern const struct cpu_arch riscv;
+extern int sparc_dispatch_instruction (struct pstate *sregs);
+extern int riscv_dispatch_instruction (struct pstate *sregs);
+extern void sparc_sync_cc (struct pstate *sregs);
+extern void sparc_sync_accex (void);
+extern void riscv_sync_fflags (void);
+
+/* Lazy SPARC condition codes, see sparc_sync_cc () */
+#define CC_NONE	0
+#define CC_ADD	1
+#define CC_SUB	2
+#define CC_LOG	3
+
+/* Bring the condition codes in psr up to date */
+#define SYNC_CC(sregs) \
+  ((sregs)->ccop != CC_NONE ? sparc_sync_cc (sregs) : (void) 0)
 
 /* return values for run_sim */
 #define OK 0
@@ -262,12 +461,16 @@ extern const struct cpu_arch riscv;
 extern const struct memsys erc32sys;
 
 /* func.c */
-extern char romb[];
-extern char ramb[];
-extern struct pstate sregs[];
+extern char *romb;
+extern char *ramb;
+extern uint32 romsize;
+extern uint32 ramsize;
+extern int hugepage;
+extern struct pstate *sregs;
 extern struct estate ebase;
-extern struct evcell evbuf[];
 extern int nfp;
+extern int fpexact;
+extern int noidle;
 extern int ift;
 extern int ctrl_c;
 extern int sis_verbose;
@@ -277,7 +480,7 @@ extern int wrp;
 extern int rom8;
 extern int uben;
 extern int irqpend;
-extern int ext_irl[];
+extern int *ext_irl;
 extern int termsave;
 extern char uart_dev1[];
 extern char uart_dev2[];
@@ -291,8 +494,163 @@ extern void init_signals (void);
 
 void print_insn_sis (uint32 addr);
 extern uint32 dis_mem (uint32 addr, uint32 len);
-extern void event (void (*cfunc) (), int32 arg, uint64 delta);
+extern uint64 event (void (*cfunc) (), int32 arg, uint64 delta);
+extern int cancel_event (uint64 handle);
+extern void init_event (void);
+extern void advance_time (uint64 endtime);
 extern uint32 now (void);
+extern uint64 sim_time (void);
+extern unsigned char pdc_flags[];
+extern void pdc_flush (uint32 addr, uint32 len);
+extern void pdc_reset (void);
+extern void tlb_flush (void);
+extern uint32 jit_nop (struct pstate *sregs, const struct jitop *op);
+extern void mem_alloc (uint32 ramdef, uint32 romdef);
+extern int mem_image (const char *fname);
+extern int mem_dump (const char *fname);
+extern void ckpt_state (const char *name, void *addr, uint32 size);
+extern void ckpt_event (const char *name, void (*cfunc) ());
+extern int ckpt_save (const char *fname);
+extern int ckpt_restore (const char *fname);
+extern int baseline_set (void);
+extern int baseline_rewind (void);
+extern void baseline_drop (void);
+extern int tlb_miss_read (struct pstate *sregs, uint32 addr, uint32 * data,
+			  int32 * ws);
+extern int tlb_miss_write (struct pstate *sregs, uint32 addr, uint32 * data,
+			   int32 sz, int32 * ws);
+
+/* Invalidate predecoded instructions overlapping a store to memory, and
+   note the first store to a page after the baseline */
+#define PDC_WRITE(addr, len) \
+  do { \
+    if (pdc_flags[(uint32) (addr) >> PDC_PAGEBITS] \
+	|| (((addr) & (PDC_PAGESIZE - 1)) + (len) > PDC_PAGESIZE)) \
+      pdc_flush ((addr), (len)); \
+  } while (0)
+
+/* Data accesses of the interpreters, same interface as ms->memory_read
+   and ms->memory_write.  Word reads and aligned writes that hit the
+   TLB are done inline; the rest, misaligned accesses included, take
+   the memsys path. */
+
+static inline int
+tlb_read (struct pstate *sregs, uint32 addr, uint32 * data, int32 * ws)
+{
+  struct tlbent *e = &sregs->tlb[(addr >> TLB_PAGEBITS) & (TLB_ENTRIES - 1)];
+
+  if (e->rtag == (addr & ~(TLB_PAGESIZE - 4)))
+    {
+      memcpy (data, &e->mem[addr & (TLB_PAGESIZE - 1)], 4);
+      *ws = e->rws;
+      return 0;
+    }
+  return tlb_miss_read (sregs, addr, data, ws);
+}
+
+static inline int
+tlb_write (struct pstate *sregs, uint32 addr, uint32 * data, int32 sz,
+	   int32 * ws)
+{
+  struct tlbent *e = &sregs->tlb[(addr >> TLB_PAGEBITS) & (TLB_ENTRIES - 1)];
+  uint32 off = addr & (TLB_PAGESIZE - 1);
+
+  if ((e->wtag == (addr & ~(TLB_PAGESIZE - 1)))
+      && !(addr & ((1 << sz) - 1)))
+    {
+      PDC_WRITE (addr, 1 << sz);
+      switch (sz)
+	{
+	case 0:
+	  e->mem[off ^ arch->bswap] = *data & 0x0ff;
+	  break;
+	case 1:
+	  *((uint16 *) & e->mem[off ^ (arch->bswap & 2)]) = *data & 0x0ffff;
+	  break;
+	case 2:
+	  memcpy (&e->mem[off], data, 4);
+	  break;
+	default:
+	  memcpy (&e->mem[off], data, 8);
+	  break;
+	}
+      *ws = e->wws[sz];
+      return 0;
+    }
+  return tlb_miss_write (sregs, addr, data, sz, ws);
+}
+
+/* TLB lookups of translated code (see struct jitop): the entry for a
+   read of the word at addr or a write of 1 << sz bytes, if it hits
+   and takes at most JIT_MAXWS waitstates.  Misaligned addresses match
+   no tag.  Writes to pages with predecoded code, or not yet written
+   since the baseline, are left to tlb_write (). */
+
+static inline struct tlbent *
+jit_tlb_read (struct pstate *sregs, uint32 addr)
+{
+  struct tlbent *e = &sregs->tlb[(addr >> TLB_PAGEBITS) & (TLB_ENTRIES - 1)];
+
+  if ((e->rtag != (addr & ~(TLB_PAGESIZE - 4))) || (e->rws > JIT_MAXWS))
+    return NULL;
+  return e;
+}
+
+static inline struct tlbent *
+jit_tlb_write (struct pstate *sregs, uint32 addr, int32 sz)
+{
+  struct tlbent *e = &sregs->tlb[(addr >> TLB_PAGEBITS) & (TLB_ENTRIES - 1)];
+
+  if ((e->wtag != (addr & ~(TLB_PAGESIZE - (1 << sz))))
+      || (e->wws[sz] > JIT_MAXWS) || pdc_flags[addr >> PDC_PAGEBITS])
+    return NULL;
+  return e;
+}
+
+#ifdef THREADED_DISPATCH
+#ifndef __GNUC__
+#error "threaded dispatch needs GCC labels as values"
+#endif
+
+/* Case labels that the threaded dispatcher can jump to directly */
+#define TCASE(x)	case x: td_##x
+#define TD_LABEL(l)	l:
+
+/* Called by the dispatcher after each instruction while tdleft is
+   set.  Does what run_block () would do before the next instruction
+   and returns 1 if that instruction directly follows pc in the same
+   predecoded page, so that its handler can be entered without
+   returning to the main loop. */
+
+static inline int
+td_next (struct pstate *sregs, uint32 pc)
+{
+  struct pdinst *pd = sregs->pd;
+  uint32 len = pd->len;
+
+  if ((--sregs->tdleft == 0) || (pd->flags & PD_BLKEND)
+      || (sregs->trap | sregs->pwd_mode | ext_irl[sregs->cpu] | ctrl_c)
+      || ((sregs->simtime + sregs->icnt + sregs->hold + sregs->fhold) >=
+	  *sregs->tdlimit) || (sregs->pc != pc + len)
+      || ((sregs->pc & (PDC_PAGESIZE - 1)) < len) || (pd == &sregs->pdtmp)
+      || !(pdc_flags[sregs->pc >> PDC_PAGEBITS] & PDC_VALID))
+    return 0;
+  pd += len >> 1;
+  if (__atomic_load_n (&pd->len, __ATOMIC_ACQUIRE) == 0)
+    return 0;
+  sregs->simtime += sregs->icnt + sregs->hold + sregs->fhold;
+  sregs->icnt = 1;
+  sregs->fhold = 0;
+  sregs->pd = pd;
+  sregs->inst = pd->inst;
+  sregs->hold = pd->hold;
+  return 1;
+}
+#else
+#define TCASE(x)	case x
+#define TD_LABEL(l)
+#endif
+
 extern int check_bpt (struct pstate *sregs);
 extern int check_wpr (struct pstate *sregs, int32 address,
 		      unsigned char mask);
@@ -304,6 +662,7 @@ extern void sys_reset (void);
 extern void sys_halt (void);
 extern int elf_load (char *fname, int load);
 extern double get_time (void);
+extern uint64 get_cycles (void);
 extern int nouartrx;
 //extern                host_callback *sim_callback;
 extern int dumbio;
@@ -313,8 +672,20 @@ extern int archtype;
 extern int sis_gdb_break;
 extern int cpu;			/* active debug cpu */
 extern int ncpu;		/* number of online cpus */
+extern int ncpu_alloc;		/* cpus with allocated state */
 extern int delta;		/* time slice for MP simulation */
+extern int delta_max;		/* longest adaptive MP time slice */
+extern int mp_xcpu;		/* cross-cpu activity in the current slice */
+extern int jit;			/* run translated blocks */
+extern int jithost;		/* as host code where JIT_X86 allows */
+extern int l1cache;		/* L1 cache model in MP runs (-l1) */
+extern int mtsim;		/* run cores on host threads (-mt) */
+extern int mt_running;		/* cores are running on host threads */
+extern void bus_lock (void);
+extern void bus_unlock (void);
+extern uint32 *mt_word (struct pstate *sregs, uint32 addr, int32 * ws);
 extern void pwd_enter (struct pstate *sregs);
+extern void mp_wake (int cpu);
 extern void remove_event (void (*cfunc) (), int32 arg);
 extern int run_sim (uint64 icount, int dis);
 void save_sp (struct pstate *sregs);
@@ -336,6 +707,8 @@ extern void rt_sync();
 
 /* exec.c */
 extern void init_regs (struct pstate *sregs);
+extern void init_cpu (int i);
+extern void cpu_alloc (int n);
 extern void mul64 (uint32 n1, uint32 n2, uint32 * result_hi,
 		   uint32 * result_lo, int msigned);
 extern void div64 (uint32 n1_hi, uint32 n1_low, uint32 n2,
@@ -344,6 +717,7 @@ extern void div64 (uint32 n1_hi, uint32 n1_low, uint32 n2,
 /* float.c */
 extern int get_accex (void);
 extern void clear_accex (void);
+extern void set_fround (int fround);
 extern void set_fsr (uint32 fsr);
 
 /* help.c */
@@ -367,6 +741,8 @@ struct memsys
   void (*boot_init) (void);
   char *(*get_mem_ptr) (uint32 addr, uint32 size);
   void (*set_irq) (int32 level);
+  int (*map_page) (uint32 addr, struct tlbent * e);
+  void (*bus_stat) (int clear);
 };
 
 extern const struct memsys *ms;
@@ -411,6 +787,7 @@ extern int rv32_check_lirq (int cpu);
 /* greth.c */
 extern uint32 greth_read (uint32 address);
 extern void greth_write (uint32 address, uint32 data);
+extern void greth_init (void);
 extern void greth_rxready(unsigned char *buffer, int len);
 
 /* tap.c */
@@ -61,6 +61,34 @@ log_cc (result, sregs)
     sregs->psr |= PSR_Z;
 }
 
+/* The integer condition codes are evaluated lazily.  Instructions
+   that set them record the kind of operation, its operands and its
+   result with SET_CC, and SYNC_CC computes them into psr only where
+   they are read: by branches, traps on condition, add/subtract with
+   carry, the few instructions that update them in part, and psr
+   accesses from outside the run loop. */
+
+void
+sparc_sync_cc (sregs)
+     struct pstate *sregs;
+{
+  switch (sregs->ccop)
+    {
+    case CC_ADD:
+      sregs->psr = add_cc (sregs->psr, sregs->ccsrc1, sregs->ccsrc2,
+			   sregs->ccres);
+      break;
+    case CC_SUB:
+      sregs->psr = sub_cc (sregs->psr, sregs->ccsrc1, sregs->ccsrc2,
+			   sregs->ccres);
+      break;
+    case CC_LOG:
+      log_cc (sregs->ccres, sregs);
+      break;
+    }
+  sregs->ccop = CC_NONE;
+}
+
 static int
 chk_asi (sregs, asi, op3)
      struct pstate *sregs;
@@ -133,7 +161,9 @@ extract_byte (uint32 data, uint32 address)
   return ((data >> ((3 - (address & 3)) * 8)) & 0xff);
 }
 
-/* How to map SPARC FSR onto the host */
+/* How to map SPARC FSR onto the host.  Only reprograms the host
+   when the rounding mode differs from the one in effect, so it is
+   cheap enough to call for every FPop. */
 static void
 sparc_set_fsr (fsr)
      uint32 fsr;
@@ -156,23 +186,91 @@ sparc_set_fsr (fsr)
       fround = FE_DOWNWARD;
       break;
     }
-  fesetround (fround);
+  set_fround (fround);
 }
 
-static int
+int
 sparc_dispatch_instruction (sregs)
      struct pstate *sregs;
 {
 
   uint32 cwp, op, op2, op3, asi, rd, cond, rs1, rs2;
-  uint32 ldep, icc, *rdd, data;
+  uint32 ldep, icc, *rdd, data, *p;
   int32 operand1, operand2, result, eicc, new_cwp;
   int32 pc, npc, address, ws, mexc, fcc, annul;
   uint32 ddata[2];
-
+  struct pdinst *pd;
+#ifdef THREADED_DISPATCH
+  uint32 ipc;
+
+  /* Handlers by (op << 6) | op2/op3.  Entries without a handler of
+     their own go through the switch. */
+  static const void *const td_op[256] = {
+    [0 ... 255] = &&td_switch,
+    [SETHI] = &&td_SETHI,
+    [BICC] = &&td_BICC,
+    [FPBCC] = &&td_FPBCC,
+    [64 ... 127] = &&td_call,
+    [128 + TICC] = &&td_TICC,
+    [128 + MULScc] = &&td_MULScc,
+    [128 + SMUL] = &&td_SMUL,
+    [128 + SMULCC] = &&td_SMULCC,
+    [128 + UMUL] = &&td_UMUL,
+    [128 + UMULCC] = &&td_UMULCC,
+    [128 + SDIV] = &&td_SDIV,
+    [128 + SDIVCC] = &&td_SDIVCC,
+    [128 + UDIV] = &&td_UDIV,
+    [128 + UDIVCC] = &&td_UDIVCC,
+    [128 + IXNOR] = &&td_IXNOR,
+    [128 + IXNORCC] = &&td_IXNORCC,
+    [128 + IXOR] = &&td_IXOR,
+    [128 + IXORCC] = &&td_IXORCC,
+    [128 + IOR] = &&td_IOR,
+    [128 + IORCC] = &&td_IORCC,
+    [128 + IORN] = &&td_IORN,
+    [128 + IORNCC] = &&td_IORNCC,
+    [128 + IANDNCC] = &&td_IANDNCC,
+    [128 + IANDN] = &&td_IANDN,
+    [128 + IAND] = &&td_IAND,
+    [128 + IANDCC] = &&td_IANDCC,
+    [128 + SUB] = &&td_SUB,
+    [128 + SUBCC] = &&td_SUBCC,
+    [128 + SUBX] = &&td_SUBX,
+    [128 + SUBXCC] = &&td_SUBXCC,
+    [128 + ADD] = &&td_ADD,
+    [128 + ADDCC] = &&td_ADDCC,
+    [128 + ADDX] = &&td_ADDX,
+    [128 + ADDXCC] = &&td_ADDXCC,
+    [128 + TADDCC] = &&td_TADDCC,
+    [128 + TSUBCC] = &&td_TSUBCC,
+    [128 + TADDCCTV] = &&td_TADDCCTV,
+    [128 + TSUBCCTV] = &&td_TSUBCCTV,
+    [128 + SLL] = &&td_SLL,
+    [128 + SRL] = &&td_SRL,
+    [128 + SRA] = &&td_SRA,
+    [128 + FLUSH] = &&td_FLUSH,
+    [128 + SAVE] = &&td_SAVE,
+    [128 + RESTORE] = &&td_RESTORE,
+    [128 + RDPSR] = &&td_RDPSR,
+    [128 + RDY] = &&td_RDY,
+    [128 + RDWIM] = &&td_RDWIM,
+    [128 + RDTBR] = &&td_RDTBR,
+    [128 + WRPSR] = &&td_WRPSR,
+    [128 + WRWIM] = &&td_WRWIM,
+    [128 + WRTBR] = &&td_WRTBR,
+    [128 + WRY] = &&td_WRY,
+    [128 + JMPL] = &&td_JMPL,
+    [128 + RETT] = &&td_RETT,
+    [192 ... 255] = &&td_mem,
+  };
+
+td_start:
+  ipc = sregs->pc;
+#endif
+  pd = sregs->pd;
   sregs->ninst++;
   cwp = ((sregs->psr & PSR_CWP) << 4);
-  op = sregs->inst >> 30;
+  op = pd->op;
   pc = sregs->npc;
   npc = sregs->npc + 4;
   op3 = rd = rs1 = operand2 = eicc = 0;
@@ -182,9 +280,9 @@ sparc_dispatch_instruction (sregs)
   if (op & 2)
     {
 
-      op3 = (sregs->inst >> 19) & 0x3f;
-      rs1 = (sregs->inst >> 14) & 0x1f;
-      rd = (sregs->inst >> 25) & 0x1f;
+      op3 = pd->fn;
+      rs1 = pd->rs1;
+      rd = pd->rd;
 
 #ifdef LOAD_DEL
 
@@ -194,16 +292,15 @@ sparc_dispatch_instruction (sregs)
 		&& (sregs->ildreg != 0));
       else
 	ldep = 0;
-      if (sregs->inst & INST_I)
+      if (pd->flags & PD_IMM)
 	{
 	  if (ldep && (sregs->ildreg == rs1))
 	    sregs->hold++;
-	  operand2 = sregs->inst;
-	  operand2 = ((operand2 << 19) >> 19);	/* sign extend */
+	  operand2 = pd->imm;
 	}
       else
 	{
-	  rs2 = sregs->inst & INST_RS2;
+	  rs2 = pd->rs2;
 	  if (rs2 > 7)
 	    operand2 = sregs->r[(cwp + rs2) & 0x7f];
 	  else
@@ -212,14 +309,13 @@ sparc_dispatch_instruction (sregs)
 	    sregs->hold++;
 	}
 #else
-      if (sregs->inst & INST_I)
+      if (pd->flags & PD_IMM)
 	{
-	  operand2 = sregs->inst;
-	  operand2 = ((operand2 << 19) >> 19);	/* sign extend */
+	  operand2 = pd->imm;
 	}
       else
 	{
-	  rs2 = sregs->inst & INST_RS2;
+	  rs2 = pd->rs2;
 	  if (rs2 > 7)
 	    operand2 = sregs->r[(cwp + rs2) & 0x7f];
 	  else
@@ -236,24 +332,26 @@ sparc_dispatch_instruction (sregs)
       else
 	rs1 = sregs->g[rs1];
     }
+#ifdef THREADED_DISPATCH
+  goto *td_op[pd->hx];
+td_switch:
+#endif
   switch (op)
     {
     case 0:
-      op2 = (sregs->inst >> 22) & 0x7;
+      op2 = pd->fn;
       switch (op2)
 	{
-	case SETHI:
-	  rd = (sregs->inst >> 25) & 0x1f;
+	TCASE (SETHI):
+	  rd = pd->rd;
 	  if (rd > 7)
 	    rdd = &(sregs->r[(cwp + rd) & 0x7f]);
 	  else
 	    rdd = &(sregs->g[rd]);
-	  *rdd = sregs->inst << 10;
+	  *rdd = pd->imm;
 	  break;
-	case BICC:
-#ifdef STAT
-	  sregs->nbranch++;
-#endif
+	TCASE (BICC):
+	  SYNC_CC (sregs);
 	  icc = sregs->psr >> 20;
 	  cond = ((sregs->inst >> 25) & 0x0f);
 	  switch (cond)
@@ -311,9 +409,7 @@ sparc_dispatch_instruction (sregs)
 	    }
 	  if (eicc & 1)
 	    {
-	      operand1 = sregs->inst;
-	      operand1 = ((operand1 << 10) >> 8);	/* sign extend */
-	      npc = sregs->pc + operand1;
+	      npc = sregs->pc + pd->imm;
 	      if (ebase.coven)
 		{
 		  if (cond == BICC_BA)
@@ -342,10 +438,7 @@ sparc_dispatch_instruction (sregs)
 		cov_bnt (sregs->pc);
 	    }
 	  break;
-	case FPBCC:
-#ifdef STAT
-	  sregs->nbranch++;
-#endif
+	TCASE (FPBCC):
 	  if (!((sregs->psr & PSR_EF) && FP_PRES))
 	    {
 	      sregs->trap = TRAP_FPDIS;
@@ -412,9 +505,7 @@ sparc_dispatch_instruction (sregs)
 	    }
 	  if (eicc)
 	    {
-	      operand1 = sregs->inst;
-	      operand1 = ((operand1 << 10) >> 8);	/* sign extend */
-	      npc = sregs->pc + operand1;
+	      npc = sregs->pc + pd->imm;
 	      if (ebase.coven)
 		{
 		  cov_bt (sregs->pc, npc);
@@ -447,11 +538,9 @@ sparc_dispatch_instruction (sregs)
 	}
       break;
     case 1:			/* CALL */
-#ifdef STAT
-      sregs->nbranch++;
-#endif
+    TD_LABEL (td_call)
       sregs->r[(cwp + 15) & 0x7f] = sregs->pc;
-      npc = sregs->pc + (sregs->inst << 2);
+      npc = sregs->pc + pd->imm;
       if (ebase.coven)
 	{
 	  cov_jmp (sregs->pc, npc);
@@ -478,7 +567,8 @@ sparc_dispatch_instruction (sregs)
 
 	  switch (op3)
 	    {
-	    case TICC:
+	    TCASE (TICC):
+	      SYNC_CC (sregs);
 	      icc = sregs->psr >> 20;
 	      cond = ((sregs->inst >> 25) & 0x0f);
 	      switch (cond)
@@ -544,7 +634,8 @@ sparc_dispatch_instruction (sregs)
 		}
 	      break;
 
-	    case MULScc:
+	    TCASE (MULScc):
+	      SYNC_CC (sregs);
 	      operand1 =
 		(((sregs->psr & PSR_V) ^ ((sregs->psr & PSR_N) >> 2))
 		 << 10) | (rs1 >> 1);
@@ -552,20 +643,21 @@ sparc_dispatch_instruction (sregs)
 		operand2 = 0;
 	      *rdd = operand1 + operand2;
 	      sregs->y = (rs1 << 31) | (sregs->y >> 1);
-	      sregs->psr = add_cc (sregs->psr, operand1, operand2, *rdd);
+	      SET_CC (sregs, CC_ADD, operand1, operand2, *rdd);
 	      break;
-	    case SMUL:
+	    TCASE (SMUL):
 	      {
 		mul64 (rs1, operand2, &sregs->y, rdd, 1);
 		sregs->icnt = T_MUL;
 	      }
 	      break;
-	    case SMULCC:
+	    TCASE (SMULCC):
 	      {
 		uint32 result;
 
 		mul64 (rs1, operand2, &sregs->y, &result, 1);
 
+		SYNC_CC (sregs);
 		if (result & 0x80000000)
 		  sregs->psr |= PSR_N;
 		else
@@ -580,18 +672,19 @@ sparc_dispatch_instruction (sregs)
 		sregs->icnt = T_MUL;
 	      }
 	      break;
-	    case UMUL:
+	    TCASE (UMUL):
 	      {
 		mul64 (rs1, operand2, &sregs->y, rdd, 0);
 		sregs->icnt = T_MUL;
 	      }
 	      break;
-	    case UMULCC:
+	    TCASE (UMULCC):
 	      {
 		uint32 result;
 
 		mul64 (rs1, operand2, &sregs->y, &result, 0);
 
+		SYNC_CC (sregs);
 		if (result & 0x80000000)
 		  sregs->psr |= PSR_N;
 		else
@@ -606,7 +699,7 @@ sparc_dispatch_instruction (sregs)
 		sregs->icnt = T_MUL;
 	      }
 	      break;
-	    case SDIV:
+	    TCASE (SDIV):
 	      {
 		if (operand2 == 0)
 		  {
@@ -618,7 +711,7 @@ sparc_dispatch_instruction (sregs)
 		sregs->icnt = T_DIV;
 	      }
 	      break;
-	    case SDIVCC:
+	    TCASE (SDIVCC):
 	      {
 		uint32 result;
 
@@ -630,6 +723,7 @@ sparc_dispatch_instruction (sregs)
 
 		div64 (sregs->y, rs1, operand2, &result, 1);
 
+		SYNC_CC (sregs);
 		if (result & 0x80000000)
 		  sregs->psr |= PSR_N;
 		else
@@ -647,7 +741,7 @@ sparc_dispatch_instruction (sregs)
 		sregs->icnt = T_DIV;
 	      }
 	      break;
-	    case UDIV:
+	    TCASE (UDIV):
 	      {
 		if (operand2 == 0)
 		  {
@@ -659,7 +753,7 @@ sparc_dispatch_instruction (sregs)
 		sregs->icnt = T_DIV;
 	      }
 	      break;
-	    case UDIVCC:
+	    TCASE (UDIVCC):
 	      {
 		uint32 result;
 
@@ -671,6 +765,7 @@ sparc_dispatch_instruction (sregs)
 
 		div64 (sregs->y, rs1, operand2, &result, 0);
 
+		SYNC_CC (sregs);
 		if (result & 0x80000000)
 		  sregs->psr |= PSR_N;
 		else
@@ -688,89 +783,95 @@ sparc_dispatch_instruction (sregs)
 		sregs->icnt = T_DIV;
 	      }
 	      break;
-	    case IXNOR:
+	    TCASE (IXNOR):
 	      *rdd = rs1 ^ ~operand2;
 	      break;
-	    case IXNORCC:
+	    TCASE (IXNORCC):
 	      *rdd = rs1 ^ ~operand2;
-	      log_cc (*rdd, sregs);
+	      SET_CC (sregs, CC_LOG, 0, 0, *rdd);
 	      break;
-	    case IXOR:
+	    TCASE (IXOR):
 	      *rdd = rs1 ^ operand2;
 	      break;
-	    case IXORCC:
+	    TCASE (IXORCC):
 	      *rdd = rs1 ^ operand2;
-	      log_cc (*rdd, sregs);
+	      SET_CC (sregs, CC_LOG, 0, 0, *rdd);
 	      break;
-	    case IOR:
+	    TCASE (IOR):
 	      *rdd = rs1 | operand2;
 	      break;
-	    case IORCC:
+	    TCASE (IORCC):
 	      *rdd = rs1 | operand2;
-	      log_cc (*rdd, sregs);
+	      SET_CC (sregs, CC_LOG, 0, 0, *rdd);
 	      break;
-	    case IORN:
+	    TCASE (IORN):
 	      *rdd = rs1 | ~operand2;
 	      break;
-	    case IORNCC:
+	    TCASE (IORNCC):
 	      *rdd = rs1 | ~operand2;
-	      log_cc (*rdd, sregs);
+	      SET_CC (sregs, CC_LOG, 0, 0, *rdd);
 	      break;
-	    case IANDNCC:
+	    TCASE (IANDNCC):
 	      *rdd = rs1 & ~operand2;
-	      log_cc (*rdd, sregs);
+	      SET_CC (sregs, CC_LOG, 0, 0, *rdd);
 	      break;
-	    case IANDN:
+	    TCASE (IANDN):
 	      *rdd = rs1 & ~operand2;
 	      break;
-	    case IAND:
+	    TCASE (IAND):
 	      *rdd = rs1 & operand2;
 	      break;
-	    case IANDCC:
+	    TCASE (IANDCC):
 	      *rdd = rs1 & operand2;
-	      log_cc (*rdd, sregs);
+	      SET_CC (sregs, CC_LOG, 0, 0, *rdd);
 	      break;
-	    case SUB:
+	    TCASE (SUB):
 	      *rdd = rs1 - operand2;
 	      break;
-	    case SUBCC:
+	    TCASE (SUBCC):
 	      *rdd = rs1 - operand2;
-	      sregs->psr = sub_cc (sregs->psr, rs1, operand2, *rdd);
+	      SET_CC (sregs, CC_SUB, rs1, operand2, *rdd);
 	      break;
-	    case SUBX:
+	    TCASE (SUBX):
+	      SYNC_CC (sregs);
 	      *rdd = rs1 - operand2 - ((sregs->psr >> 20) & 1);
 	      break;
-	    case SUBXCC:
+	    TCASE (SUBXCC):
+	      SYNC_CC (sregs);
 	      *rdd = rs1 - operand2 - ((sregs->psr >> 20) & 1);
-	      sregs->psr = sub_cc (sregs->psr, rs1, operand2, *rdd);
+	      SET_CC (sregs, CC_SUB, rs1, operand2, *rdd);
 	      break;
-	    case ADD:
+	    TCASE (ADD):
 	      *rdd = rs1 + operand2;
 	      break;
-	    case ADDCC:
+	    TCASE (ADDCC):
 	      *rdd = rs1 + operand2;
-	      sregs->psr = add_cc (sregs->psr, rs1, operand2, *rdd);
+	      SET_CC (sregs, CC_ADD, rs1, operand2, *rdd);
 	      break;
-	    case ADDX:
+	    TCASE (ADDX):
+	      SYNC_CC (sregs);
 	      *rdd = rs1 + operand2 + ((sregs->psr >> 20) & 1);
 	      break;
-	    case ADDXCC:
+	    TCASE (ADDXCC):
+	      SYNC_CC (sregs);
 	      *rdd = rs1 + operand2 + ((sregs->psr >> 20) & 1);
-	      sregs->psr = add_cc (sregs->psr, rs1, operand2, *rdd);
+	      SET_CC (sregs, CC_ADD, rs1, operand2, *rdd);
 	      break;
-	    case TADDCC:
+	    TCASE (TADDCC):
+	      SYNC_CC (sregs);
 	      *rdd = rs1 + operand2;
 	      sregs->psr = add_cc (sregs->psr, rs1, operand2, *rdd);
 	      if ((rs1 | operand2) & 0x3)
 		sregs->psr |= PSR_V;
 	      break;
-	    case TSUBCC:
+	    TCASE (TSUBCC):
+	      SYNC_CC (sregs);
 	      *rdd = rs1 - operand2;
 	      sregs->psr = sub_cc (sregs->psr, rs1, operand2, *rdd);
 	      if ((rs1 | operand2) & 0x3)
 		sregs->psr |= PSR_V;
 	      break;
-	    case TADDCCTV:
+	    TCASE (TADDCCTV):
 	      *rdd = rs1 + operand2;
 	      result = add_cc (0, rs1, operand2, *rdd);
 	      if ((rs1 | operand2) & 0x3)
@@ -781,10 +882,11 @@ sparc_dispatch_instruction (sregs)
 		}
 	      else
 		{
+		  SYNC_CC (sregs);
 		  sregs->psr = (sregs->psr & ~PSR_CC) | result;
 		}
 	      break;
-	    case TSUBCCTV:
+	    TCASE (TSUBCCTV):
 	      *rdd = rs1 - operand2;
 	      result = add_cc (0, rs1, operand2, *rdd);
 	      if ((rs1 | operand2) & 0x3)
@@ -795,23 +897,24 @@ sparc_dispatch_instruction (sregs)
 		}
 	      else
 		{
+		  SYNC_CC (sregs);
 		  sregs->psr = (sregs->psr & ~PSR_CC) | result;
 		}
 	      break;
-	    case SLL:
+	    TCASE (SLL):
 	      *rdd = rs1 << (operand2 & 0x1f);
 	      break;
-	    case SRL:
+	    TCASE (SRL):
 	      *rdd = rs1 >> (operand2 & 0x1f);
 	      break;
-	    case SRA:
+	    TCASE (SRA):
 	      *rdd = ((int) rs1) >> (operand2 & 0x1f);
 	      break;
-	    case FLUSH:
+	    TCASE (FLUSH):
 	      if (ift)
 		sregs->trap = TRAP_UNIMP;
 	      break;
-	    case SAVE:
+	    TCASE (SAVE):
 	      new_cwp = ((sregs->psr & PSR_CWP) - 1) & PSR_CWP;
 	      if (sregs->wim & (1 << new_cwp))
 		{
@@ -823,7 +926,7 @@ sparc_dispatch_instruction (sregs)
 	      *rdd = rs1 + operand2;
 	      sregs->psr = (sregs->psr & ~PSR_CWP) | new_cwp;
 	      break;
-	    case RESTORE:
+	    TCASE (RESTORE):
 
 	      new_cwp = ((sregs->psr & PSR_CWP) + 1) & PSR_CWP;
 	      if (sregs->wim & (1 << new_cwp))
@@ -836,15 +939,16 @@ sparc_dispatch_instruction (sregs)
 	      *rdd = rs1 + operand2;
 	      sregs->psr = (sregs->psr & ~PSR_CWP) | new_cwp;
 	      break;
-	    case RDPSR:
+	    TCASE (RDPSR):
 	      if (!(sregs->psr & PSR_S))
 		{
 		  sregs->trap = TRAP_PRIVI;
 		  break;
 		}
+	      SYNC_CC (sregs);
 	      *rdd = sregs->psr;
 	      break;
-	    case RDY:
+	    TCASE (RDY):
 	      if (cputype != CPU_ERC32)
 		{
 		  rs1 = (sregs->inst >> 14) & 0x1f;
@@ -867,7 +971,7 @@ sparc_dispatch_instruction (sregs)
 	      else
 		*rdd = sregs->y;
 	      break;
-	    case RDWIM:
+	    TCASE (RDWIM):
 	      if (!(sregs->psr & PSR_S))
 		{
 		  sregs->trap = TRAP_PRIVI;
@@ -875,7 +979,7 @@ sparc_dispatch_instruction (sregs)
 		}
 	      *rdd = sregs->wim;
 	      break;
-	    case RDTBR:
+	    TCASE (RDTBR):
 	      if (!(sregs->psr & PSR_S))
 		{
 		  sregs->trap = TRAP_PRIVI;
@@ -883,7 +987,7 @@ sparc_dispatch_instruction (sregs)
 		}
 	      *rdd = sregs->tbr;
 	      break;
-	    case WRPSR:
+	    TCASE (WRPSR):
 	      if ((sregs->psr & 0x1f) > 7)
 		{
 		  sregs->trap = TRAP_UNIMP;
@@ -894,10 +998,11 @@ sparc_dispatch_instruction (sregs)
 		  sregs->trap = TRAP_PRIVI;
 		  break;
 		}
+	      SYNC_CC (sregs);
 	      sregs->psr = (sregs->psr & 0xff000000) |
 		((rs1 ^ operand2) & 0x00f03fff);
 	      break;
-	    case WRWIM:
+	    TCASE (WRWIM):
 	      if (!(sregs->psr & PSR_S))
 		{
 		  sregs->trap = TRAP_PRIVI;
@@ -905,7 +1010,7 @@ sparc_dispatch_instruction (sregs)
 		}
 	      sregs->wim = (rs1 ^ operand2) & 0x0ff;
 	      break;
-	    case WRTBR:
+	    TCASE (WRTBR):
 	      if (!(sregs->psr & PSR_S))
 		{
 		  sregs->trap = TRAP_PRIVI;
@@ -914,7 +1019,7 @@ sparc_dispatch_instruction (sregs)
 	      sregs->tbr = (sregs->tbr & 0x00000ff0) |
 		((rs1 ^ operand2) & 0xfffff000);
 	      break;
-	    case WRY:
+	    TCASE (WRY):
 	      sregs->y = (rs1 ^ operand2);
 	      if (cputype != CPU_ERC32)
 		{
@@ -931,11 +1036,7 @@ sparc_dispatch_instruction (sregs)
 		    }
 		}
 	      break;
-	    case JMPL:
-
-#ifdef STAT
-	      sregs->nbranch++;
-#endif
+	    TCASE (JMPL):
 	      sregs->icnt = T_JMPL;	/* JMPL takes two cycles */
 	      if (rs1 & 0x3)
 		{
@@ -952,7 +1053,7 @@ sparc_dispatch_instruction (sregs)
 		  cov_exec (pc);	/* delay slot executed */
 		}
 	      break;
-	    case RETT:
+	    TCASE (RETT):
 	      address = rs1 + operand2;
 	      new_cwp = ((sregs->psr & PSR_CWP) + 1) & PSR_CWP;
 	      sregs->icnt = T_RETT;	/* RETT takes two cycles */
@@ -996,6 +1097,7 @@ sparc_dispatch_instruction (sregs)
 	}
       break;
     case 3:			/* Load/store instructions */
+    TD_LABEL (td_mem)
 
       address = rs1 + operand2;
 
@@ -1021,9 +1123,6 @@ sparc_dispatch_instruction (sregs)
 		    break;
 		}
 	    }
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;
-#endif
 	}
       else
 	{
@@ -1036,9 +1135,6 @@ sparc_dispatch_instruction (sregs)
 		  break;
 		}
 	    }
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nload++;
-#endif
 	}
 
       /* Decode load/store instructions */
@@ -1062,9 +1158,9 @@ sparc_dispatch_instruction (sregs)
 	      else
 		rdd = &(sregs->g[rd]);
 	    }
-	  mexc = ms->memory_read (address, ddata, &ws);
+	  mexc = tlb_read (sregs, address, ddata, &ws);
 	  sregs->hold += ws;
-	  mexc |= ms->memory_read (address + 4, &ddata[1], &ws);
+	  mexc |= tlb_read (sregs, address + 4, &ddata[1], &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_LDD;
 	  if (mexc)
@@ -1075,9 +1171,6 @@ sparc_dispatch_instruction (sregs)
 	    {
 	      rdd[0] = ddata[0];
 	      rdd[1] = ddata[1];
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	      sregs->nload++;	/* Double load counts twice */
-#endif
 	    }
 	  break;
 
@@ -1103,7 +1196,7 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_read (address, &data, &ws);
+	  mexc = tlb_read (sregs, address, &data, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1119,7 +1212,17 @@ sparc_dispatch_instruction (sregs)
 	    break;
 	  /* fall through to LDSTUB */
 	case LDSTUB:
-	  mexc = ms->memory_read (address & ~3, &data, &ws);
+	  mp_xcpu = 1;
+	  if (mt_running && (p = mt_word (sregs, address, &ws)))
+	    {
+	      *rdd = __atomic_exchange_n ((unsigned char *) p +
+					  ((address & 3) ^ arch->bswap),
+					  0xff, __ATOMIC_SEQ_CST);
+	      sregs->hold += ws;
+	      sregs->icnt = T_LDST;
+	      break;
+	    }
+	  mexc = tlb_read (sregs, address & ~3, &data, &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_LDST;
 	  if (mexc)
@@ -1130,15 +1233,12 @@ sparc_dispatch_instruction (sregs)
 	  data = extract_byte (data, address);
 	  *rdd = data;
 	  data = 0x0ff;
-	  mexc = ms->memory_write (address, &data, 0, &ws);
+	  mexc = tlb_write (sregs, address, &data, 0, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
 	      sregs->trap = TRAP_DEXC;
 	    }
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nload++;
-#endif
 	  break;
 	case LDSBA:
 	case LDUBA:
@@ -1147,7 +1247,7 @@ sparc_dispatch_instruction (sregs)
 	  /* fall through to LDSB */
 	case LDSB:
 	case LDUB:
-	  mexc = ms->memory_read (address & ~3, &data, &ws);
+	  mexc = tlb_read (sregs, address & ~3, &data, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1172,7 +1272,7 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_read (address & ~3, &data, &ws);
+	  mexc = tlb_read (sregs, address & ~3, &data, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1205,7 +1305,7 @@ sparc_dispatch_instruction (sregs)
 		  (sregs->frs2 == rd))
 		sregs->fhold += (sregs->ftime - sregs->simtime);
 	    }
-	  mexc = ms->memory_read (address, &data, &ws);
+	  mexc = tlb_read (sregs, address, &data, &ws);
 	  sregs->hold += ws;
 	  sregs->flrd = rd;
 	  sregs->ltime = sregs->simtime + sregs->icnt + FLSTHOLD +
@@ -1237,9 +1337,9 @@ sparc_dispatch_instruction (sregs)
 		  ((sregs->frs2 >> 1) == (rd >> 1)))
 		sregs->fhold += (sregs->ftime - sregs->simtime);
 	    }
-	  mexc = ms->memory_read (address, ddata, &ws);
+	  mexc = tlb_read (sregs, address, ddata, &ws);
 	  sregs->hold += ws;
-	  mexc |= ms->memory_read (address + 4, &ddata[1], &ws);
+	  mexc |= tlb_read (sregs, address + 4, &ddata[1], &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_LDD;
 	  if (mexc)
@@ -1252,9 +1352,6 @@ sparc_dispatch_instruction (sregs)
 	      rd ^= 1;
 #endif
 	      sregs->fsi[rd] = ddata[0];
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	      sregs->nload++;	/* Double load counts twice */
-#endif
 	      rd ^= 1;
 	      sregs->fsi[rd] = ddata[1];
 	      sregs->ltime = sregs->simtime + sregs->icnt + FLSTHOLD +
@@ -1278,7 +1375,7 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_read (address, &data, &ws);
+	  mexc = tlb_read (sregs, address, &data, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1286,6 +1383,7 @@ sparc_dispatch_instruction (sregs)
 	    }
 	  else
 	    {
+	      sparc_sync_accex ();
 	      sregs->fsr = (sregs->fsr & 0x7FF000) | (data & ~0x7FF000);
 	      sparc_set_fsr (sregs->fsr);
 	    }
@@ -1305,7 +1403,8 @@ sparc_dispatch_instruction (sregs)
 	    {
 	      sregs->fhold += (sregs->ftime - sregs->simtime);
 	    }
-	  mexc = ms->memory_write (address, &sregs->fsr, 2, &ws);
+	  sparc_sync_accex ();
+	  mexc = tlb_write (sregs, address, &sregs->fsr, 2, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1332,7 +1431,7 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_write (address, rdd, 2, &ws);
+	  mexc = tlb_write (sregs, address, rdd, 2, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1344,7 +1443,7 @@ sparc_dispatch_instruction (sregs)
 	    break;
 	  /* fall through to STB */
 	case STB:
-	  mexc = ms->memory_write (address, rdd, 0, &ws);
+	  mexc = tlb_write (sregs, address, rdd, 0, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1368,12 +1467,9 @@ sparc_dispatch_instruction (sregs)
 	      else
 		rdd = &(sregs->g[rd]);
 	    }
-	  mexc = ms->memory_write (address, rdd, 3, &ws);
+	  mexc = tlb_write (sregs, address, rdd, 3, &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_STD;
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;	/* Double store counts twice */
-#endif
 	  if (mexc)
 	    {
 	      sregs->trap = TRAP_DEXC;
@@ -1402,12 +1498,9 @@ sparc_dispatch_instruction (sregs)
 	      break;
 	    }
 	  rdd = &(sregs->fpq[0]);
-	  mexc = ms->memory_write (address, rdd, 3, &ws);
+	  mexc = tlb_write (sregs, address, rdd, 3, &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_STD;
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;	/* Double store counts twice */
-#endif
 	  if (mexc)
 	    {
 	      sregs->trap = TRAP_DEXC;
@@ -1428,7 +1521,7 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_write (address, rdd, 1, &ws);
+	  mexc = tlb_write (sregs, address, rdd, 1, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1455,7 +1548,7 @@ sparc_dispatch_instruction (sregs)
 	  rd ^= 1;
 #endif
 	  mexc =
-	    ms->memory_write (address, (uint32 *) & sregs->fsi[rd], 2, &ws);
+	    tlb_write (sregs, address, (uint32 *) & sregs->fsi[rd], 2, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1486,12 +1579,9 @@ sparc_dispatch_instruction (sregs)
 	  ddata[0] = sregs->fsi[rd];
 	  ddata[1] = sregs->fsi[rd ^ 1];
 #endif
-	  mexc = ms->memory_write (address, ddata, 3, &ws);
+	  mexc = tlb_write (sregs, address, ddata, 3, &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_STD;
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nstore++;	/* Double store counts twice */
-#endif
 	  if (mexc)
 	    {
 	      sregs->trap = TRAP_DEXC;
@@ -1506,14 +1596,22 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_read (address, &data, &ws);
+	  mp_xcpu = 1;
+	  if (mt_running && (p = mt_word (sregs, address, &ws)))
+	    {
+	      *rdd = __atomic_exchange_n (p, *rdd, __ATOMIC_SEQ_CST);
+	      sregs->hold += ws;
+	      sregs->icnt = T_LDST;
+	      break;
+	    }
+	  mexc = tlb_read (sregs, address, &data, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
 	      sregs->trap = TRAP_DEXC;
 	      break;
 	    }
-	  mexc = ms->memory_write (address, rdd, 2, &ws);
+	  mexc = tlb_write (sregs, address, rdd, 2, &ws);
 	  sregs->hold += ws;
 	  sregs->icnt = T_LDST;
 	  if (mexc)
@@ -1523,9 +1621,6 @@ sparc_dispatch_instruction (sregs)
 	    }
 	  else
 	    *rdd = data;
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nload++;
-#endif
 	  break;
 	case CASA:
 	  asi = (sregs->inst >> 5) & 0x0ff;
@@ -1538,7 +1633,18 @@ sparc_dispatch_instruction (sregs)
 	      sregs->trap = TRAP_UNALI;
 	      break;
 	    }
-	  mexc = ms->memory_read (address, &data, &ws);
+	  mp_xcpu = 1;
+	  if (mt_running && (p = mt_word (sregs, address, &ws)))
+	    {
+	      data = operand2;
+	      __atomic_compare_exchange_n (p, &data, *rdd, 0,
+					   __ATOMIC_SEQ_CST,
+					   __ATOMIC_SEQ_CST);
+	      *rdd = data;
+	      sregs->hold += ws;
+	      break;
+	    }
+	  mexc = tlb_read (sregs, address, &data, &ws);
 	  sregs->hold += ws;
 	  if (mexc)
 	    {
@@ -1547,7 +1653,7 @@ sparc_dispatch_instruction (sregs)
 	    }
 	  if (data == operand2)
 	    {
-	      mexc = ms->memory_write (address, rdd, 2, &ws);
+	      mexc = tlb_write (sregs, address, rdd, 2, &ws);
 	      if (mexc)
 		{
 		  sregs->trap = TRAP_DEXC;
@@ -1558,9 +1664,6 @@ sparc_dispatch_instruction (sregs)
 	    }
 	  else
 	    *rdd = data;
-#if defined(STAT) || defined(ENABLE_L1CACHE)
-	  sregs->nload++;
-#endif
 	  break;
 
 	default:
@@ -1579,8 +1682,7 @@ sparc_dispatch_instruction (sregs)
 				 * last */
 	}
 #endif
-#ifdef ENABLE_L1CACHE
-      if (ncpu > 1)
+      if (l1cache && (ncpu > 1))
 	{
 	  l1data_update (address, sregs->cpu);
 	  if (op3 & 4)
@@ -1588,7 +1690,6 @@ sparc_dispatch_instruction (sregs)
 	      l1data_snoop (address, sregs->cpu);
 	    }
 	}
-#endif
       break;
 
     default:
@@ -1607,6 +1708,10 @@ sparc_dispatch_instruction (sregs)
 	  sregs->icnt += 1;
 	}
     }
+#ifdef THREADED_DISPATCH
+  if (sregs->tdleft && td_next (sregs, ipc))
+    goto td_start;
+#endif
   return 0;
 }
 
@@ -1657,6 +1762,214 @@ sparc_get_accex ()
   return accx;
 }
 
+/* Unless -fpexact is given, FPops that cannot trap leave the host
+   exception flags to accumulate while no IEEE trap is enabled in the
+   FSR.  The flags are folded into aexc of the core that raised them
+   when the FSR is accessed, a trap is enabled, another core uses the
+   FPU, or the simulation stops.  cexc only holds the exceptions of
+   the last FPop, so that one is recorded with its operands and run
+   again on the host at that point. */
+
+static __thread struct pstate *accex_owner;	/* core with pending host flags */
+
+static __thread struct
+{
+  uint32 opf;
+  uint32 rs1, rs2;		/* single register within src[] */
+  float64 src[2];		/* register pairs of rs1 and rs2 */
+} accex_last;
+
+/* FPops that do not trap unless an IEEE trap is enabled, see
+   fpexec () for square roots */
+
+static int
+sparc_fplazy (struct pstate *sregs, uint32 opf, uint32 rs2)
+{
+  switch (opf)
+    {
+    case FSQRTs:
+      return !signbit (sregs->fs[rs2]);
+    case FSQRTd:
+      return !signbit (sregs->fd[rs2 >> 1]);
+    case FABSs:
+    case FADDs:
+    case FADDd:
+    case FCMPs:
+    case FCMPd:
+    case FDIVs:
+    case FDIVd:
+    case FMOVs:
+    case FMULs:
+    case FMULd:
+    case FNEGs:
+    case FSUBs:
+    case FSUBd:
+    case FdTOi:
+    case FdTOs:
+    case FiTOs:
+    case FiTOd:
+    case FsTOi:
+    case FsTOd:
+      return 1;
+    case FsMULd:
+      return cputype != CPU_ERC32;
+    default:
+      return 0;
+    }
+}
+
+/* Host exceptions of the last recorded FPop, the same expressions as
+   in fpexec () */
+
+static uint32
+sparc_last_cexc (void)
+{
+  float32 *fs = (float32 *) accex_last.src;
+  int32 *fsi = (int32 *) accex_last.src;
+  float32 s1 = fs[accex_last.rs1], s2 = fs[2 + accex_last.rs2];
+  float64 d1 = accex_last.src[0], d2 = accex_last.src[1];
+  volatile float32 rs;
+  volatile float64 rd;
+  volatile int32 ri;
+
+  clear_accex ();
+  switch (accex_last.opf)
+    {
+    case FADDs:
+      rs = s1 + s2;
+      break;
+    case FADDd:
+      rd = d1 + d2;
+      break;
+    case FCMPs:
+      ri = (s1 == s2) ? 3 : (s1 < s2) ? 2 : (s1 > s2) ? 1 : 0;
+      break;
+    case FCMPd:
+      ri = (d1 == d2) ? 3 : (d1 < d2) ? 2 : (d1 > d2) ? 1 : 0;
+      break;
+    case FDIVs:
+      rs = s1 / s2;
+      break;
+    case FDIVd:
+      rd = d1 / d2;
+      break;
+    case FMULs:
+      rs = s1 * s2;
+      break;
+    case FsMULd:
+      rd = (double) s1 * (double) s2;
+      break;
+    case FMULd:
+      rd = d1 * d2;
+      break;
+    case FSQRTs:
+      if (!(s2 < 0.0))
+	rs = sqrtf (s2);
+      break;
+    case FSQRTd:
+      if (!(d2 < 0.0))
+	rd = sqrt (d2);
+      break;
+    case FSUBs:
+      rs = s1 - s2;
+      break;
+    case FSUBd:
+      rd = d1 - d2;
+      break;
+    case FdTOi:
+      ri = (int) d2;
+      break;
+    case FdTOs:
+      rs = (float32) d2;
+      break;
+    case FiTOs:
+      rs = (float32) fsi[2 + accex_last.rs2];
+      break;
+    case FsTOi:
+      ri = (int) s2;
+      break;
+    case FsTOd:
+      rd = s2;
+      break;
+    }
+  (void) rs;
+  (void) rd;
+  (void) ri;
+  return sparc_get_accex ();
+}
+
+void
+sparc_sync_accex (void)
+{
+  uint32 accex, cexc;
+
+  if (accex_owner == NULL)
+    return;
+  accex = sparc_get_accex ();
+  sparc_set_fsr (accex_owner->fsr);
+  cexc = sparc_last_cexc ();
+  accex_owner->fsr = ((((accex_owner->fsr >> 5) | accex) << 5) | cexc);
+  clear_accex ();
+  accex_owner = NULL;
+}
+
+/* Results that host SSE does not give as a SPARC FPU would.  NaN
+   operands: SSE returns the first one, quieted; SPARC prefers a
+   signaling NaN in rs2, then one in rs1, then a quiet NaN in rs2.
+   Invalid operations: the SSE default NaN is 0xffc00000, the SPARC
+   one 0x7fffffff.  Integer overflow: SSE returns 0x80000000, SPARC
+   0x7fffffff for NaN and positive values. */
+
+static float32
+sparc_nan_s (float32 a, float32 b)
+{
+  uint32 x, y, r;
+
+  memcpy (&x, &a, 4);
+  memcpy (&y, &b, 4);
+  if (((y & 0x7fc00000) == 0x7f800000) && (y & 0x003fffff))
+    r = y | 0x00400000;
+  else if (((x & 0x7fc00000) == 0x7f800000) && (x & 0x003fffff))
+    r = x | 0x00400000;
+  else if ((y & 0x7fffffff) > 0x7f800000)
+    r = y;
+  else if ((x & 0x7fffffff) > 0x7f800000)
+    r = x;
+  else
+    r = 0x7fffffff;
+  memcpy (&a, &r, 4);
+  return a;
+}
+
+static float64
+sparc_nan_d (float64 a, float64 b)
+{
+  uint64 x, y, r;
+
+  memcpy (&x, &a, 8);
+  memcpy (&y, &b, 8);
+  if (((y & 0x7ff8000000000000ULL) == 0x7ff0000000000000ULL)
+      && (y & 0x0007ffffffffffffULL))
+    r = y | 0x0008000000000000ULL;
+  else if (((x & 0x7ff8000000000000ULL) == 0x7ff0000000000000ULL)
+	   && (x & 0x0007ffffffffffffULL))
+    r = x | 0x0008000000000000ULL;
+  else if ((y & 0x7fffffffffffffffULL) > 0x7ff0000000000000ULL)
+    r = y;
+  else if ((x & 0x7fffffffffffffffULL) > 0x7ff0000000000000ULL)
+    r = x;
+  else
+    r = 0x7fffffffffffffffULL;
+  memcpy (&a, &r, 8);
+  return a;
+}
+
+static int32
+sparc_toi (int32 r, int neg)
+{
+  return ((r == (int32) 0x80000000) && !neg) ? 0x7fffffff : r;
+}
+
 static int
 fpexec (op3, rd, rs1, rs2, sregs)
      uint32 op3, rd, rs1, rs2;
@@ -1665,6 +1978,9 @@ fpexec (op3, rd, rs1, rs2, sregs)
   uint32 opf, tem, accex;
   int32 fcc;
   uint32 ldadj;
+  int lazy;
+  float32 fs;
+  float64 fd;
 
   if (sregs->fpstate == FP_EXC_MODE)
     {
@@ -1727,7 +2043,23 @@ fpexec (op3, rd, rs1, rs2, sregs)
 
   sregs->ftime = sregs->simtime + sregs->hold + sregs->fhold;
 
-  clear_accex ();
+  lazy = !fpexact && !(sregs->fsr & FSR_TEM) && sparc_fplazy (sregs, opf, rs2);
+  if (!lazy || (accex_owner != sregs))
+    {
+      sparc_sync_accex ();
+      clear_accex ();
+      if (lazy)
+	accex_owner = sregs;
+    }
+  sparc_set_fsr (sregs->fsr);
+  if (lazy)
+    {
+      accex_last.opf = opf;
+      accex_last.rs1 = rs1 & 1;
+      accex_last.rs2 = rs2 & 1;
+      accex_last.src[0] = sregs->fd[rs1 >> 1];
+      accex_last.src[1] = sregs->fd[rs2 >> 1];
+    }
 
   switch (opf)
     {
@@ -1737,11 +2069,17 @@ fpexec (op3, rd, rs1, rs2, sregs)
       sregs->frs1 = 32;		/* rs1 ignored */
       break;
     case FADDs:
-      sregs->fs[rd] = sregs->fs[rs1] + sregs->fs[rs2];
+      fs = sregs->fs[rs1] + sregs->fs[rs2];
+      if (fs != fs)
+	fs = sparc_nan_s (sregs->fs[rs1], sregs->fs[rs2]);
+      sregs->fs[rd] = fs;
       sregs->ftime += T_FADDs;
       break;
     case FADDd:
-      sregs->fd[rd >> 1] = sregs->fd[rs1 >> 1] + sregs->fd[rs2 >> 1];
+      fd = sregs->fd[rs1 >> 1] + sregs->fd[rs2 >> 1];
+      if (fd != fd)
+	fd = sparc_nan_d (sregs->fd[rs1 >> 1], sregs->fd[rs2 >> 1]);
+      sregs->fd[rd >> 1] = fd;
       sregs->ftime += T_FADDd;
       break;
     case FCMPs:
@@ -1785,11 +2123,17 @@ fpexec (op3, rd, rs1, rs2, sregs)
 	}
       break;
     case FDIVs:
-      sregs->fs[rd] = sregs->fs[rs1] / sregs->fs[rs2];
+      fs = sregs->fs[rs1] / sregs->fs[rs2];
+      if (fs != fs)
+	fs = sparc_nan_s (sregs->fs[rs1], sregs->fs[rs2]);
+      sregs->fs[rd] = fs;
       sregs->ftime += T_FDIVs;
       break;
     case FDIVd:
-      sregs->fd[rd >> 1] = sregs->fd[rs1 >> 1] / sregs->fd[rs2 >> 1];
+      fd = sregs->fd[rs1 >> 1] / sregs->fd[rs2 >> 1];
+      if (fd != fd)
+	fd = sparc_nan_d (sregs->fd[rs1 >> 1], sregs->fd[rs2 >> 1]);
+      sregs->fd[rd >> 1] = fd;
       sregs->ftime += T_FDIVd;
       break;
     case FMOVs:
@@ -1798,14 +2142,20 @@ fpexec (op3, rd, rs1, rs2, sregs)
       sregs->frs1 = 32;		/* rs1 ignored */
       break;
     case FMULs:
-      sregs->fs[rd] = sregs->fs[rs1] * sregs->fs[rs2];
+      fs = sregs->fs[rs1] * sregs->fs[rs2];
+      if (fs != fs)
+	fs = sparc_nan_s (sregs->fs[rs1], sregs->fs[rs2]);
+      sregs->fs[rd] = fs;
       sregs->ftime += T_FMULs;
       break;
     case FsMULd:
       if (cputype != CPU_ERC32)
 	{			/* FSMULD only supported for LEON3 */
-	  sregs->fd[rd >> 1] =
-	    (double) sregs->fs[rs1] * (double) sregs->fs[rs2];
+	  fd = (double) sregs->fs[rs1] * (double) sregs->fs[rs2];
+	  if (fd != fd)
+	    fd = sparc_nan_d ((double) sregs->fs[rs1],
+			      (double) sregs->fs[rs2]);
+	  sregs->fd[rd >> 1] = fd;
 	  sregs->ftime += T_FMULd;
 	}
       else
@@ -1815,7 +2165,10 @@ fpexec (op3, rd, rs1, rs2, sregs)
 	}
       break;
     case FMULd:
-      sregs->fd[rd >> 1] = sregs->fd[rs1 >> 1] * sregs->fd[rs2 >> 1];
+      fd = sregs->fd[rs1 >> 1] * sregs->fd[rs2 >> 1];
+      if (fd != fd)
+	fd = sparc_nan_d (sregs->fd[rs1 >> 1], sregs->fd[rs2 >> 1]);
+      sregs->fd[rd >> 1] = fd;
       sregs->ftime += T_FMULd;
       break;
     case FNEGs:
@@ -1848,15 +2201,22 @@ fpexec (op3, rd, rs1, rs2, sregs)
       sregs->frs1 = 32;		/* rs1 ignored */
       break;
     case FSUBs:
-      sregs->fs[rd] = sregs->fs[rs1] - sregs->fs[rs2];
+      fs = sregs->fs[rs1] - sregs->fs[rs2];
+      if (fs != fs)
+	fs = sparc_nan_s (sregs->fs[rs1], sregs->fs[rs2]);
+      sregs->fs[rd] = fs;
       sregs->ftime += T_FSUBs;
       break;
     case FSUBd:
-      sregs->fd[rd >> 1] = sregs->fd[rs1 >> 1] - sregs->fd[rs2 >> 1];
+      fd = sregs->fd[rs1 >> 1] - sregs->fd[rs2 >> 1];
+      if (fd != fd)
+	fd = sparc_nan_d (sregs->fd[rs1 >> 1], sregs->fd[rs2 >> 1]);
+      sregs->fd[rd >> 1] = fd;
       sregs->ftime += T_FSUBd;
       break;
     case FdTOi:
-      sregs->fsi[rd] = (int) sregs->fd[rs2 >> 1];
+      sregs->fsi[rd] = sparc_toi ((int) sregs->fd[rs2 >> 1],
+				  sregs->fd[rs2 >> 1] < 0.0);
       sregs->ftime += T_FdTOi;
       sregs->frs1 = 32;		/* rs1 ignored */
       break;
@@ -1876,7 +2236,7 @@ fpexec (op3, rd, rs1, rs2, sregs)
       sregs->frs1 = 32;		/* rs1 ignored */
       break;
     case FsTOi:
-      sregs->fsi[rd] = (int) sregs->fs[rs2];
+      sregs->fsi[rd] = sparc_toi ((int) sregs->fs[rs2], sregs->fs[rs2] < 0.0);
       sregs->ftime += T_FsTOi;
       sregs->frs1 = 32;		/* rs1 ignored */
       break;
@@ -1902,16 +2262,15 @@ fpexec (op3, rd, rs1, rs2, sregs)
     }
 #endif
 
-  accex = sparc_get_accex ();
-
   if (sregs->fpstate == FP_EXC_PE)
     {
       sregs->fpq[0] = sregs->pc;
       sregs->fpq[1] = sregs->inst;
       sregs->fsr |= FSR_QNE;
     }
-  else
+  else if (!lazy)
     {
+      accex = sparc_get_accex ();
       tem = (sregs->fsr >> 23) & 0x1f;
       if (tem & accex)
 	{
@@ -1930,7 +2289,8 @@ fpexec (op3, rd, rs1, rs2, sregs)
 	  sregs->fsr |= FSR_QNE;
 	}
     }
-  clear_accex ();
+  if (!lazy)
+    clear_accex ();
 
   return 0;
 
@@ -2041,6 +2401,7 @@ sparc_disp_regs (struct pstate *sregs, int cwp)
 static void
 sparc_display_registers (struct pstate *sregs)
 {
+  SYNC_CC (sregs);
   sparc_disp_regs (sregs, sregs->psr);
 }
 
@@ -2050,6 +2411,7 @@ sparc_display_ctrl (struct pstate *sregs)
 
   uint32 i;
 
+  SYNC_CC (sregs);
   printf ("\n psr: %08X   wim: %08X   tbr: %08X   y: %08X\n",
 	  sregs->psr, sregs->wim, sregs->tbr, sregs->y);
   ms->sis_memory_read (sregs->pc, (char *) &i, 4);
@@ -2107,6 +2469,7 @@ sparc_set_regi (sregs, reg, rval)
 	  sregs->y = rval;
 	  break;
 	case 65:
+	  SYNC_CC (sregs);
 	  sregs->psr = rval;
 	  break;
 	case 66:
@@ -2123,6 +2486,7 @@ sparc_set_regi (sregs, reg, rval)
 	  sregs->npc = rval;
 	  break;
 	case 70:
+	  sparc_sync_accex ();
 	  sregs->fsr = rval;
 	  sparc_set_fsr (rval);
 	  break;
@@ -2162,6 +2526,7 @@ sparc_get_regi (struct pstate *sregs, int32 reg, char *buf, int length)
 	  rval = sregs->y;
 	  break;
 	case 65:
+	  SYNC_CC (sregs);
 	  rval = sregs->psr;
 	  break;
 	case 66:
@@ -2177,6 +2542,7 @@ sparc_get_regi (struct pstate *sregs, int32 reg, char *buf, int length)
 	  rval = sregs->npc;
 	  break;
 	case 70:
+	  sparc_sync_accex ();
 	  rval = sregs->fsr;
 	  break;
 	default:
@@ -2196,6 +2562,7 @@ sparc_set_rega (struct pstate *sregs, char *reg, uint32 rval)
   int32 err = 0;
 
   cwp = ((sregs->psr & 0x7) << 4);
+  SYNC_CC (sregs);
   if (strcmp (reg, "psr") == 0)
     sregs->psr = (rval = (rval & 0x00f03fff));
   else if (strcmp (reg, "tbr") == 0)
@@ -2210,6 +2577,7 @@ sparc_set_rega (struct pstate *sregs, char *reg, uint32 rval)
     sregs->npc = rval;
   else if (strcmp (reg, "fsr") == 0)
     {
+      sparc_sync_accex ();
       sregs->fsr = rval;
       sparc_set_fsr (rval);
     }
@@ -2366,6 +2734,7 @@ sparc_display_fpu (struct pstate *sregs)
 {
   int i, t;
 
+  sparc_sync_accex ();
   printf ("\n fsr: %08X\n\n", sregs->fsr);
 
   for (i = 0; i < 32; i++)
@@ -3534,20 +3903,1045 @@ sparc_print_insn (uint32 addr)
   printf (" %s", tmp);
 }
 
-const struct cpu_arch sparc32 = {
-#ifdef HOST_LITTLE_ENDIAN
-  3,
-#else
-  0,
-#endif
-  sparc_dispatch_instruction,
-  sparc_execute_trap,
-  sparc_check_interrupts,
-  sparc_print_insn,
-  sparc_gdb_get_reg,
-  sparc_set_register,
-  sparc_display_registers,
-  sparc_display_ctrl,
-  sparc_display_special,
-  sparc_display_fpu
+/* Extract the instruction fields used by sparc_dispatch_instruction */
+
+static void
+sparc_predecode (struct pdinst *pd)
+{
+  uint32 inst = pd->inst;
+
+  pd->op = inst >> 30;
+  pd->rd = (inst >> 25) & 0x1f;
+  pd->rs1 = (inst >> 14) & 0x1f;
+  pd->rs2 = inst & INST_RS2;
+  pd->len = 4;
+  switch (pd->op)
+    {
+    case 0:
+      pd->fn = (inst >> 22) & 0x7;
+      if (pd->fn == SETHI)
+	pd->imm = inst << 10;
+      else
+	{
+	  pd->imm = ((int32) (inst << 10)) >> 8;	/* sign extend disp22 */
+	  pd->flags |= PD_BLKEND | PD_DELAY;
+	  if ((pd->fn == BICC) || (pd->fn == FPBCC))
+	    pd->flags |= PD_BRANCH;
+	}
+      break;
+    case 1:
+      pd->fn = 0;
+      pd->imm = inst << 2;	/* disp30 */
+      pd->flags |= PD_BLKEND | PD_DELAY | PD_BRANCH;
+      break;
+    default:
+      pd->fn = (inst >> 19) & 0x3f;
+      if (inst & INST_I)
+	pd->flags |= PD_IMM;
+      if ((pd->op == 2) && ((pd->fn == JMPL) || (pd->fn == RETT)))
+	pd->flags |= PD_BLKEND | PD_DELAY;
+      else if ((pd->op == 2) && (pd->fn == TICC))
+	pd->flags |= PD_BLKEND;
+      if ((pd->op == 2) && (pd->fn == JMPL))
+	pd->flags |= PD_BRANCH;
+      if (pd->op == 3)
+	{
+	  /* atomics count as a load and a store */
+	  if (pd->fn & 4)
+	    pd->flags |= PD_STORE;
+	  if (!(pd->fn & 4) || (pd->fn == LDSTUB) || (pd->fn == LDSTUBA)
+	      || (pd->fn == SWAP) || (pd->fn == SWAPA) || (pd->fn == CASA))
+	    pd->flags |= PD_LOAD;
+	  if ((pd->fn == LDD) || (pd->fn == LDDA) || (pd->fn == LDDF)
+	      || (pd->fn == STD) || (pd->fn == STDA) || (pd->fn == STDFQ)
+	      || (pd->fn == STDF))
+	    pd->flags |= PD_DOUBLE;
+	}
+      pd->imm = ((int32) (inst << 19)) >> 19;	/* sign extend simm13 */
+      break;
+    }
+  pd->hx = (pd->op << 6) | pd->fn;
+}
+
+/* Threaded-code handlers for translated blocks (see jit_run).  Each
+   performs one instruction exactly as sparc_dispatch_instruction
+   does, or returns JIT_LEAVE where that would trap or take the slow
+   path.  SAVE and RESTORE change the window inside a block, so
+   windowed registers are resolved on each access.  Immediate operands
+   are given with rs2 = 0 and register operands with imm = 0, so that
+   operand2 is always JIT_REG (op->rs2) + op->imm. */
+
+#define JIT_REG(n) (*((n) > 7 ? \
+	&sregs->r[(((sregs->psr & PSR_CWP) << 4) + (n)) & 0x7f] : \
+	&sregs->g[n]))
+
+#define JIT_ADDR	(JIT_REG (op->rs1) + JIT_REG (op->rs2) + op->imm)
+#define JIT_LEAVE	(JIT_EXIT | (op->idx << 22))
+
+#define JIT_OP(name, expr) \
+static uint32 \
+jit_##name (struct pstate *sregs, const struct jitop *op) \
+{ \
+  uint32 rs1 = JIT_REG (op->rs1), operand2 = JIT_REG (op->rs2) + op->imm; \
+ \
+  JIT_REG (op->rd) = (expr); \
+  return 0; \
+}
+
+/* Condition code setting variants; rd may be %g0 here */
+
+#define JIT_OPCC(name, expr, cc) \
+static uint32 \
+jit_##name (struct pstate *sregs, const struct jitop *op) \
+{ \
+  uint32 rs1 = JIT_REG (op->rs1), operand2 = JIT_REG (op->rs2) + op->imm; \
+  uint32 result = (expr); \
+ \
+  cc; \
+  if (op->rd) \
+    JIT_REG (op->rd) = result; \
+  return 0; \
+}
+
+#define JIT_CARRY	(SYNC_CC (sregs), (sregs->psr >> 20) & 1)
+#define JIT_ADDCC	SET_CC (sregs, CC_ADD, rs1, operand2, result)
+#define JIT_SUBCC	SET_CC (sregs, CC_SUB, rs1, operand2, result)
+#define JIT_LOGCC	SET_CC (sregs, CC_LOG, 0, 0, result)
+
+JIT_OP (add, rs1 + operand2)
+JIT_OP (addx, rs1 + operand2 + JIT_CARRY)
+JIT_OP (sub, rs1 - operand2)
+JIT_OP (subx, rs1 - operand2 - JIT_CARRY)
+JIT_OP (and, rs1 & operand2)
+JIT_OP (andn, rs1 & ~operand2)
+JIT_OP (or, rs1 | operand2)
+JIT_OP (orn, rs1 | ~operand2)
+JIT_OP (xor, rs1 ^ operand2)
+JIT_OP (xnor, rs1 ^ ~operand2)
+JIT_OP (sll, rs1 << (operand2 & 0x1f))
+JIT_OP (srl, rs1 >> (operand2 & 0x1f))
+JIT_OP (sra, ((int) rs1) >> (operand2 & 0x1f))
+JIT_OPCC (addcc, rs1 + operand2, JIT_ADDCC)
+JIT_OPCC (addxcc, rs1 + operand2 + JIT_CARRY, JIT_ADDCC)
+JIT_OPCC (subcc, rs1 - operand2, JIT_SUBCC)
+JIT_OPCC (subxcc, rs1 - operand2 - JIT_CARRY, JIT_SUBCC)
+JIT_OPCC (andcc, rs1 & operand2, JIT_LOGCC)
+JIT_OPCC (andncc, rs1 & ~operand2, JIT_LOGCC)
+JIT_OPCC (orcc, rs1 | operand2, JIT_LOGCC)
+JIT_OPCC (orncc, rs1 | ~operand2, JIT_LOGCC)
+JIT_OPCC (xorcc, rs1 ^ operand2, JIT_LOGCC)
+JIT_OPCC (xnorcc, rs1 ^ ~operand2, JIT_LOGCC)
+
+static uint32
+jit_sethi (struct pstate *sregs, const struct jitop *op)
+{
+  JIT_REG (op->rd) = op->imm;
+  return 0;
+}
+
+/* Multiplies also write %y, so they run even with rd = %g0 */
+
+static uint32
+jit_mul (struct pstate *sregs, const struct jitop *op)
+{
+  uint32 rs1 = JIT_REG (op->rs1), operand2 = JIT_REG (op->rs2) + op->imm;
+  uint32 result;
+
+  mul64 (rs1, operand2, &sregs->y, &result, op->addr & 1);
+  if (op->addr & 2)
+    {
+      SYNC_CC (sregs);
+      if (result & 0x80000000)
+	sregs->psr |= PSR_N;
+      else
+	sregs->psr &= ~PSR_N;
+
+      if (result == 0)
+	sregs->psr |= PSR_Z;
+      else
+	sregs->psr &= ~PSR_Z;
+    }
+  if (op->rd)
+    JIT_REG (op->rd) = result;
+  return 0;
+}
+
+static uint32
+jit_rdy (struct pstate *sregs, const struct jitop *op)
+{
+  JIT_REG (op->rd) = sregs->y;
+  return 0;
+}
+
+static uint32
+jit_wry (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->y = JIT_REG (op->rs1) ^ (JIT_REG (op->rs2) + op->imm);
+  return 0;
+}
+
+/* Loads and stores go through the TLB only, and leave misaligned
+   addresses, misses and pages with predecoded code to the interpreter.
+   They return the waitstates of the access. */
+
+#define JIT_LOAD(name, align, expr) \
+static uint32 \
+jit_##name (struct pstate *sregs, const struct jitop *op) \
+{ \
+  uint32 address = JIT_ADDR, data; \
+  struct tlbent *e; \
+ \
+  if ((address & (align)) || !(e = jit_tlb_read (sregs, address & ~3))) \
+    return JIT_LEAVE; \
+  memcpy (&data, &e->mem[address & (TLB_PAGESIZE - 4)], 4); \
+  if (op->rd) \
+    JIT_REG (op->rd) = (expr); \
+  return e->rws; \
+}
+
+JIT_LOAD (ld, 3, data)
+JIT_LOAD (ldub, 0, extract_byte (data, address))
+JIT_LOAD (ldsb, 0, extract_byte_signed (data, address))
+JIT_LOAD (lduh, 1, extract_short (data, address))
+JIT_LOAD (ldsh, 1, extract_short_signed (data, address))
+
+static uint32
+jit_ldd (struct pstate *sregs, const struct jitop *op)
+{
+  uint32 address = JIT_ADDR, data[2];
+  struct tlbent *e;
+
+  if ((address & 7) || !(e = jit_tlb_read (sregs, address))
+      || ((2 * e->rws) > JIT_MAXWS))
+    return JIT_LEAVE;
+  memcpy (data, &e->mem[address & (TLB_PAGESIZE - 8)], 8);
+  if (op->rd & 0x1e)
+    JIT_REG (op->rd & 0x1e) = data[0];
+  JIT_REG (op->rd | 1) = data[1];
+  return 2 * e->rws;
+}
+
+#define JIT_STORE(name, sz, expr) \
+static uint32 \
+jit_##name (struct pstate *sregs, const struct jitop *op) \
+{ \
+  uint32 address = JIT_ADDR, off = address & (TLB_PAGESIZE - 1); \
+  struct tlbent *e = jit_tlb_write (sregs, address, sz); \
+ \
+  if (e == NULL) \
+    return JIT_LEAVE; \
+  expr; \
+  return e->wws[sz]; \
+}
+
+JIT_STORE (st, 2, memcpy (&e->mem[off], &JIT_REG (op->rd), 4))
+JIT_STORE (stb, 0, e->mem[off ^ arch->bswap] = JIT_REG (op->rd))
+JIT_STORE (sth, 1, *((uint16 *) & e->mem[off ^ (arch->bswap & 2)]) =
+	   JIT_REG (op->rd))
+JIT_STORE (std, 3, memcpy (&e->mem[off], &JIT_REG (op->rd & 0x1e), 8))
+
+/* SAVE and RESTORE add in the old window and write rd in the new */
+
+static inline uint32
+jit_window (struct pstate *sregs, const struct jitop *op, uint32 new_cwp)
+{
+  uint32 result = JIT_ADDR;
+
+  if (sregs->wim & (1 << new_cwp))
+    return JIT_LEAVE;
+  sregs->psr = (sregs->psr & ~PSR_CWP) | new_cwp;
+  if (op->rd)
+    JIT_REG (op->rd) = result;
+  return 0;
+}
+
+static uint32
+jit_save (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_window (sregs, op, ((sregs->psr & PSR_CWP) - 1) & PSR_CWP);
+}
+
+static uint32
+jit_restore (struct pstate *sregs, const struct jitop *op)
+{
+  return jit_window (sregs, op, ((sregs->psr & PSR_CWP) + 1) & PSR_CWP);
+}
+
+/* Bicc condition cond on the current icc, for jit_bicc and for host
+   code that does not know how icc was last set */
+
+static uint32
+sparc_jit_cond (struct pstate *sregs, uint32 cond)
+{
+  uint32 icc;
+  int32 eicc;
+
+  SYNC_CC (sregs);
+  icc = sregs->psr >> 20;
+  switch (cond)
+    {
+    case BICC_BN:
+      eicc = 0;
+      break;
+    case BICC_BE:
+      eicc = ICC_Z;
+      break;
+    case BICC_BLE:
+      eicc = ICC_Z | (ICC_N ^ ICC_V);
+      break;
+    case BICC_BL:
+      eicc = (ICC_N ^ ICC_V);
+      break;
+    case BICC_BLEU:
+      eicc = ICC_C | ICC_Z;
+      break;
+    case BICC_BCS:
+      eicc = ICC_C;
+      break;
+    case BICC_NEG:
+      eicc = ICC_N;
+      break;
+    case BICC_BVS:
+      eicc = ICC_V;
+      break;
+    case BICC_BA:
+      eicc = 1;
+      break;
+    case BICC_BNE:
+      eicc = ~(ICC_Z);
+      break;
+    case BICC_BG:
+      eicc = ~(ICC_Z | (ICC_N ^ ICC_V));
+      break;
+    case BICC_BGE:
+      eicc = ~(ICC_N ^ ICC_V);
+      break;
+    case BICC_BGU:
+      eicc = ~(ICC_C | ICC_Z);
+      break;
+    case BICC_BCC:
+      eicc = ~(ICC_C);
+      break;
+    case BICC_POS:
+      eicc = ~(ICC_N);
+      break;
+    default:			/* BICC_BVC */
+      eicc = ~(ICC_V);
+      break;
+    }
+  return eicc & 1;
+}
+
+/* Control transfers run their delay slot, kept in op[1], unless it
+   is annulled; imm holds the target.  A slot that leaves the block
+   does so after the transfer, see jit_run. */
+
+static uint32
+jit_bicc (struct pstate *sregs, const struct jitop *op)
+{
+  if (sparc_jit_cond (sregs, op->rs1))
+    {
+      sregs->pc = op->imm;
+      sregs->npc = op->imm + 4;
+      if (op->rs2 && (op->rs1 == BICC_BA))
+	return JIT_ANNUL | JIT_CYC (1);
+    }
+  else if (op->rs2)
+    return JIT_ANNUL | JIT_CYC (1);
+  return op[1].fn (sregs, &op[1]);
+}
+
+static uint32
+jit_call (struct pstate *sregs, const struct jitop *op)
+{
+  sregs->r[(((sregs->psr & PSR_CWP) << 4) + 15) & 0x7f] = op->addr;
+  sregs->pc = op->imm;
+  sregs->npc = op->imm + 4;
+  return op[1].fn (sregs, &op[1]);
+}
+
+/* The interpreter traps on a misaligned rs1, and the target is left to
+   it when misaligned or null */
+
+static uint32
+jit_jmpl (struct pstate *sregs, const struct jitop *op)
+{
+  uint32 rs1 = JIT_REG (op->rs1), target = JIT_ADDR;
+
+  if (((rs1 | target) & 3) || (target == 0))
+    return JIT_LEAVE;
+  if (op->rd)
+    JIT_REG (op->rd) = op->addr;
+  sregs->pc = target;
+  sregs->npc = target + 4;
+  return op[1].fn (sregs, &op[1]);
+}
+
+/* Map one predecoded instruction at addr to a handler.  Integer ALU
+   operations, multiplies, %y accesses, SETHI, Bicc, CALL, JMPL, SAVE,
+   RESTORE and the integer loads and stores are translated; the FPU,
+   alternate spaces, privileged and data-dependent instructions end
+   the block.  Returns the static cycle count of the instruction,
+   including the interlock on a register loaded by the previous one,
+   or 0 if it cannot be translated. */
+
+static uint32
+sparc_translate (struct pdinst *pd, uint32 addr, struct jitop *op,
+		 uint32 * extra)
+{
+  uint32 icnt = 1;
+  int side = 0;			/* has effects beyond writing rd */
+
+  op->fn = NULL;
+  op->addr = addr;
+  op->rd = pd->rd;
+  op->rs1 = pd->rs1;
+  if (pd->flags & PD_IMM)
+    {
+      op->rs2 = 0;
+      op->imm = pd->imm;
+    }
+  else
+    {
+      op->rs2 = pd->rs2;
+      op->imm = 0;
+    }
+
+  switch (pd->op)
+    {
+    case 0:
+      if (pd->fn == SETHI)
+	{
+	  op->fn = jit_sethi;
+	  op->imm = pd->imm;
+	}
+      else if (pd->fn == BICC)
+	{
+	  op->fn = jit_bicc;
+	  op->imm = addr + pd->imm;
+	  op->rs1 = (pd->inst >> 25) & 0x0f;	/* cond */
+	  op->rs2 = (pd->inst >> 29) & 1;	/* annul */
+	  side = 1;
+	}
+      else
+	return 0;
+      break;
+    case 1:
+      op->fn = jit_call;
+      op->imm = addr + pd->imm;
+      side = 1;
+      break;
+    case 2:
+      side = 1;
+      switch (pd->fn)
+	{
+	case ADD:
+	  op->fn = jit_add;
+	  side = 0;
+	  break;
+	case ADDX:
+	  op->fn = jit_addx;
+	  side = 0;
+	  break;
+	case SUB:
+	  op->fn = jit_sub;
+	  side = 0;
+	  break;
+	case SUBX:
+	  op->fn = jit_subx;
+	  side = 0;
+	  break;
+	case IAND:
+	  op->fn = jit_and;
+	  side = 0;
+	  break;
+	case IANDN:
+	  op->fn = jit_andn;
+	  side = 0;
+	  break;
+	case IOR:
+	  op->fn = jit_or;
+	  side = 0;
+	  break;
+	case IORN:
+	  op->fn = jit_orn;
+	  side = 0;
+	  break;
+	case IXOR:
+	  op->fn = jit_xor;
+	  side = 0;
+	  break;
+	case IXNOR:
+	  op->fn = jit_xnor;
+	  side = 0;
+	  break;
+	case SLL:
+	  op->fn = jit_sll;
+	  side = 0;
+	  break;
+	case SRL:
+	  op->fn = jit_srl;
+	  side = 0;
+	  break;
+	case SRA:
+	  op->fn = jit_sra;
+	  side = 0;
+	  break;
+	case ADDCC:
+	  op->fn = jit_addcc;
+	  break;
+	case ADDXCC:
+	  op->fn = jit_addxcc;
+	  break;
+	case SUBCC:
+	  op->fn = jit_subcc;
+	  break;
+	case SUBXCC:
+	  op->fn = jit_subxcc;
+	  break;
+	case IANDCC:
+	  op->fn = jit_andcc;
+	  break;
+	case IANDNCC:
+	  op->fn = jit_andncc;
+	  break;
+	case IORCC:
+	  op->fn = jit_orcc;
+	  break;
+	case IORNCC:
+	  op->fn = jit_orncc;
+	  break;
+	case IXORCC:
+	  op->fn = jit_xorcc;
+	  break;
+	case IXNORCC:
+	  op->fn = jit_xnorcc;
+	  break;
+	case UMUL:
+	case SMUL:
+	case UMULCC:
+	case SMULCC:
+	  op->fn = jit_mul;
+	  op->addr = ((pd->fn & 1) ? 1 : 0) | ((pd->fn & 0x10) ? 2 : 0);
+	  icnt = T_MUL;
+	  break;
+	case RDY:
+	  if (pd->rs1 != 0)
+	    return 0;
+	  op->fn = jit_rdy;
+	  side = 0;
+	  break;
+	case WRY:
+	  if (pd->rd != 0)
+	    return 0;
+	  op->fn = jit_wry;
+	  break;
+	case SAVE:
+	  op->fn = jit_save;
+	  break;
+	case RESTORE:
+	  op->fn = jit_restore;
+	  break;
+	case JMPL:
+	  op->fn = jit_jmpl;
+	  icnt = T_JMPL;
+	  break;
+	default:
+	  return 0;
+	}
+      break;
+    case 3:
+      side = 1;
+      *extra += JIT_MAXWS;
+      switch (pd->fn)
+	{
+	case LD:
+	  op->fn = jit_ld;
+	  break;
+	case LDUB:
+	  op->fn = jit_ldub;
+	  break;
+	case LDSB:
+	  op->fn = jit_ldsb;
+	  break;
+	case LDUH:
+	  op->fn = jit_lduh;
+	  break;
+	case LDSH:
+	  op->fn = jit_ldsh;
+	  break;
+	case LDD:
+	  op->fn = jit_ldd;
+	  break;
+	case ST:
+	  op->fn = jit_st;
+	  break;
+	case STB:
+	  op->fn = jit_stb;
+	  break;
+	case STH:
+	  op->fn = jit_sth;
+	  break;
+	case STD:
+	  op->fn = jit_std;
+	  break;
+	default:
+	  return 0;
+	}
+      if (pd->fn & 4)
+	icnt = (pd->fn == STD) ? T_STD : T_ST;
+      else
+	{
+	  icnt = (pd->fn == LDD) ? T_LDD : T_LD;
+	  op->lreg = (pd->fn == LDD) ? ((pd->rd & 0x1e) | 1) : pd->rd;
+	}
+      break;
+    default:
+      return 0;
+    }
+
+#ifdef LOAD_DEL
+  if (op->ild && (pd->op & 2) && ((pd->fn & 0x38) != 0x28)
+      && ((pd->fn & 0x3e) != 0x34) && ((op->ild == pd->rs1)
+				       || (!(pd->flags & PD_IMM)
+					   && (op->ild == pd->rs2))))
+    pd->hold++;
+#endif
+
+  /* writes to %g0 have no effect */
+  if (!side && (op->rd == 0))
+    op->fn = NULL;
+  return icnt;
+}
+
+#ifdef JIT_X86
+#include "x86.h"
+
+/* Host code for translated blocks, see x86.h.  r12 points to the
+   registers of the current window and r13 to the same 128 registers
+   lower when it is the last one, so that its ins and locals wrap
+   around; both are set again after SAVE and RESTORE.  The condition
+   codes are left pending as SET_CC does, and Bicc tests them on the
+   host when the block itself set them last. */
+
+#define SX_OFF(field)	((int32) offsetof (struct pstate, field))
+
+/* Memory operand of guest register n */
+
+static void
+sx_reg (uint32 n, int *base, int32 * disp)
+{
+  if (n < 8)
+    {
+      *base = XBX;
+      *disp = SX_OFF (g) + 4 * n;
+    }
+  else
+    {
+      *base = (n < 16) ? X12 : X13;
+      *disp = 4 * n;
+    }
+}
+
+/* Host register h = guest register n */
+
+static void
+sx_get (struct x86 *x, int h, uint32 n)
+{
+  int base;
+  int32 disp;
+
+  if (n == 0)
+    {
+      x86_alu (x, XOP_XOR, h, h);
+      return;
+    }
+  sx_reg (n, &base, &disp);
+  x86_ld (x, 0, h, base, disp);
+}
+
+/* Guest register n = host register h */
+
+static void
+sx_put (struct x86 *x, int h, uint32 n)
+{
+  int base;
+  int32 disp;
+
+  if (n == 0)
+    return;
+  sx_reg (n, &base, &disp);
+  x86_st (x, 0, h, base, disp);
+}
+
+/* eax = rs1, ecx = operand2 */
+
+static void
+sx_operands (struct x86 *x, const struct jitop *op)
+{
+  sx_get (x, XAX, op->rs1);
+  if (op->rs2)
+    sx_get (x, XCX, op->rs2);
+  else
+    x86_movi (x, XCX, op->imm);
+}
+
+/* eax = rs1 + operand2 */
+
+static void
+sx_address (struct x86 *x, const struct jitop *op)
+{
+  sx_get (x, XAX, op->rs1);
+  if (op->rs2)
+    {
+      sx_get (x, XCX, op->rs2);
+      x86_alu (x, XOP_ADD, XAX, XCX);
+    }
+  if (op->imm)
+    x86_alui (x, 0, XOP_ADD, XAX, op->imm);
+}
+
+/* Point r12 and r13 at the window in edx, or in psr if load */
+
+static void
+sx_window (struct x86 *x, int load)
+{
+  if (load)
+    {
+      x86_ld (x, 0, XDX, XBX, SX_OFF (psr));
+      x86_alui (x, 0, XOP_AND, XDX, PSR_CWP);
+    }
+  x86_shifti (x, XSH_SHL, XDX, 6);
+  x86_lea (x, X12, XBX, XDX, SX_OFF (r));
+  x86_lea (x, X13, X12, XNONE, -(NWIN * 64));
+  x86_alui (x, 0, XOP_CMP, XDX, (NWIN - 1) << 6);
+  x86_cmov (x, XCC_NE, X13, X12);
+}
+
+static void
+sx_pc (struct x86 *x, uint32 target)
+{
+  x86_sti (x, XBX, SX_OFF (pc), target);
+  x86_sti (x, XBX, SX_OFF (npc), target + 4);
+}
+
+/* ALU operations with host code: the x86 operation, whether operand2
+   is inverted first and the kind of condition codes set */
+
+static const struct
+{
+  uint32 (*fn) (struct pstate *, const struct jitop *);
+  int xop, inv, cc;
+} sx_alu[] = {
+  {jit_add, XOP_ADD, 0, CC_NONE},
+  {jit_sub, XOP_SUB, 0, CC_NONE},
+  {jit_and, XOP_AND, 0, CC_NONE},
+  {jit_andn, XOP_AND, 1, CC_NONE},
+  {jit_or, XOP_OR, 0, CC_NONE},
+  {jit_orn, XOP_OR, 1, CC_NONE},
+  {jit_xor, XOP_XOR, 0, CC_NONE},
+  {jit_xnor, XOP_XOR, 1, CC_NONE},
+  {jit_sll, XSH_SHL, -1, CC_NONE},
+  {jit_srl, XSH_SHR, -1, CC_NONE},
+  {jit_sra, XSH_SAR, -1, CC_NONE},
+  {jit_addcc, XOP_ADD, 0, CC_ADD},
+  {jit_subcc, XOP_SUB, 0, CC_SUB},
+  {jit_andcc, XOP_AND, 0, CC_LOG},
+  {jit_andncc, XOP_AND, 1, CC_LOG},
+  {jit_orcc, XOP_OR, 0, CC_LOG},
+  {jit_orncc, XOP_OR, 1, CC_LOG},
+  {jit_xorcc, XOP_XOR, 0, CC_LOG},
+  {jit_xnorcc, XOP_XOR, 1, CC_LOG},
+};
+
+/* Bicc conditions on the flags of the last cc-setting operation */
+
+static const unsigned char sx_cond[16] = {
+  0, XCC_E, XCC_LE, XCC_L, XCC_BE, XCC_B, XCC_S, XCC_O,
+  0, XCC_NE, XCC_G, XCC_GE, XCC_A, XCC_AE, XCC_NS, XCC_NO
+};
+
+static void sx_op (struct x86 *x, const struct jitop *op, uint32 * cc);
+
+/* The delay slot of a taken or untaken transfer, or its annulment */
+
+static void
+sx_slot (struct x86 *x, const struct jitop *op, int annul, uint32 cc)
+{
+  if (annul)
+    x86_alui (x, 0, XOP_ADD, X14, JIT_ANNUL | JIT_CYC (1));
+  else
+    sx_op (x, &op[1], &cc);
+}
+
+static void
+sx_bicc (struct x86 *x, const struct jitop *op, uint32 cc)
+{
+  uint32 cond = op->rs1, taken = 0;
+
+  switch (cond)
+    {
+    case BICC_BA:
+      sx_pc (x, op->imm);
+      sx_slot (x, op, op->rs2, cc);
+      return;
+    case BICC_BN:
+      sx_slot (x, op, op->rs2, cc);
+      return;
+    }
+  switch (cc)
+    {
+    case CC_ADD:
+      x86_ld (x, 0, XAX, XBX, SX_OFF (ccsrc1));
+      x86_alum (x, XOP_ADD, XAX, XBX, SX_OFF (ccsrc2));
+      taken = x86_jump (x, sx_cond[cond]);
+      break;
+    case CC_SUB:
+      x86_ld (x, 0, XAX, XBX, SX_OFF (ccsrc1));
+      x86_alum (x, XOP_CMP, XAX, XBX, SX_OFF (ccsrc2));
+      taken = x86_jump (x, sx_cond[cond]);
+      break;
+    case CC_LOG:
+      x86_ld (x, 0, XAX, XBX, SX_OFF (ccres));
+      x86_reg (x, 0, 0x85, XAX, XAX);	/* test eax, eax */
+      taken = x86_jump (x, sx_cond[cond]);
+      break;
+    default:
+      x86_mov (x, 1, XDI, XBX);
+      x86_movi (x, XSI, cond);
+      x86_movi64 (x, XAX, (uintptr_t) sparc_jit_cond);
+      x86_reg (x, 0, 0xff, 2, XAX);	/* call rax */
+      x86_reg (x, 0, 0x85, XAX, XAX);
+      taken = x86_jump (x, XCC_NE);
+      cc = CC_NONE;
+      break;
+    }
+  sx_slot (x, op, op->rs2, cc);
+  x86_ret (x, XCC_ALWAYS);
+  x86_patch (x, taken, x86_here (x));
+  sx_pc (x, op->imm);
+  sx_slot (x, op, 0, cc);
+}
+
+static void
+sx_mem (struct x86 *x, const struct jitop *op)
+{
+  uint32 bswap = arch->bswap;
+
+  sx_address (x, op);
+  if (op->fn == jit_ld || op->fn == jit_ldub || op->fn == jit_ldsb
+      || op->fn == jit_lduh || op->fn == jit_ldsh)
+    {
+      if (op->fn == jit_ld)
+	x86_tlb (x, 0, 2, 3, JIT_MAXWS, 1, op->idx);
+      else if ((op->fn == jit_lduh) || (op->fn == jit_ldsh))
+	x86_tlb (x, 0, 1, 1, JIT_MAXWS, 1, op->idx);
+      else
+	x86_tlb (x, 0, 0, 0, JIT_MAXWS, 1, op->idx);
+      if (op->fn == jit_ld)
+	x86_mem (x, 0, 0x8b, XCX, XDX, XAX, 0);
+      else if ((op->fn == jit_ldub) || (op->fn == jit_ldsb))
+	{
+	  if (bswap)
+	    x86_alui (x, 0, XOP_XOR, XAX, bswap);
+	  x86_mem (x, 0, (op->fn == jit_ldub) ? 0x0fb6 : 0x0fbe, XCX, XDX,
+		   XAX, 0);
+	}
+      else
+	{
+	  if (bswap & 2)
+	    x86_alui (x, 0, XOP_XOR, XAX, bswap & 2);
+	  x86_mem (x, 0, (op->fn == jit_lduh) ? 0x0fb7 : 0x0fbf, XCX, XDX,
+		   XAX, 0);
+	}
+      sx_put (x, XCX, op->rd);
+    }
+  else if (op->fn == jit_ldd)
+    {
+      x86_tlb (x, 0, 3, 7, JIT_MAXWS / 2, 2, op->idx);
+      x86_mem (x, 0, 0x8b, XCX, XDX, XAX, 0);
+      x86_mem (x, 0, 0x8b, XSI, XDX, XAX, 4);
+      sx_put (x, XCX, op->rd & 0x1e);
+      sx_put (x, XSI, op->rd | 1);
+    }
+  else if (op->fn == jit_st)
+    {
+      x86_tlb (x, 1, 2, 3, JIT_MAXWS, 1, op->idx);
+      sx_get (x, XCX, op->rd);
+      x86_mem (x, 0, 0x89, XCX, XDX, XAX, 0);
+    }
+  else if (op->fn == jit_stb)
+    {
+      x86_tlb (x, 1, 0, 0, JIT_MAXWS, 1, op->idx);
+      if (bswap)
+	x86_alui (x, 0, XOP_XOR, XAX, bswap);
+      sx_get (x, XCX, op->rd);
+      x86_mem (x, 0, 0x88, XCX, XDX, XAX, 0);	/* mov byte, cl */
+    }
+  else if (op->fn == jit_sth)
+    {
+      x86_tlb (x, 1, 1, 1, JIT_MAXWS, 1, op->idx);
+      if (bswap & 2)
+	x86_alui (x, 0, XOP_XOR, XAX, bswap & 2);
+      sx_get (x, XCX, op->rd);
+      x86_mem (x, 2, 0x89, XCX, XDX, XAX, 0);
+    }
+  else
+    {
+      x86_tlb (x, 1, 3, 7, JIT_MAXWS, 1, op->idx);
+      sx_get (x, XCX, op->rd & 0x1e);
+      sx_get (x, XSI, op->rd | 1);
+      x86_mem (x, 0, 0x89, XCX, XDX, XAX, 0);
+      x86_mem (x, 0, 0x89, XSI, XDX, XAX, 4);
+    }
+}
+
+/* Host code for op; *cc is the kind of condition codes the block set
+   last, or CC_NONE if not known */
+
+static void
+sx_op (struct x86 *x, const struct jitop *op, uint32 * cc)
+{
+  uint32 i;
+
+  for (i = 0; i < sizeof (sx_alu) / sizeof (sx_alu[0]); i++)
+    if (op->fn == sx_alu[i].fn)
+      {
+	sx_operands (x, op);
+	if (sx_alu[i].inv < 0)
+	  {
+	    x86_shift (x, sx_alu[i].xop, XAX);
+	    sx_put (x, XAX, op->rd);
+	    return;
+	  }
+	if (sx_alu[i].cc == CC_LOG)
+	  {
+	    x86_sti (x, XBX, SX_OFF (ccsrc1), 0);
+	    x86_sti (x, XBX, SX_OFF (ccsrc2), 0);
+	  }
+	else if (sx_alu[i].cc != CC_NONE)
+	  {
+	    x86_st (x, 0, XAX, XBX, SX_OFF (ccsrc1));
+	    x86_st (x, 0, XCX, XBX, SX_OFF (ccsrc2));
+	  }
+	if (sx_alu[i].inv)
+	  x86_not (x, XCX);
+	x86_alu (x, sx_alu[i].xop, XAX, XCX);
+	if (sx_alu[i].cc != CC_NONE)
+	  {
+	    x86_st (x, 0, XAX, XBX, SX_OFF (ccres));
+	    x86_sti (x, XBX, SX_OFF (ccop), sx_alu[i].cc);
+	    *cc = sx_alu[i].cc;
+	  }
+	sx_put (x, XAX, op->rd);
+	return;
+      }
+
+  if (op->fn == jit_nop)
+    return;
+  if (op->fn == jit_sethi)
+    {
+      x86_movi (x, XAX, op->imm);
+      sx_put (x, XAX, op->rd);
+    }
+  else if (op->fn == jit_rdy)
+    {
+      x86_ld (x, 0, XAX, XBX, SX_OFF (y));
+      sx_put (x, XAX, op->rd);
+    }
+  else if (op->fn == jit_wry)
+    {
+      sx_operands (x, op);
+      x86_alu (x, XOP_XOR, XAX, XCX);
+      x86_st (x, 0, XAX, XBX, SX_OFF (y));
+    }
+  else if ((op->fn == jit_save) || (op->fn == jit_restore))
+    {
+      sx_address (x, op);
+      x86_ld (x, 0, XDX, XBX, SX_OFF (psr));
+      x86_alui (x, 0, XOP_ADD, XDX, (op->fn == jit_save) ? -1 : 1);
+      x86_alui (x, 0, XOP_AND, XDX, PSR_CWP);
+      x86_ld (x, 0, XCX, XBX, SX_OFF (wim));
+      x86_bt (x, XCX, XDX);
+      x86_exit (x, XCC_B, op->idx);
+      x86_ld (x, 0, XCX, XBX, SX_OFF (psr));
+      x86_alui (x, 0, XOP_AND, XCX, ~PSR_CWP);
+      x86_alu (x, XOP_OR, XCX, XDX);
+      x86_st (x, 0, XCX, XBX, SX_OFF (psr));
+      sx_window (x, 0);
+      sx_put (x, XAX, op->rd);
+    }
+  else if ((op->fn == jit_ld) || (op->fn == jit_ldub) || (op->fn == jit_ldsb)
+	   || (op->fn == jit_lduh) || (op->fn == jit_ldsh)
+	   || (op->fn == jit_ldd) || (op->fn == jit_st) || (op->fn == jit_stb)
+	   || (op->fn == jit_sth) || (op->fn == jit_std))
+    sx_mem (x, op);
+  else if (op->fn == jit_bicc)
+    sx_bicc (x, op, *cc);
+  else if (op->fn == jit_call)
+    {
+      x86_sti (x, X12, 4 * 15, op->addr);
+      sx_pc (x, op->imm);
+      sx_slot (x, op, 0, *cc);
+    }
+  else if (op->fn == jit_jmpl)
+    {
+      sx_address (x, op);
+      sx_get (x, XDX, op->rs1);
+      x86_alu (x, XOP_OR, XDX, XAX);
+      x86_testi (x, XDX, 3);
+      x86_exit (x, XCC_NE, op->idx);
+      x86_reg (x, 0, 0x85, XAX, XAX);
+      x86_exit (x, XCC_E, op->idx);
+      x86_movi (x, XCX, op->addr);
+      sx_put (x, XCX, op->rd);
+      x86_st (x, 0, XAX, XBX, SX_OFF (pc));
+      x86_alui (x, 0, XOP_ADD, XAX, 4);
+      x86_st (x, 0, XAX, XBX, SX_OFF (npc));
+      sx_slot (x, op, 0, *cc);
+    }
+  else
+    {
+      x86_handler (x, op);
+      *cc = CC_NONE;
+    }
+}
+
+static uint32
+sparc_emit (struct jitblk *blk, unsigned char *buf, uint32 len)
+{
+  struct x86 x;
+  uint32 i, cc = CC_NONE;
+
+  x86_prologue (&x, buf, len);
+  sx_window (&x, 1);
+  for (i = 0; i < blk->nops; i++)
+    sx_op (&x, &blk->op[i], &cc);
+  return x86_epilogue (&x);
+}
+#endif
+
+const struct cpu_arch sparc32 = {
+#ifdef HOST_LITTLE_ENDIAN
+  3,
+#else
+  0,
+#endif
+  sparc_dispatch_instruction,
+  sparc_execute_trap,
+  sparc_check_interrupts,
+  sparc_print_insn,
+  sparc_gdb_get_reg,
+  sparc_set_register,
+  sparc_display_registers,
+  sparc_display_ctrl,
+  sparc_display_special,
+  sparc_display_fpu,
+  sparc_predecode,
+  sparc_translate,
+#ifdef JIT_X86
+  sparc_emit
+#else
+  NULL
+#endif
 };
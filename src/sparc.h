@@ -57,6 +57,11 @@
 #define PSR_CWP (NWIN - 1)
 #define PSR_PIL 0x0f00
 
+/* Record a condition code update for SYNC_CC */
+#define SET_CC(sregs, op, src1, src2, res) \
+  ((sregs)->ccop = (op), (sregs)->ccsrc1 = (src1), \
+   (sregs)->ccsrc2 = (src2), (sregs)->ccres = (res))
+
 #define ICC_N	(icc >> 3)
 #define ICC_Z	(icc >> 2)
 #define ICC_V	(icc >> 1)
@@ -77,6 +82,7 @@
 #define TRAP_DIV0 0x2a
 
 #define FSR_TT		0x1C000
+#define FSR_TEM		0x0F800000
 #define FP_IEEE		0x04000
 #define FP_UNIMP	0x0C000
 #define FP_SEQ_ERR	0x10000
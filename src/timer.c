@@ -1,19 +1,175 @@
 #include "timer.h"
 
+/* Number of timer ticks (scaler underflows) until the next one at which
+   some timer does more than a plain decrement: a pending load, an underflow
+   or a chained decrement. Zero when no timer will change on its own. */
+static uint64_t
+gptimer_ticks_to_change(gp_timer *timers, uint32_t timers_size)
+{
+  uint64_t ticks = 0;
+
+  for (size_t i = 0; i < timers_size; i++)
+  {
+    uint64_t timer_ticks;
+
+    if (!gptimer_get_flag(timers[i].control_register, GPT_EN))
+    {
+      continue;
+    }
+
+    if (gptimer_get_flag(timers[i].control_register, GPT_LD))
+    {
+      timer_ticks = 1;
+    }
+    else if (gptimer_get_flag(timers[i].control_register, GPT_CH))
+    {
+      if ((timers[i].timer_chain_underflow_ptr == NULL) || !*timers[i].timer_chain_underflow_ptr)
+      {
+        continue;
+      }
+      timer_ticks = 1;
+    }
+    else
+    {
+      timer_ticks = (uint64_t) timers[i].counter_value_register + 1;
+    }
+
+    if ((ticks == 0) || (timer_ticks < ticks))
+    {
+      ticks = timer_ticks;
+    }
+  }
+
+  return ticks;
+}
+
+/* Apply timer ticks that are known to be plain decrements. */
+static void
+gptimer_skip_ticks(gp_timer *timers, uint32_t timers_size, uint64_t ticks)
+{
+  for (size_t i = 0; i < timers_size; i++)
+  {
+    if (gptimer_get_flag(timers[i].control_register, GPT_EN)
+        && !gptimer_get_flag(timers[i].control_register, GPT_LD)
+        && !gptimer_get_flag(timers[i].control_register, GPT_CH))
+    {
+      timers[i].counter_value_register -= ticks;
+    }
+  }
+}
+
+static void
+gptimer_tick(gp_timer *timers, uint32_t timers_size)
+{
+  for (size_t i = 0; i < timers_size; i++)
+  {
+    gptimer_timer_update(&timers[i]);
+  }
+}
+
+static void
+gptimer_run_ticks(gp_timer *timers, uint32_t timers_size, uint64_t ticks)
+{
+  while (ticks > 0)
+  {
+    uint64_t next = gptimer_ticks_to_change(timers, timers_size);
+
+    if ((next == 0) || (next > ticks))
+    {
+      gptimer_skip_ticks(timers, timers_size, ticks);
+      break;
+    }
+
+    gptimer_skip_ticks(timers, timers_size, next - 1);
+    gptimer_tick(timers, timers_size);
+    ticks -= next;
+  }
+}
+
+/* Bring the unit up to simulated time 'time'. The result is the same as
+   stepping the scaler once per cycle since the last update, but only the
+   ticks where a timer loads, underflows or follows its chain are applied
+   one by one. */
 void
-gptimer_update(gp_timer_core *core, gp_timer *timers, uint32_t timers_size)
+gptimer_advance(gp_timer_core *core, gp_timer *timers, uint32_t timers_size, uint64_t time)
 {
-  if (core->scaler_register > 0)
+  uint64_t cycles;
+  uint64_t period;
+
+  if (time <= core->last_update)
+  {
+    return;
+  }
+
+  cycles = time - core->last_update;
+  core->last_update = time;
+
+  if (cycles <= core->scaler_register)
   {
-    core->scaler_register--;
+    core->scaler_register -= cycles;
+    return;
   }
-  else {
-    core->scaler_register = core->scaler_reload_register;
+
+  cycles -= (uint64_t) core->scaler_register + 1;
+  period = (uint64_t) core->scaler_reload_register + 1;
+  core->scaler_register = core->scaler_reload_register - (cycles % period);
+  gptimer_run_ticks(timers, timers_size, 1 + cycles / period);
+}
+
+/* Simulated time of the next scaler tick at which an interrupt enabled
+   timer underflows, or GPTIMER_NO_INTERRUPT if none will. The search is
+   done on a copy of the timers and gives up after GPTIMER_SEARCH_LIMIT
+   eventful ticks, returning the time reached so the caller can resume
+   from there. */
+uint64_t
+gptimer_next_interrupt(gp_timer_core *core, gp_timer *timers, uint32_t timers_size)
+{
+  gp_timer shadow[GPTIMER_APBCTRL1_SIZE];
+  uint64_t period = (uint64_t) core->scaler_reload_register + 1;
+  uint64_t time = core->last_update + core->scaler_register + 1;
+
+  for (size_t i = 0; i < timers_size; i++)
+  {
+    if (gptimer_get_flag(timers[i].control_register, GPT_IP))
+    {
+      return core->last_update;
+    }
+
+    shadow[i] = timers[i];
+    for (size_t j = 0; j < timers_size; j++)
+    {
+      if (timers[i].timer_chain_underflow_ptr == &timers[j].timer_underflow)
+      {
+        shadow[i].timer_chain_underflow_ptr = &shadow[j].timer_underflow;
+      }
+    }
+  }
+
+  for (int step = 0; step < GPTIMER_SEARCH_LIMIT; step++)
+  {
+    uint64_t next = gptimer_ticks_to_change(shadow, timers_size);
+
+    if (next == 0)
+    {
+      return GPTIMER_NO_INTERRUPT;
+    }
+
+    gptimer_skip_ticks(shadow, timers_size, next - 1);
+    gptimer_tick(shadow, timers_size);
+    time += (next - 1) * period;
+
     for (size_t i = 0; i < timers_size; i++)
     {
-      gptimer_timer_update(&timers[i]);
+      if (gptimer_get_flag(shadow[i].control_register, GPT_IP))
+      {
+        return time;
+      }
     }
+
+    time += period;
   }
+
+  return time - period;
 }
 
 void
@@ -28,7 +184,7 @@ gptimer_timer_update(gp_timer *timer)
     }
     else if (gptimer_get_flag(timer->control_register, GPT_CH))
     {
-      if (*timer->timer_chain_underflow_ptr > 0)
+      if ((timer->timer_chain_underflow_ptr != NULL) && *timer->timer_chain_underflow_ptr)
       {
         *timer->timer_chain_underflow_ptr = false;
         gptimer_decrement(timer);
@@ -131,17 +287,22 @@ gptimer_read_core_register(gp_timer_core *core, uint32_t address)
   {
     case GPTIMER_SCALER_VALUE_REGISTER_ADDRESS:
     {
-      result = gptimer1.core.scaler_register;
+      result = core->scaler_register;
       break;
     }
     case GPTIMER_SCALER_RELOAD_VALUE_REGISTER_ADDRESS:
     {
-      result = gptimer1.core.scaler_reload_register;
+      result = core->scaler_reload_register;
       break;
     }
     case GPTIMER_CONFIGURATION_REGISTER_ADDRESS:
     {
-      result = gptimer1.core.configuration_register;
+      result = core->configuration_register;
+      break;
+    }
+    case GPTIMER_LATCH_CONFIGURATION_REGISTER_ADDRESS:
+    {
+      result = core->timer_latch_configuration_register;
       break;
     }
     default:
@@ -203,7 +364,7 @@ gptimer_apbctrl2_write_core_register(uint32_t address, uint32_t * data)
     }
     case GPTIMER_CONFIGURATION_REGISTER_ADDRESS:
     {
-      gptimer2.core.configuration_register = (*data) & GPTIMER_APBCTRL2_CONFIGURATION_REGISTER_WRITE_MASK + GPTIMER_APBCTRL2_CONFIGURATION_REGISTER_INIT_VALUE;
+      gptimer2.core.configuration_register = ((*data) & GPTIMER_APBCTRL2_CONFIGURATION_REGISTER_WRITE_MASK) | GPTIMER_APBCTRL2_CONFIGURATION_REGISTER_INIT_VALUE;
       break;
     }
     case GPTIMER_LATCH_CONFIGURATION_REGISTER_ADDRESS:
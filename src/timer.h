@@ -44,12 +44,15 @@
 #define GPTIMER_APBCTRL1_SCALER_REGISTER_WRITE_MASK 0xFFFF
 #define GPTIMER_APBCTRL2_SCALER_REGISTER_WRITE_MASK 0xFF
 #define GPTIMER_APBCTRL1_CONFIGURATION_REGISTER_WRITE_MASK 0x180
-#define GPTIMER_APBCTRL2_CONFIGURATION_REGISTER_WRITE_MASK 0x500
+#define GPTIMER_APBCTRL2_CONFIGURATION_REGISTER_WRITE_MASK 0xD00
 #define GPTIMER_CONTROL_REGISTER_WRITE_MASK 0x2F
 
 #define GPTIMER_APBCTRL1_SIZE 4
 #define GPTIMER_APBCTRL2_SIZE 2
 
+#define GPTIMER_NO_INTERRUPT UINT64_MAX
+#define GPTIMER_SEARCH_LIMIT 64
+
 #define GPTIMER_APBCTRL1_INTERRUPT_BASE_NR 8
 #define GPTIMER_APBCTRL2_INTERRUPT_BASE_NR 7
 
@@ -91,6 +94,7 @@ typedef struct
     uint32_t scaler_reload_register;
     uint32_t configuration_register;
     uint32_t timer_latch_configuration_register;
+    uint64_t last_update; /* simulated time the unit state corresponds to */
 } gp_timer_core;
 
 typedef struct
@@ -108,7 +112,8 @@ typedef struct
 extern gp_timer_apbctrl1 gptimer1;
 extern gp_timer_apbctrl2 gptimer2;
 
-void gptimer_update(gp_timer_core *core, gp_timer *timers, uint32_t timers_size);
+void gptimer_advance(gp_timer_core *core, gp_timer *timers, uint32_t timers_size, uint64_t time);
+uint64_t gptimer_next_interrupt(gp_timer_core *core, gp_timer *timers, uint32_t timers_size);
 void gptimer_timer_update(gp_timer *timer);
 void gptimer_decrement(gp_timer *timer);
 void gptimer_apbctrl1_timer_reset();
@@ -116,6 +116,8 @@ typedef struct
     uint32_t status_register;
     uint32_t control_register;
     uint32_t scaler_register;
+    uint64_t rx_event;
+    uint64_t tx_event;
 } apbuart_type;
 
 int uart_init (apbuart_type *uart);
@@ -0,0 +1,471 @@
+/* This file is part of SIS (SPARC/RISCV instruction simulator)
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* x86-64 host code for translated blocks (-jit, see struct jitop).
+   A block is entered as uint32 code (struct pstate *sregs) under the
+   System V ABI and returns what its operations would have returned
+   added up.  It keeps sregs in rbx and that sum in r14d; the prologue
+   saves rbx and r12-r15, which leaves r12, r13 and r15 to the
+   architecture, and rax, rcx, rdx, rsi and rdi are scratch.  An
+   operation that leaves the block jumps to an exit stub that adds
+   JIT_EXIT and its index to r14d.  Operations without host code of
+   their own call their threaded handler. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{ XAX, XCX, XDX, XBX, XSP, XBP, XSI, XDI, X8, X9, X10, X11, X12, X13, X14,
+  X15
+};
+#define XNONE	(-1)
+
+/* Conditions of jcc and cmovcc */
+enum
+{ XCC_O, XCC_NO, XCC_B, XCC_AE, XCC_E, XCC_NE, XCC_BE, XCC_A, XCC_S,
+  XCC_NS, XCC_P, XCC_NP, XCC_L, XCC_GE, XCC_LE, XCC_G
+};
+#define XCC_ALWAYS	(-1)
+
+/* ALU operations, as in the reg field of opcode 0x81 */
+enum
+{ XOP_ADD, XOP_OR, XOP_ADC, XOP_SBB, XOP_AND, XOP_SUB, XOP_XOR, XOP_CMP };
+
+/* Shifts, as in the reg field of opcode 0xd3 */
+#define XSH_SHL		4
+#define XSH_SHR		5
+#define XSH_SAR		7
+
+#define X86_MAXEXIT	512	/* jumps to exit stubs per block */
+#define X86_MAXRET	256	/* jumps to the epilogue per block */
+
+struct x86
+{
+  unsigned char *buf, *p, *end;
+  int ovf;			/* out of buffer or jump sites */
+  uint32 nexit, nret;
+  uint32 exitpos[X86_MAXEXIT];	/* rel32 fields to patch */
+  unsigned char exitidx[X86_MAXEXIT];	/* index of the exiting op */
+  uint32 retpos[X86_MAXRET];
+};
+
+static inline void
+x86_b (struct x86 *x, uint32 b)
+{
+  if (x->p < x->end)
+    *x->p++ = b;
+  else
+    x->ovf = 1;
+}
+
+static inline void
+x86_d (struct x86 *x, uint32 d)
+{
+  x86_b (x, d);
+  x86_b (x, d >> 8);
+  x86_b (x, d >> 16);
+  x86_b (x, d >> 24);
+}
+
+static inline uint32
+x86_here (struct x86 *x)
+{
+  return x->p - x->buf;
+}
+
+/* Prefixes for operand size w (0 = 32, 1 = 64, 2 = 16 bits) and the
+   registers in the reg, index and base fields */
+
+static inline void
+x86_rex (struct x86 *x, int w, int reg, int index, int base)
+{
+  int rex = ((w == 1) ? 8 : 0) | ((reg & 8) >> 1) | ((base & 8) >> 3);
+
+  if (index != XNONE)
+    rex |= (index & 8) >> 2;
+  if (w == 2)
+    x86_b (x, 0x66);
+  if (rex)
+    x86_b (x, 0x40 | rex);
+}
+
+/* One or two byte opcode */
+
+static inline void
+x86_op (struct x86 *x, uint32 op)
+{
+  if (op > 0xff)
+    x86_b (x, op >> 8);
+  x86_b (x, op);
+}
+
+/* op with reg and the memory operand [base + index + disp] */
+
+static inline void
+x86_mem (struct x86 *x, int w, uint32 op, int reg, int base, int index,
+	 int32 disp)
+{
+  int mod = ((disp >= -128) && (disp < 128)) ? 0x40 : 0x80;
+
+  x86_rex (x, w, reg, index, base);
+  x86_op (x, op);
+  if ((index != XNONE) || ((base & 7) == XSP))
+    {
+      x86_b (x, mod | ((reg & 7) << 3) | 4);
+      x86_b (x, ((((index != XNONE) ? index : XSP) & 7) << 3) | (base & 7));
+    }
+  else
+    x86_b (x, mod | ((reg & 7) << 3) | (base & 7));
+  if (mod == 0x40)
+    x86_b (x, disp);
+  else
+    x86_d (x, disp);
+}
+
+/* op with reg and the register operand rm */
+
+static inline void
+x86_reg (struct x86 *x, int w, uint32 op, int reg, int rm)
+{
+  x86_rex (x, w, reg, XNONE, rm);
+  x86_op (x, op);
+  x86_b (x, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/* mov reg, [base + disp] */
+
+static inline void
+x86_ld (struct x86 *x, int w, int reg, int base, int32 disp)
+{
+  x86_mem (x, w, 0x8b, reg, base, XNONE, disp);
+}
+
+/* mov [base + disp], reg */
+
+static inline void
+x86_st (struct x86 *x, int w, int reg, int base, int32 disp)
+{
+  x86_mem (x, w, 0x89, reg, base, XNONE, disp);
+}
+
+/* mov dword [base + disp], imm */
+
+static inline void
+x86_sti (struct x86 *x, int base, int32 disp, uint32 imm)
+{
+  x86_mem (x, 0, 0xc7, 0, base, XNONE, disp);
+  x86_d (x, imm);
+}
+
+/* xop dst, src */
+
+static inline void
+x86_alu (struct x86 *x, int xop, int dst, int src)
+{
+  x86_reg (x, 0, (xop << 3) | 1, src, dst);
+}
+
+/* xop dst, [base + disp] */
+
+static inline void
+x86_alum (struct x86 *x, int xop, int dst, int base, int32 disp)
+{
+  x86_mem (x, 0, (xop << 3) | 3, dst, base, XNONE, disp);
+}
+
+/* xop dst, imm */
+
+static inline void
+x86_alui (struct x86 *x, int w, int xop, int dst, int32 imm)
+{
+  if ((imm >= -128) && (imm < 128))
+    {
+      x86_reg (x, w, 0x83, xop, dst);
+      x86_b (x, imm);
+    }
+  else
+    {
+      x86_reg (x, w, 0x81, xop, dst);
+      x86_d (x, imm);
+    }
+}
+
+/* sh dst, cl */
+
+static inline void
+x86_shift (struct x86 *x, int sh, int dst)
+{
+  x86_reg (x, 0, 0xd3, sh, dst);
+}
+
+/* sh dst, n */
+
+static inline void
+x86_shifti (struct x86 *x, int sh, int dst, int n)
+{
+  x86_reg (x, 0, 0xc1, sh, dst);
+  x86_b (x, n);
+}
+
+static inline void
+x86_not (struct x86 *x, int dst)
+{
+  x86_reg (x, 0, 0xf7, 2, dst);
+}
+
+/* mov dst, src */
+
+static inline void
+x86_mov (struct x86 *x, int w, int dst, int src)
+{
+  x86_reg (x, w, 0x89, src, dst);
+}
+
+/* mov dst, imm */
+
+static inline void
+x86_movi (struct x86 *x, int dst, uint32 imm)
+{
+  if (dst & 8)
+    x86_b (x, 0x41);
+  x86_b (x, 0xb8 | (dst & 7));
+  x86_d (x, imm);
+}
+
+static inline void
+x86_movi64 (struct x86 *x, int dst, uint64_t imm)
+{
+  x86_b (x, 0x48 | ((dst & 8) >> 3));
+  x86_b (x, 0xb8 | (dst & 7));
+  x86_d (x, imm);
+  x86_d (x, imm >> 32);
+}
+
+/* lea dst, [base + index + disp] */
+
+static inline void
+x86_lea (struct x86 *x, int dst, int base, int index, int32 disp)
+{
+  x86_mem (x, 1, 0x8d, dst, base, index, disp);
+}
+
+/* cmovcc dst, src, 64 bits */
+
+static inline void
+x86_cmov (struct x86 *x, int cc, int dst, int src)
+{
+  x86_reg (x, 1, 0x0f40 | cc, dst, src);
+}
+
+/* test a, imm */
+
+static inline void
+x86_testi (struct x86 *x, int a, uint32 imm)
+{
+  x86_reg (x, 0, 0xf7, 0, a);
+  x86_d (x, imm);
+}
+
+/* setcc on the low byte of a, one of eax to ebx */
+
+static inline void
+x86_setcc (struct x86 *x, int cc, int a)
+{
+  x86_reg (x, 0, 0x0f90 | cc, 0, a);
+}
+
+/* bt a, bit */
+
+static inline void
+x86_bt (struct x86 *x, int a, int bit)
+{
+  x86_reg (x, 0, 0x0fa3, bit, a);
+}
+
+/* jcc or, with XCC_ALWAYS, jmp to a rel32 that x86_patch () fills in
+   later.  Returns the position of the rel32. */
+
+static inline uint32
+x86_jump (struct x86 *x, int cc)
+{
+  if (cc == XCC_ALWAYS)
+    x86_b (x, 0xe9);
+  else
+    {
+      x86_b (x, 0x0f);
+      x86_b (x, 0x80 | cc);
+    }
+  x86_d (x, 0);
+  return x86_here (x) - 4;
+}
+
+static inline void
+x86_patch (struct x86 *x, uint32 pos, uint32 target)
+{
+  uint32 rel = target - (pos + 4);
+
+  if (pos + 4 <= (uint32) (x->end - x->buf))
+    memcpy (&x->buf[pos], &rel, 4);
+}
+
+/* Jump to the exit stub of op[idx] if cc */
+
+static inline void
+x86_exit (struct x86 *x, int cc, uint32 idx)
+{
+  uint32 pos = x86_jump (x, cc);
+
+  if (x->nexit == X86_MAXEXIT)
+    {
+      x->ovf = 1;
+      return;
+    }
+  x->exitpos[x->nexit] = pos;
+  x->exitidx[x->nexit++] = idx;
+}
+
+/* Jump to the epilogue if cc */
+
+static inline void
+x86_ret (struct x86 *x, int cc)
+{
+  uint32 pos = x86_jump (x, cc);
+
+  if (x->nret == X86_MAXRET)
+    {
+      x->ovf = 1;
+      return;
+    }
+  x->retpos[x->nret++] = pos;
+}
+
+/* Call fn (sregs, op), a threaded handler, and add what it returns;
+   the block is left if that has JIT_EXIT */
+
+static inline void
+x86_handler (struct x86 *x, const struct jitop *op)
+{
+  x86_mov (x, 1, XDI, XBX);
+  x86_movi64 (x, XSI, (uintptr_t) op);
+  x86_movi64 (x, XAX, (uintptr_t) op->fn);
+  x86_reg (x, 0, 0xff, 2, XAX);	/* call rax */
+  x86_alu (x, XOP_ADD, X14, XAX);
+  x86_testi (x, XAX, JIT_EXIT);
+  x86_ret (x, XCC_NE);
+}
+
+static inline void
+x86_prologue (struct x86 *x, unsigned char *buf, uint32 len)
+{
+  x->buf = x->p = buf;
+  x->end = buf + len;
+  x->ovf = 0;
+  x->nexit = x->nret = 0;
+  x86_b (x, 0x53);		/* push rbx */
+  x86_b (x, 0x41);		/* push r12 - r15 */
+  x86_b (x, 0x54);
+  x86_b (x, 0x41);
+  x86_b (x, 0x55);
+  x86_b (x, 0x41);
+  x86_b (x, 0x56);
+  x86_b (x, 0x41);
+  x86_b (x, 0x57);
+  x86_mov (x, 1, XBX, XDI);
+  x86_alu (x, XOP_XOR, X14, X14);
+}
+
+/* End the block with the epilogue and the exit stubs.  Returns the
+   length of the code, or 0 if it did not fit. */
+
+static inline uint32
+x86_epilogue (struct x86 *x)
+{
+  uint32 epi, i, stub[256];
+
+  epi = x86_here (x);
+  x86_mov (x, 0, XAX, X14);
+  x86_b (x, 0x41);		/* pop r15 - r12 */
+  x86_b (x, 0x5f);
+  x86_b (x, 0x41);
+  x86_b (x, 0x5e);
+  x86_b (x, 0x41);
+  x86_b (x, 0x5d);
+  x86_b (x, 0x41);
+  x86_b (x, 0x5c);
+  x86_b (x, 0x5b);		/* pop rbx */
+  x86_b (x, 0xc3);		/* ret */
+  for (i = 0; i < x->nret; i++)
+    x86_patch (x, x->retpos[i], epi);
+  memset (stub, 0, sizeof (stub));
+  for (i = 0; i < x->nexit; i++)
+    {
+      if (stub[x->exitidx[i]] == 0)
+	{
+	  stub[x->exitidx[i]] = x86_here (x);
+	  x86_alui (x, 0, XOP_ADD, X14, JIT_EXIT | (x->exitidx[i] << 22));
+	  x86_patch (x, x86_jump (x, XCC_ALWAYS), epi);
+	}
+      x86_patch (x, x->exitpos[i], stub[x->exitidx[i]]);
+    }
+  return x->ovf ? 0 : x86_here (x);
+}
+
+/* TLB lookup of an access at the guest address in eax, of 1 << sz
+   bytes for a write, as jit_tlb_read () and jit_tlb_write () do: it
+   leaves through op[idx] on a miss, a misaligned address, more than
+   maxws waitstates or a write to a page with predecoded code.  On a
+   hit, the waitstates are added n times to r14d, rdx is the page and
+   eax the offset in it. */
+
+static inline void
+x86_tlb (struct x86 *x, int write, int sz, uint32 align, int32 maxws,
+	 int n, uint32 idx)
+{
+  if (align)
+    {
+      x86_testi (x, XAX, align);
+      x86_exit (x, XCC_NE, idx);
+    }
+  x86_mov (x, 0, XCX, XAX);
+  x86_shifti (x, XSH_SHR, XCX, TLB_PAGEBITS);
+  x86_alui (x, 0, XOP_AND, XCX, TLB_ENTRIES - 1);
+  x86_reg (x, 0, 0x69, XCX, XCX);	/* imul ecx, ecx, size */
+  x86_d (x, sizeof (struct tlbent));
+  x86_lea (x, XDX, XBX, XCX, offsetof (struct pstate, tlb));
+  x86_mov (x, 0, XCX, XAX);
+  x86_alui (x, 0, XOP_AND, XCX, ~(TLB_PAGESIZE - 1));
+  x86_alum (x, XOP_CMP, XCX, XDX,
+	    write ? offsetof (struct tlbent, wtag) :
+	    offsetof (struct tlbent, rtag));
+  x86_exit (x, XCC_NE, idx);
+  x86_ld (x, 0, XCX, XDX,
+	  write ? offsetof (struct tlbent, wws) + 4 * sz :
+	  offsetof (struct tlbent, rws));
+  x86_alui (x, 0, XOP_CMP, XCX, maxws);
+  x86_exit (x, XCC_A, idx);
+  if (write)
+    {
+      x86_mov (x, 0, XSI, XAX);
+      x86_shifti (x, XSH_SHR, XSI, PDC_PAGEBITS);
+      x86_movi64 (x, XDI, (uintptr_t) pdc_flags);
+      x86_mem (x, 0, 0x80, XOP_CMP, XDI, XSI, 0);	/* cmp byte */
+      x86_b (x, 0);
+      x86_exit (x, XCC_NE, idx);
+    }
+  while (n--)
+    x86_alu (x, XOP_ADD, X14, XCX);
+  x86_ld (x, 1, XDX, XDX, offsetof (struct tlbent, mem));
+  x86_alui (x, 0, XOP_AND, XAX, TLB_PAGESIZE - 1);
+}
@@ -0,0 +1,35 @@
+#include "CppUTest/TestHarness.h"
+#include <stdio.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../../unit/common/hold.h"
+
+#define HOLD_EVENTS 200000
+
+TEST_GROUP(EventQueueBench)
+{
+};
+
+/* Time the hold model on the old sorted list and on the event queue for
+   a growing number of pending events */
+TEST(EventQueueBench, HoldModelAgainstSortedList)
+{
+    static const int pending[] = { 16, 128, 512, 2048 };
+    double start, list_secs, queue_secs;
+    uint64 list_sum, queue_sum;
+
+    printf("\n pending     events     list (s)    queue (s)\n");
+    for (unsigned i = 0; i < sizeof(pending) / sizeof(pending[0]); i++) {
+        start = get_time();
+        list_sum = hold_list(pending[i], HOLD_EVENTS);
+        list_secs = get_time() - start;
+        start = get_time();
+        queue_sum = hold_queue(pending[i], HOLD_EVENTS);
+        queue_secs = get_time() - start;
+        CHECK(list_sum == queue_sum);
+        printf(" %7d  %9d  %11.3f  %11.3f\n", pending[i], HOLD_EVENTS,
+               list_secs, queue_secs);
+    }
+}
@@ -0,0 +1,14 @@
+wmem 0x80000000 0x800104b7	lui s1, 0x80010
+wmem 0x80000004 0x00a585b3	1: add a1, a1, a0
+wmem 0x80000008 0x00359613	slli a2, a1, 3
+wmem 0x8000000c 0x00a646b3	xor a3, a2, a0
+wmem 0x80000010 0x0ff6f713	andi a4, a3, 0xff
+wmem 0x80000014 0x050597ae	c.add a5, a1; c.addi a0, 1
+wmem 0x80000018 0x00f4a023	sw a5, 0(s1)
+wmem 0x8000001c 0x0004a803	lw a6, 0(s1)
+wmem 0x80000020 0x00e808b3	add a7, a6, a4
+wmem 0x80000024 0x0028d293	srli t0, a7, 2
+wmem 0x80000028 0x959a8316	c.mv t1, t0; c.add a1, t1
+wmem 0x8000002c 0xfd9ff06f	j 1b
+go 0x80000000 100000000
+perf
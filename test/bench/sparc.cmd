@@ -0,0 +1,19 @@
+wmem 0x02000000 0x03008040	sethi %hi(0x2010000), %g1
+wmem 0x02000004 0x90102000	clr %o0
+wmem 0x02000008 0x92024008	1: add %o1, %o0, %o1
+wmem 0x0200000c 0x952a6003	sll %o1, 3, %o2
+wmem 0x02000010 0x961a8008	xor %o2, %o0, %o3
+wmem 0x02000014 0x980ae0ff	and %o3, 0xff, %o4
+wmem 0x02000018 0x9a130009	or %o4, %o1, %o5
+wmem 0x0200001c 0x9a23400a	sub %o5, %o2, %o5
+wmem 0x02000020 0xda206000	st %o5, [%g1]
+wmem 0x02000024 0xa002000c	add %o0, %o4, %l0
+wmem 0x02000028 0xe2006000	ld [%g1], %l1
+wmem 0x0200002c 0xa41c4010	xor %l1, %l0, %l2
+wmem 0x02000030 0xa734a002	srl %l2, 2, %l3
+wmem 0x02000034 0x80a4c009	cmp %l3, %o1
+wmem 0x02000038 0x9204c009	add %l3, %o1, %o1
+wmem 0x0200003c 0x10bffff3	ba 1b
+wmem 0x02000040 0x90022001	add %o0, 1, %o0
+go 0x02000000 100000000
+perf
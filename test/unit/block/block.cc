@@ -0,0 +1,88 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+
+/* Start the ERC32 GPT with a 21 cycle period and count in %g5 through
+   a long basic block, so that the timer interrupt falls inside it */
+static const uint32 gpt_block[] = {
+    0x03007e00,	/* sethi %hi(0x01f80000), %g1 */
+    0x07008004,	/* sethi %hi(0x02001000), %g3 */
+    0x8198e000,	/* wr %g3, %tbr */
+    0x880020e0,	/* mov 0xe0, %g4 */
+    0x81892000,	/* wr %g4, %psr */
+    0x01000000,	/* nop */
+    0x01000000,	/* nop */
+    0x8a102000,	/* clr %g5 */
+    0xc020604c,	/* clr [%g1 + 0x4c] (imr) */
+    0xc020608c,	/* clr [%g1 + 0x8c] (gpt scaler) */
+    0x88002014,	/* mov 20, %g4 */
+    0xc8206088,	/* st %g4, [%g1 + 0x88] (gpt reload) */
+    0x88002006,	/* mov 6, %g4 */
+    0xc8206098,	/* st %g4, [%g1 + 0x98] (load and start) */
+};
+
+/* Interrupt 12 handler */
+static const uint32 gpt_trap[] = {
+    0x10800000,	/* ba . */
+    0x01000000,	/*  nop */
+};
+
+static const uint32 inc_g5 = 0x8a016001;	/* inc %g5 */
+
+static void load_gpt_block(void)
+{
+    uint32 a = ERC32_RAM + sizeof(gpt_block);
+
+    load(gpt_block, sizeof(gpt_block) / 4);
+    for (int i = 0; i < 60; i++, a += 4)
+        ms->sis_memory_write(a, (char *) &inc_g5, 4);
+    ms->sis_memory_write(a, (char *) &gpt_trap[0], 4);
+    ms->sis_memory_write(a + 4, (char *) &gpt_trap[1], 4);
+    for (int i = 0; i < 2; i++)
+        ms->sis_memory_write(ERC32_RAM + 0x11c0 + 4 * i,
+                             (char *) &gpt_trap[i], 4);
+}
+
+TEST_GROUP(BlockTests)
+{
+    void teardown()
+    {
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+/* An event scheduled by an instruction inside a block must end the
+   block in time: the interrupt is taken where the debug loop, which
+   processes events after every instruction, takes it */
+TEST(BlockTests, ShouldTakeTimerInterruptInsideBlock)
+{
+    static struct histype hist[16];
+    struct pstate ref;
+
+    /* history selects the debug loop */
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    load_gpt_block();
+    sregs[0].histbuf = hist;
+    sregs[0].histind = 0;
+    ebase.histlen = 16;
+    exec_cmd("run 2000");
+    ebase.histlen = 0;
+    sregs[0].histbuf = NULL;
+    memcpy(&ref, &sregs[0], sizeof(ref));
+    CHECK(ref.g[5] > 0);
+    CHECK(ref.g[5] < 60);
+    LONGS_EQUAL(0x1c0, ref.tbr & 0xff0);
+
+    load_gpt_block();
+    exec_cmd("run 2000");
+
+    LONGS_EQUAL(ref.g[5], sregs[0].g[5]);
+    LONGS_EQUAL(ref.pc, sregs[0].pc);
+    LONGS_EQUAL(ref.tbr, sregs[0].tbr);
+    CHECK(ref.simtime == sregs[0].simtime);
+}
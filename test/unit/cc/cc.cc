@@ -0,0 +1,266 @@
+#include "CppUTest/TestHarness.h"
+#include <vector>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+
+/* The integer condition codes are computed lazily, from the last
+   cc-setting operation, where they are read.  Run each such operation
+   on a set of operands and follow it with every kind of reader, then
+   check what the readers saw against icc computed here from the
+   architecture manual. */
+
+#define ICC_N 8
+#define ICC_Z 4
+#define ICC_V 2
+#define ICC_C 1
+
+#define TBR (ERC32_RAM + 0x1000)
+#define LOG (ERC32_RAM + 0x3000)	/* psr seen by the trap handlers */
+
+enum { ADDCC = 0x10, ANDCC, ORCC, XORCC, SUBCC, ANDNCC, ORNCC, XNORCC,
+       ADDXCC, SUBXCC = 0x1c };
+
+static const uint32 ops[] = {
+    ADDCC, ADDXCC, SUBCC, SUBXCC, ANDCC, ANDNCC, ORCC, ORNCC, XORCC, XNORCC
+};
+
+static const uint32 operands[][2] = {
+    {0, 0}, {1, 2}, {2, 1}, {5, 5}, {0x7fffffff, 1},
+    {0x80000000, 0x80000000}, {0xffffffff, 1}, {0x80000000, 1}
+};
+
+static uint32 fmt3(uint32 op3, int rd, int rs1, int rs2)
+{
+    return 0x80000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | rs2;
+}
+
+static uint32 fmt3i(uint32 op3, int rd, int rs1, int simm)
+{
+    return 0x80000000 | (rd << 25) | (op3 << 19) | (rs1 << 14) | 0x2000 |
+        (simm & 0x1fff);
+}
+
+static uint32 bicc(int cond, int annul, int disp)
+{
+    return (annul << 29) | (cond << 25) | (2 << 22) | (disp & 0x3fffff);
+}
+
+static void set(std::vector<uint32> &p, int rd, uint32 val)
+{
+    p.push_back((rd << 25) | (4 << 22) | (val >> 10));	/* sethi */
+    p.push_back(fmt3i(0x02, rd, rd, val & 0x3ff));	/* or */
+}
+
+/* icc of op on a and b with carry in cin */
+static uint32 icc(uint32 op, uint32 a, uint32 b, uint32 cin)
+{
+    uint32 r, v = 0, c = 0;
+
+    switch (op) {
+    case ADDCC:
+    case ADDXCC:
+        r = a + b + ((op == ADDXCC) ? cin : 0);
+        v = ((a & b & ~r) | (~a & ~b & r)) >> 31;
+        c = ((a & b) | ((a | b) & ~r)) >> 31;
+        break;
+    case SUBCC:
+    case SUBXCC:
+        r = a - b - ((op == SUBXCC) ? cin : 0);
+        v = ((a & ~b & ~r) | (~a & b & r)) >> 31;
+        c = ((~a & b) | (r & (~a | b))) >> 31;
+        break;
+    case ANDCC:
+        r = a & b;
+        break;
+    case ANDNCC:
+        r = a & ~b;
+        break;
+    case ORCC:
+        r = a | b;
+        break;
+    case ORNCC:
+        r = a | ~b;
+        break;
+    case XORCC:
+        r = a ^ b;
+        break;
+    default:
+        r = a ^ ~b;
+        break;
+    }
+    return ((r >> 31) << 3) | ((r == 0) << 2) | (v << 1) | c;
+}
+
+/* Bicc and Ticc condition cond on icc */
+static int taken(int cond, uint32 cc)
+{
+    int n = (cc & ICC_N) != 0, z = (cc & ICC_Z) != 0;
+    int v = (cc & ICC_V) != 0, c = (cc & ICC_C) != 0;
+    int t;
+
+    switch (cond & 7) {
+    case 0: t = 0; break;
+    case 1: t = z; break;
+    case 2: t = z | (n ^ v); break;
+    case 3: t = n ^ v; break;
+    case 4: t = c | z; break;
+    case 5: t = c; break;
+    case 6: t = n; break;
+    default: t = v; break;
+    }
+    return (cond & 8) ? !t : t;
+}
+
+/* Trap handler: log the psr it was entered with, mark a taken Ticc in
+   %g4 and return past the trapping instruction */
+static void handler(uint32 tt, int ticc)
+{
+    const uint32 code[] = {
+        fmt3(0x29, 16, 0, 0),		/* rd %psr, %l0 */
+        0xc0000000 | (16 << 25) | (0x04 << 19) | (6 << 14),	/* st %l0, [%g6] */
+        fmt3i(0x00, 6, 6, 4),		/* add %g6, 4, %g6 */
+        fmt3i(0x02, 4, 4, ticc),	/* or %g4, ticc, %g4 */
+        fmt3i(0x38, 0, 18, 0),		/* jmp %l2 */
+        fmt3i(0x39, 0, 18, 4),		/* rett %l2 + 4 */
+    };
+
+    for (int i = 0; i < 6; i++)
+        ms->sis_memory_write(TBR + tt * 16 + 4 * i, (char *) &code[i], 4);
+}
+
+/* Run op on a and b, after a subcc that leaves carry cin, in front of
+   each reader */
+static std::vector<uint32> program(uint32 op, uint32 a, uint32 b,
+                                   uint32 cin)
+{
+    std::vector<uint32> p;
+    const uint32 setcc[] = {
+        fmt3(SUBCC, 0, 0, 7),		/* subcc %g0, %g7, %g0 */
+        fmt3(op, 3, 1, 2),		/* op %g1, %g2, %g3 */
+    };
+
+    set(p, 3, TBR);
+    p.push_back(fmt3(0x33, 0, 3, 0));	/* wr %g3, %tbr */
+    set(p, 6, LOG);
+    set(p, 1, a);
+    set(p, 2, b);
+    p.push_back(fmt3i(0x02, 7, 0, cin));	/* mov cin, %g7 */
+    p.push_back(fmt3(0x02, 4, 0, 0));	/* clr %g4 */
+    p.push_back(fmt3(0x02, 5, 0, 0));	/* clr %g5 */
+
+    /* branches shift their outcomes into %g5, ba,a would annul the
+       delay slot when taken */
+    for (int cond = 0; cond < 16; cond++) {
+        p.insert(p.end(), setcc, setcc + 2);
+        p.push_back(fmt3(0x00, 5, 5, 5));	/* add %g5, %g5, %g5 */
+        p.push_back(bicc(cond, cond != 8, 2));	/* b<cond>,a 1f */
+        p.push_back(fmt3i(0x02, 5, 5, 1));	/*  or %g5, 1, %g5 */
+    }						/* 1: */
+    /* and traps on condition theirs into %g4 */
+    for (int cond = 0; cond < 16; cond++) {
+        p.insert(p.end(), setcc, setcc + 2);
+        p.push_back(fmt3(0x00, 4, 4, 4));	/* add %g4, %g4, %g4 */
+        p.push_back(fmt3i(0x3a, cond, 0, 0));	/* t<cond> 0 */
+    }
+    p.insert(p.end(), setcc, setcc + 2);
+    p.push_back(fmt3(0x29, 8, 0, 0));	/* rd %psr, %o0 */
+    p.insert(p.end(), setcc, setcc + 2);
+    p.push_back(fmt3(0x08, 9, 0, 0));	/* addx %g0, %g0, %o1 */
+    p.insert(p.end(), setcc, setcc + 2);
+    p.push_back(fmt3(0x0c, 10, 0, 0));	/* subx %g0, %g0, %o2 */
+    /* a pending update must not override a later wr %psr */
+    set(p, 12, 0x00f00000);
+    p.insert(p.end(), setcc, setcc + 2);
+    p.push_back(fmt3(0x29, 11, 0, 0));	/* rd %psr, %o3 */
+    p.insert(p.end(), setcc, setcc + 2);
+    p.push_back(fmt3(0x31, 0, 11, 12));	/* wr %o3, %o4, %psr */
+    p.push_back(0x01000000);		/* nop */
+    p.push_back(0x01000000);		/* nop */
+    p.push_back(0x01000000);		/* nop */
+    p.push_back(fmt3(0x29, 13, 0, 0));	/* rd %psr, %o5 */
+    p.insert(p.end(), setcc, setcc + 2);
+    p.push_back(0);			/* unimp */
+    p.push_back(bicc(8, 0, 0));		/* ba . */
+    p.push_back(0x01000000);		/*  nop */
+    return p;
+}
+
+static void run_case(uint32 op, uint32 a, uint32 b, uint32 cin)
+{
+    std::vector<uint32> p = program(op, a, b, cin);
+    uint32 cc = icc(op, a, b, cin), t = 0;
+
+    load(&p[0], p.size());
+    handler(2, 0);
+    handler(0x80, 1);
+    exec_cmd("run 20000");
+
+    for (int cond = 0; cond < 16; cond++)
+        t = (t << 1) | taken(cond, cc);
+    LONGS_EQUAL(t, sregs[0].g[5]);
+    LONGS_EQUAL(t, sregs[0].g[4]);
+    /* the handler logged one psr per taken Ticc, then the unimp one */
+    for (uint32 addr = LOG; addr < sregs[0].g[6]; addr += 4) {
+        uint32 psr;
+
+        ms->sis_memory_read(addr, (char *) &psr, 4);
+        LONGS_EQUAL(cc, (psr >> 20) & 0xf);
+    }
+    LONGS_EQUAL(LOG + 4 * (__builtin_popcount(t) + 1), sregs[0].g[6]);
+    LONGS_EQUAL(cc, (sregs[0].r[8] >> 20) & 0xf);
+    LONGS_EQUAL(cc & ICC_C, sregs[0].r[9]);
+    LONGS_EQUAL(-(cc & ICC_C), sregs[0].r[10]);
+    LONGS_EQUAL(cc ^ 0xf, (sregs[0].r[13] >> 20) & 0xf);
+}
+
+TEST_GROUP(CcTests)
+{
+    void setup()
+    {
+        use_target(&erc32sys, &sparc32, ERC32_RAM);
+    }
+
+    void teardown()
+    {
+        jit = 0;
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+TEST(CcTests, ShouldGiveReadersTheConditionCodesOfLastOp)
+{
+    for (jit = 0; jit < 2; jit++)
+        for (uint32 i = 0; i < sizeof(ops) / 4; i++)
+            for (uint32 j = 0; j < sizeof(operands) / 8; j++)
+                for (uint32 cin = 0; cin < 2; cin++)
+                    run_case(ops[i], operands[j][0], operands[j][1], cin);
+}
+
+/* GDB reads psr outside the run loop, with an update still pending */
+TEST(CcTests, ShouldSyncConditionCodesForGdbRead)
+{
+    char buf[72 * 4];
+
+    for (uint32 j = 0; j < sizeof(operands) / 8; j++) {
+        uint32 a = operands[j][0], b = operands[j][1];
+        uint32 psr = sregs[0].psr & ~0x00f00000, rval;
+
+        sregs[0].psr = psr | 0x00f00000;
+        sregs[0].ccop = CC_SUB;
+        sregs[0].ccsrc1 = a;
+        sregs[0].ccsrc2 = b;
+        sregs[0].ccres = a - b;
+        cpu = 0;
+        sparc32.gdb_get_reg(buf);
+        rval = ((uint32) (unsigned char) buf[65 * 4] << 24) |
+            ((unsigned char) buf[65 * 4 + 1] << 16) |
+            ((unsigned char) buf[65 * 4 + 2] << 8) |
+            (unsigned char) buf[65 * 4 + 3];
+        LONGS_EQUAL(psr | (icc(SUBCC, a, b, 0) << 20), rval);
+        LONGS_EQUAL(CC_NONE, sregs[0].ccop);
+    }
+}
@@ -0,0 +1,144 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+#include "../common/loops.h"
+
+#define MEC_RTC_COUNTER 0x01f80080
+#define MEC_GPT_COUNTER 0x01f80088
+
+/* Run the ERC32 RTC and GPT periodically with interrupts enabled,
+   counting the GPT interrupts in %g6, the RTC ones in %g7 and loop
+   iterations in %g5 */
+static const uint32 timer_loop[] = {
+    0x03007e00,	/* sethi %hi(0x01f80000), %g1 */
+    0x07008004,	/* sethi %hi(0x02001000), %g3 */
+    0x8198e000,	/* wr %g3, %tbr */
+    0x881020e0,	/* mov 0xe0, %g4 */
+    0x81892000,	/* wr %g4, %psr */
+    0x01000000,	/* nop */
+    0x01000000,	/* nop */
+    0x8a102000,	/* clr %g5 */
+    0x8c102000,	/* clr %g6 */
+    0x8e102000,	/* clr %g7 */
+    0xc020604c,	/* clr [%g1 + 0x4c] (imr) */
+    0x88102003,	/* mov 3, %g4 */
+    0xc820608c,	/* st %g4, [%g1 + 0x8c] (gpt scaler) */
+    0x88102032,	/* mov 50, %g4 */
+    0xc8206088,	/* st %g4, [%g1 + 0x88] (gpt reload) */
+    0x88102007,	/* mov 7, %g4 */
+    0xc8206084,	/* st %g4, [%g1 + 0x84] (rtc scaler) */
+    0x8810201e,	/* mov 30, %g4 */
+    0xc8206080,	/* st %g4, [%g1 + 0x80] (rtc reload) */
+    0x88102707,	/* mov 0x707, %g4 */
+    0xc8206098,	/* st %g4, [%g1 + 0x98] (load, reload and start both) */
+    0x8a016001,	/* 1: inc %g5 */
+    0x10bfffff,	/* ba 1b */
+    0x01000000,	/*  nop */
+};
+
+/* Interrupt 12 (GPT) and 13 (RTC) handlers */
+static const uint32 gpt_trap[] = {
+    0x8c01a001,	/* inc %g6 */
+    0x81c46000,	/* jmp %l1 */
+    0x81cca000,	/*  rett %l2 */
+};
+
+static const uint32 rtc_trap[] = {
+    0x8e01e001,	/* inc %g7 */
+    0x81c46000,	/* jmp %l1 */
+    0x81cca000,	/*  rett %l2 */
+};
+
+TEST_GROUP(CheckpointTests)
+{
+    void teardown()
+    {
+        baseline_drop();
+        jit = 0;
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+/* Continuing from a restored checkpoint must give the same run as
+   continuing right after saving it, so the timers and their pending
+   events have to come back as they were */
+TEST(CheckpointTests, ShouldRestoreTimerStateFromCheckpoint)
+{
+    char fname[] = "/tmp/sis_ckptXXXXXX";
+    struct pstate ref;
+    uint32 gpt, rtc, v;
+    int32 ws;
+    int res;
+
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    load(timer_loop, sizeof(timer_loop) / 4);
+    for (int i = 0; i < 3; i++) {
+        ms->sis_memory_write(ERC32_RAM + 0x11c0 + 4 * i,
+                             (char *) &gpt_trap[i], 4);
+        ms->sis_memory_write(ERC32_RAM + 0x11d0 + 4 * i,
+                             (char *) &rtc_trap[i], 4);
+    }
+    exec_cmd("run 500");
+    close(mkstemp(fname));
+    LONGS_EQUAL(0, ckpt_save(fname));
+
+    exec_cmd("cont 5000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+    ms->memory_read(MEC_GPT_COUNTER, &gpt, &ws);
+    ms->memory_read(MEC_RTC_COUNTER, &rtc, &ws);
+    CHECK(ref.g[6] != 0);
+    CHECK(ref.g[7] != 0);
+
+    res = ckpt_restore(fname);
+    unlink(fname);
+    LONGS_EQUAL(0, res);
+    exec_cmd("cont 5000");
+
+    LONGS_EQUAL(ref.g[5], sregs[0].g[5]);
+    LONGS_EQUAL(ref.g[6], sregs[0].g[6]);
+    LONGS_EQUAL(ref.g[7], sregs[0].g[7]);
+    LONGS_EQUAL(ref.pc, sregs[0].pc);
+    CHECK(ref.simtime == sregs[0].simtime);
+    ms->memory_read(MEC_GPT_COUNTER, &v, &ws);
+    LONGS_EQUAL(gpt, v);
+    ms->memory_read(MEC_RTC_COUNTER, &v, &ws);
+    LONGS_EQUAL(rtc, v);
+}
+
+/* run after a baseline must restore the pages the program patched,
+   and dropping the translated code keeps the second run identical */
+TEST(CheckpointTests, ShouldRewindPatchedCodeToBaseline)
+{
+    struct pstate ref;
+    uint32 v;
+    int32 ws;
+
+    use_target(&rv32, &riscv, RV32_RAM);
+    load(smc_loop, sizeof(smc_loop) / 4);
+    exec_cmd("run 4");
+    LONGS_EQUAL(0, baseline_set());
+    exec_cmd("run 20000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+    ms->memory_read(RV32_RAM + 16, &v, &ws);
+    CHECK(v != smc_loop[4]);
+
+    LONGS_EQUAL(1, baseline_rewind());
+    ms->memory_read(RV32_RAM + 16, &v, &ws);
+    LONGS_EQUAL(smc_loop[4], v);
+    jit = 1;
+    exec_cmd("run 20000");
+    jit = 0;
+    baseline_drop();
+
+    for (int i = 0; i < 32; i++)
+        LONGS_EQUAL(ref.r[i], sregs[0].r[i]);
+    LONGS_EQUAL(ref.pc, sregs[0].pc);
+    CHECK(ref.simtime == sregs[0].simtime);
+    CHECK(ref.ninst == sregs[0].ninst);
+}
@@ -0,0 +1,99 @@
+#include <stdlib.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "hold.h"
+
+/* event() takes an unprototyped C function pointer */
+#define HANDLER(f) ((void (*)())(f))
+
+struct list_cell {
+    int32 arg;
+    uint64 time;
+    struct list_cell *nxt;
+};
+
+static struct list_cell list_head;
+static struct list_cell *list_free;
+static uint64 list_time;
+
+static void list_insert(int32 arg, uint64 delta)
+{
+    struct list_cell *ev1 = &list_head;
+    struct list_cell *evins = list_free;
+
+    delta += list_time;
+    while ((ev1->nxt != NULL) && (ev1->nxt->time <= delta))
+        ev1 = ev1->nxt;
+    list_free = list_free->nxt;
+    evins->nxt = ev1->nxt;
+    ev1->nxt = evins;
+    evins->time = delta;
+    evins->arg = arg;
+}
+
+static uint32 hold_seed;
+static uint64 hold_sum;
+static int hold_left;
+
+static uint64 hold_delay(void)
+{
+    hold_seed = hold_seed * 1103515245 + 12345;
+    return (hold_seed >> 16) % 1000;
+}
+
+uint64 hold_list(int pending, int events)
+{
+    struct list_cell *pool;
+    int i;
+
+    pool = (struct list_cell *) malloc((pending + 1) * sizeof(*pool));
+    hold_seed = 1;
+    hold_sum = 0;
+    list_time = 0;
+    list_head.nxt = NULL;
+    list_free = pool;
+    for (i = 0; i < pending; i++)
+        pool[i].nxt = &pool[i + 1];
+    pool[pending].nxt = NULL;
+
+    for (i = 0; i < pending; i++)
+        list_insert(i, hold_delay());
+    for (i = 0; i < events; i++) {
+        struct list_cell *ev = list_head.nxt;
+        list_head.nxt = ev->nxt;
+        list_time = ev->time;
+        hold_sum = hold_sum * 31 + (uint64)ev->arg + list_time;
+        ev->nxt = list_free;
+        list_free = ev;
+        if (i + 1 < events)
+            list_insert(ev->arg, hold_delay());
+    }
+    free(pool);
+    return hold_sum;
+}
+
+static void hold_event(int32 arg)
+{
+    if (hold_left <= 0)
+        return;
+    hold_sum = hold_sum * 31 + (uint64)arg + ebase.simtime;
+    if (--hold_left > 0)
+        event(HANDLER(hold_event), arg, hold_delay());
+}
+
+uint64 hold_queue(int pending, int events)
+{
+    hold_seed = 1;
+    hold_sum = 0;
+    hold_left = events;
+    ebase.simtime = 0;
+    init_event();
+    for (int i = 0; i < pending; i++)
+        event(HANDLER(hold_event), i, hold_delay());
+    while (hold_left > 0)
+        advance_time(ebase.evtime);
+    init_event();
+    return hold_sum;
+}
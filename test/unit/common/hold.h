@@ -0,0 +1,9 @@
+/* Hold model for the event queue: a fixed number of pending events where
+   each fired event schedules a new one after a pseudo-random delay.  Both
+   return a checksum of the order and time in which events fired. */
+
+/* Run it on the sorted linked list the event queue used to be */
+uint64 hold_list(int pending, int events);
+
+/* Run it on event () and advance_time (), from an empty queue at time 0 */
+uint64 hold_queue(int pending, int events);
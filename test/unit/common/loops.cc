@@ -0,0 +1,57 @@
+extern "C" {
+#include "sis.h"
+}
+#include "loops.h"
+
+/* Integer loop: ALU ops, a multiply and a compressed pair */
+const uint32 alu_loop[ALU_LOOP_LEN] = {
+    0x3e800413,	/* li s0, 1000 */
+    0x00100513,	/* li a0, 1 */
+    0x00000593,	/* li a1, 0 */
+    0x00a585b3,	/* 1: add a1, a1, a0 */
+    0x00359613,	/* slli a2, a1, 3 */
+    0x00c54533,	/* xor a0, a0, a2 */
+    0x02b506b3,	/* mul a3, a0, a1 */
+    0x40a6d733,	/* sra a4, a3, a0 */
+    0x87ba0585,	/* c.addi a1, 1; c.mv a5, a4 */
+    0xfff40413,	/* addi s0, s0, -1 */
+    0xfe0414e3,	/* bnez s0, 1b */
+    0x0000006f,	/* j . */
+};
+
+/* Loop that rewrites its first instruction every 32 iterations */
+const uint32 smc_loop[SMC_LOOP_LEN] = {
+    0x3e800413,	/* li s0, 1000 */
+    0x00000593,	/* li a1, 0 */
+    0x80000337,	/* lui t1, 0x80000 */
+    0x59300393,	/* li t2, <addi a1, a1, 0> */
+    0x00158593,	/* 1: addi a1, a1, 1 (patched) */
+    0x01f47293,	/* andi t0, s0, 31 */
+    0x00029863,	/* bnez t0, 2f */
+    0x01441293,	/* slli t0, s0, 20 */
+    0x0072e2b3,	/* or t0, t0, t2 */
+    0x00532823,	/* sw t0, 16(t1) */
+    0xfff40413,	/* 2: addi s0, s0, -1 */
+    0xfe0412e3,	/* bnez s0, 1b */
+    0x0000006f,	/* j . */
+};
+
+/* SPARC loop with an annulled branch, a multiply and a delay slot
+   that uses the carry */
+const uint32 sparc_loop[SPARC_LOOP_LEN] = {
+    0x901023e8,	/* mov 1000, %o0 */
+    0x92102001,	/* mov 1, %o1 */
+    0x94102000,	/* clr %o2 */
+    0x9a102000,	/* clr %o5 */
+    0x94028009,	/* 1: add %o2, %o1, %o2 */
+    0x972aa003,	/* sll %o2, 3, %o3 */
+    0x929a400b,	/* xorcc %o1, %o3, %o1 */
+    0x2c800002,	/* bneg,a 2f */
+    0x9402a001,	/*  add %o2, 1, %o2 */
+    0x9852400a,	/* 2: umul %o1, %o2, %o4 */
+    0x90a22001,	/* subcc %o0, 1, %o0 */
+    0x12bffff9,	/* bne 1b */
+    0x9a43400c,	/*  addx %o5, %o4, %o5 */
+    0x10800000,	/* ba . */
+    0x01000000,	/*  nop */
+};
@@ -0,0 +1,9 @@
+/* Programs used by several groups, loaded with load () */
+
+#define ALU_LOOP_LEN 12
+#define SMC_LOOP_LEN 13
+#define SPARC_LOOP_LEN 15
+
+extern const uint32 alu_loop[ALU_LOOP_LEN];
+extern const uint32 smc_loop[SMC_LOOP_LEN];
+extern const uint32 sparc_loop[SPARC_LOOP_LEN];
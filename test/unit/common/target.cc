@@ -0,0 +1,41 @@
+extern "C" {
+#include "sis.h"
+}
+#include "target.h"
+
+/* RAM is shared, so each memory system gets back its own size and
+   start when selected again */
+static struct {
+    const struct memsys *ms;
+    uint32 ramsize, romsize, ramstart;
+} initialised[2];
+
+void use_target(const struct memsys *m, const struct cpu_arch *a,
+                uint32 ram)
+{
+    int i = (initialised[0].ms != m);
+
+    ms = m;
+    arch = a;
+    ebase.freq = 50;
+    ebase.simtime = 0;
+    if (initialised[i].ms != m) {
+        i = (initialised[0].ms != NULL);
+        ms->init_sim();
+        initialised[i].ms = m;
+        initialised[i].ramsize = ebase.ramsize;
+        initialised[i].romsize = ebase.romsize;
+        initialised[i].ramstart = ebase.ramstart;
+    } else {
+        mem_alloc(initialised[i].ramsize, initialised[i].romsize);
+        ebase.ramstart = initialised[i].ramstart;
+    }
+    reset_all();
+    last_load_addr = ram;
+}
+
+void load(const uint32 *prog, int len)
+{
+    for (int i = 0; i < len; i++)
+        ms->sis_memory_write(last_load_addr + 4 * i, (char *) &prog[i], 4);
+}
@@ -0,0 +1,12 @@
+/* Helpers for the groups that run small programs on a target */
+
+#define RV32_RAM 0x80000000
+#define ERC32_RAM 0x02000000
+
+/* Select memory system and cpu, reset them and load at ram from now on.
+   Each memory system is initialised once per test run. */
+void use_target(const struct memsys *m, const struct cpu_arch *a,
+                uint32 ram);
+
+/* Copy len words of prog to the load address */
+void load(const uint32 *prog, int len);
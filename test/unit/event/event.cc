@@ -0,0 +1,190 @@
+#include "CppUTest/TestHarness.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/hold.h"
+
+/* event() takes an unprototyped C function pointer */
+#define HANDLER(f) ((void (*)())(f))
+
+#define FIRED_MAX 4096
+
+static int32 fired[FIRED_MAX];
+static uint64 fired_time[FIRED_MAX];
+static int nfired;
+
+static void record_event(int32 arg)
+{
+    if (nfired < FIRED_MAX) {
+        fired[nfired] = arg;
+        fired_time[nfired] = ebase.simtime;
+    }
+    nfired++;
+}
+
+static void other_event(int32 arg)
+{
+    record_event(-arg);
+}
+
+TEST_GROUP(EventQueueTests)
+{
+    void setup()
+    {
+        ebase.simtime = 0;
+        init_event();
+        nfired = 0;
+    }
+};
+
+TEST(EventQueueTests, ShouldFireEventsInTimeOrder)
+{
+    event(HANDLER(record_event), 3, 30);
+    event(HANDLER(record_event), 1, 10);
+    event(HANDLER(record_event), 2, 20);
+
+    advance_time(100);
+
+    LONGS_EQUAL(3, nfired);
+    LONGS_EQUAL(1, fired[0]);
+    LONGS_EQUAL(2, fired[1]);
+    LONGS_EQUAL(3, fired[2]);
+    CHECK(fired_time[0] == 10);
+    CHECK(fired_time[2] == 30);
+    CHECK(ebase.simtime == 100);
+}
+
+TEST(EventQueueTests, ShouldFireEventsWithEqualTimeInInsertionOrder)
+{
+    for (int i = 0; i < 100; i++)
+        event(HANDLER(record_event), i, (i % 2) ? 5 : 7);
+
+    advance_time(10);
+
+    LONGS_EQUAL(100, nfired);
+    for (int i = 0; i < 50; i++) {
+        LONGS_EQUAL(2 * i + 1, fired[i]);
+        LONGS_EQUAL(2 * i, fired[50 + i]);
+    }
+}
+
+TEST(EventQueueTests, ShouldNotFireEventsAfterEndTime)
+{
+    event(HANDLER(record_event), 1, 10);
+    event(HANDLER(record_event), 2, 11);
+
+    advance_time(10);
+
+    LONGS_EQUAL(1, nfired);
+    CHECK(ebase.evtime == 11);
+}
+
+TEST(EventQueueTests, ShouldGrowBeyondInitialSize)
+{
+    for (int i = 0; i < 4 * MAX_EVENT; i++)
+        event(HANDLER(record_event), i, 4 * MAX_EVENT - i);
+
+    advance_time(4 * MAX_EVENT);
+
+    LONGS_EQUAL(4 * MAX_EVENT, nfired);
+    for (int i = 0; i < 4 * MAX_EVENT; i++)
+        LONGS_EQUAL(4 * MAX_EVENT - 1 - i, fired[i]);
+}
+
+TEST(EventQueueTests, ShouldRemoveEventsMatchingFunctionAndArgument)
+{
+    for (int i = 0; i < 20; i++) {
+        event(HANDLER(record_event), i % 4, i + 1);
+        event(HANDLER(other_event), i % 4, i + 1);
+    }
+
+    remove_event(HANDLER(record_event), 2);
+    remove_event(HANDLER(other_event), -1);
+    advance_time(100);
+
+    LONGS_EQUAL(15, nfired);
+    for (int i = 0; i < nfired; i++) {
+        CHECK(fired[i] >= 0);
+        CHECK(fired[i] != 2);
+    }
+}
+
+TEST(EventQueueTests, ShouldCancelEventByHandle)
+{
+    uint64 h1 = event(HANDLER(record_event), 1, 10);
+    uint64 h2 = event(HANDLER(record_event), 2, 20);
+    uint64 h3 = event(HANDLER(record_event), 3, 30);
+
+    CHECK(h1 != 0);
+    CHECK(h2 != h1);
+    LONGS_EQUAL(1, cancel_event(h2));
+    LONGS_EQUAL(0, cancel_event(h2));
+    advance_time(100);
+
+    LONGS_EQUAL(2, nfired);
+    LONGS_EQUAL(1, fired[0]);
+    LONGS_EQUAL(3, fired[1]);
+    LONGS_EQUAL(0, cancel_event(h3));
+}
+
+TEST(EventQueueTests, ShouldNotCancelReusedCellWithStaleHandle)
+{
+    uint64 stale = event(HANDLER(record_event), 1, 10);
+
+    advance_time(10);
+    event(HANDLER(record_event), 2, 10);
+
+    LONGS_EQUAL(0, cancel_event(stale));
+    LONGS_EQUAL(0, cancel_event(0));
+    advance_time(100);
+    LONGS_EQUAL(2, nfired);
+}
+
+TEST(EventQueueTests, ShouldRestorePendingEventsFromCheckpoint)
+{
+    static uint32 state;
+    char fname[] = "/tmp/sis_eventXXXXXX";
+    int res;
+
+    if (ebase.ramsize == 0)
+        mem_alloc(MIN_MEM_SIZE, MIN_MEM_SIZE);
+    ckpt_event("record_event", HANDLER(record_event));
+    CKPT_VAR(state);
+    state = 1;
+    event(HANDLER(record_event), 1, 10);
+    uint64 h = event(HANDLER(record_event), 2, 20);
+    event(HANDLER(record_event), 3, 30);
+    advance_time(5);
+    close(mkstemp(fname));
+    LONGS_EQUAL(0, ckpt_save(fname));
+
+    advance_time(100);
+    state = 2;
+    LONGS_EQUAL(3, nfired);
+
+    nfired = 0;
+    res = ckpt_restore(fname);
+    unlink(fname);
+    LONGS_EQUAL(0, res);
+    LONGS_EQUAL(1, state);
+    CHECK(ebase.simtime == 5);
+    LONGS_EQUAL(1, cancel_event(h));
+    advance_time(100);
+    LONGS_EQUAL(2, nfired);
+    LONGS_EQUAL(1, fired[0]);
+    LONGS_EQUAL(3, fired[1]);
+    CHECK(fired_time[1] == 30);
+}
+
+/* The sorted linked list the event queue used to be and the queue must
+   fire events of the hold model in the same order.  test/bench times
+   the two. */
+TEST(EventQueueTests, ShouldMatchSortedListOnHoldModel)
+{
+    uint64 list_sum = hold_list(512, 20000);
+
+    CHECK(list_sum == hold_queue(512, 20000));
+}
@@ -0,0 +1,138 @@
+#include "CppUTest/TestHarness.h"
+#include <vector>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+
+/* SPARC FPops on the host FPU: the FSR exception fields, which are
+   folded in lazily unless -fpexact is given, and the results where
+   the host and a SPARC FPU differ. */
+
+#define DATA (ERC32_RAM + 0x2000)	/* operands, %g1 points here */
+#define RES (DATA + 0x40)		/* results */
+
+enum { FADDS = 0x41, FSUBS = 0x45, FDIVS = 0x4d, FDIVD = 0x4e,
+       FDTOI = 0xd2 };
+enum { LDF = 0x20, LDFSR = 0x21, LDDF = 0x23, STF = 0x24, STFSR = 0x25,
+       STDF = 0x27 };
+
+static const uint32 data[] = {
+    0,				/* 0x00: fsr */
+    0x3f800000,			/* 0x04: 1.0 */
+    0x40400000,			/* 0x08: 3.0 */
+    0x40000000,			/* 0x0c: 2.0 */
+    0x7f800000,			/* 0x10: inf */
+    0x7fc00001,			/* 0x14: quiet NaN */
+    0x7f800002,			/* 0x18: signaling NaN */
+    0x7fc00003,			/* 0x1c: quiet NaN */
+    0x4202a05f, 0x20000000,	/* 0x20: 1e10 */
+    0xc202a05f, 0x20000000,	/* 0x28: -1e10 */
+    0, 0,			/* 0x30: 0.0 */
+};
+
+static uint32 fpop(uint32 opf, int rd, int rs1, int rs2)
+{
+    return 0x81a00000 | (rd << 25) | (rs1 << 14) | (opf << 5) | rs2;
+}
+
+/* load or store of rd at %g1 + off */
+static uint32 mem(uint32 op3, int rd, int off)
+{
+    return 0xc0000000 | (rd << 25) | (op3 << 19) | (1 << 14) | 0x2000 | off;
+}
+
+static std::vector<uint32> program()
+{
+    std::vector<uint32> p;
+    const uint32 prog[] = {
+        0x03000000 | (DATA >> 10),	/* sethi %hi(DATA), %g1 */
+        mem(LDFSR, 0, 0x00),
+        mem(LDF, 0, 0x04),
+        mem(LDF, 1, 0x08),
+        mem(LDF, 2, 0x0c),
+        /* inexact, then exact */
+        fpop(FDIVS, 3, 0, 1),
+        fpop(FADDS, 4, 0, 2),
+        mem(STFSR, 0, 0x40),
+        fpop(FDIVS, 5, 0, 1),
+        mem(STFSR, 0, 0x44),
+        /* NaN results */
+        mem(LDFSR, 0, 0x00),
+        mem(LDF, 6, 0x10),
+        fpop(FSUBS, 7, 6, 6),
+        mem(STF, 7, 0x48),
+        mem(LDF, 8, 0x14),
+        mem(LDF, 9, 0x18),
+        mem(LDF, 12, 0x1c),
+        fpop(FADDS, 10, 8, 9),
+        mem(STF, 10, 0x4c),
+        fpop(FADDS, 11, 8, 12),
+        mem(STF, 11, 0x50),
+        mem(LDDF, 14, 0x30),
+        fpop(FDIVD, 16, 14, 14),
+        mem(STDF, 16, 0x58),
+        /* integer overflow */
+        mem(LDDF, 18, 0x20),
+        fpop(FDTOI, 20, 0, 18),
+        mem(STF, 20, 0x60),
+        mem(LDDF, 18, 0x28),
+        fpop(FDTOI, 21, 0, 18),
+        mem(STF, 21, 0x64),
+        mem(STFSR, 0, 0x68),
+        0x10800000,			/* ba . */
+        0x01000000,			/*  nop */
+    };
+
+    p.assign(prog, prog + sizeof(prog) / 4);
+    return p;
+}
+
+static uint32 result(int off)
+{
+    uint32 val;
+
+    ms->sis_memory_read(RES + off, (char *) &val, 4);
+    return val;
+}
+
+TEST_GROUP(FpuTests)
+{
+    void setup()
+    {
+        use_target(&erc32sys, &sparc32, ERC32_RAM);
+    }
+
+    void teardown()
+    {
+        fpexact = 0;
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+TEST(FpuTests, ShouldGiveSparcExceptionsAndResults)
+{
+    std::vector<uint32> p = program();
+
+    for (fpexact = 0; fpexact < 2; fpexact++) {
+        load(&p[0], p.size());
+        for (uint32 i = 0; i < sizeof(data) / 4; i++)
+            ms->sis_memory_write(DATA + 4 * i, (char *) &data[i], 4);
+        exec_cmd("run 2000");
+
+        /* cexc is the last FPop only, aexc all since the ldfsr */
+        LONGS_EQUAL(0x20, result(0x00) & 0x3ff);
+        LONGS_EQUAL(0x21, result(0x04) & 0x3ff);
+        /* default NaN, then NaN operands by SPARC precedence */
+        LONGS_EQUAL(0x7fffffff, result(0x08));
+        LONGS_EQUAL(0x7fc00002, result(0x0c));
+        LONGS_EQUAL(0x7fc00003, result(0x10));
+        LONGS_EQUAL(0x7fffffff, result(0x18));
+        LONGS_EQUAL(0xffffffff, result(0x1c));
+        LONGS_EQUAL(0x7fffffff, result(0x20));
+        LONGS_EQUAL(0x80000000, result(0x24));
+        LONGS_EQUAL(0x210, result(0x28) & 0x3ff);
+    }
+}
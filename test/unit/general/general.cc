@@ -12,3 +12,20 @@ TEST(GeneralTests, ShouldExecQuitCommandAndReturnQuitStatus)
 {
     CHECK_EQUAL(QUIT, exec_cmd("quit"));
 }
+
+TEST(GeneralTests, ShouldAllocateRamSizeGivenOnCommandLine)
+{
+    uint32 ram = ebase.ramsize ? ebase.ramsize : 0x04000000;
+    uint32 rom = ebase.romsize ? ebase.romsize : 0x01000000;
+
+    ramsize = 0x10000000;
+    mem_alloc(0x04000000, rom);
+    LONGS_EQUAL(0x10000000, ebase.ramsize);
+    LONGS_EQUAL(rom, ebase.romsize);
+    ramb[ebase.ramsize - 1] = 1;
+    LONGS_EQUAL(0, ramb[0]);
+
+    ramsize = 0;
+    mem_alloc(ram, rom);
+    LONGS_EQUAL(ram, ebase.ramsize);
+}
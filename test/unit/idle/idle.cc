@@ -0,0 +1,135 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+#include "../common/loops.h"
+
+/* Start the ERC32 GPT with a scaler of 1000 and poll the scaler
+   until it drops below 512.  The value read only changes every 256
+   cycles, and the scaler runs out long after the loop exits. */
+static const uint32 gpt_poll[] = {
+    0x03007e00,	/* sethi %hi(0x01f80000), %g1 */
+    0x881023e8,	/* mov 1000, %g4 */
+    0xc820608c,	/* st %g4, [%g1 + 0x8c] (gpt scaler) */
+    0x88102006,	/* mov 6, %g4 */
+    0xc8206098,	/* st %g4, [%g1 + 0x98] (load and start) */
+    0xc600608c,	/* 1: ld [%g1 + 0x8c], %g3 */
+    0x8730e008,	/* srl %g3, 8, %g3 */
+    0x80a0e001,	/* cmp %g3, 1 */
+    0x18bffffd,	/* bgu 1b */
+    0x01000000,	/*  nop */
+    0x10800000,	/* ba . */
+    0x01000000,	/*  nop */
+};
+
+/* Count in RAM while the registers are the same at every loop head.
+   Stores are not counted outside -stat, so only the TLB write watch
+   tells this loop from an idle one. */
+static const uint32 ram_count[] = {
+    0x03008008,	/* sethi %hi(0x02002000), %g1 */
+    0xc0204000,	/* clr [%g1] */
+    0xc4004000,	/* 1: ld [%g1], %g2 */
+    0x8600a001,	/* add %g2, 1, %g3 */
+    0xc6204000,	/* st %g3, [%g1] */
+    0x84100000,	/* clr %g2 */
+    0x86100000,	/* clr %g3 */
+    0x10bffffb,	/* ba 1b */
+    0x01000000,	/*  nop */
+};
+
+TEST_GROUP(IdleTests)
+{
+    void teardown()
+    {
+        noidle = 0;
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+TEST(IdleTests, ShouldKeepTimingWhenSkippingIdleLoops)
+{
+    struct pstate ref;
+
+    /* both loops end in a branch to itself */
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    noidle = 1;
+    load(sparc_loop, sizeof(sparc_loop) / 4);
+    exec_cmd("run 200000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+
+    noidle = 0;
+    load(sparc_loop, sizeof(sparc_loop) / 4);
+    exec_cmd("run 200000");
+
+    CHECK(ref.simtime == sregs[0].simtime);
+    CHECK(ref.ninst == sregs[0].ninst);
+    CHECK(ref.nbranch == sregs[0].nbranch);
+    LONGS_EQUAL(ref.pc, sregs[0].pc);
+    LONGS_EQUAL(ref.npc, sregs[0].npc);
+
+    use_target(&rv32, &riscv, RV32_RAM);
+    noidle = 1;
+    load(alu_loop, sizeof(alu_loop) / 4);
+    exec_cmd("run 200000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+
+    noidle = 0;
+    load(alu_loop, sizeof(alu_loop) / 4);
+    exec_cmd("run 200000");
+
+    CHECK(ref.simtime == sregs[0].simtime);
+    CHECK(ref.ninst == sregs[0].ninst);
+    LONGS_EQUAL(ref.pc, sregs[0].pc);
+    LONGS_EQUAL(ref.r[11], sregs[0].r[11]);
+}
+
+/* A loop polling a timer register is not idle even while it reads
+   the same value, since the value changes without an event */
+TEST(IdleTests, ShouldNotSkipLoopPollingTimer)
+{
+    struct pstate ref;
+
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    noidle = 1;
+    load(gpt_poll, sizeof(gpt_poll) / 4);
+    exec_cmd("run 5000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+    LONGS_EQUAL(1, ref.g[3]);
+    LONGS_EQUAL(ERC32_RAM + 0x28, ref.pc);
+
+    noidle = 0;
+    load(gpt_poll, sizeof(gpt_poll) / 4);
+    exec_cmd("run 5000");
+
+    LONGS_EQUAL(ref.g[3], sregs[0].g[3]);
+    LONGS_EQUAL(ref.pc, sregs[0].pc);
+    CHECK(ref.simtime == sregs[0].simtime);
+    CHECK(ref.ninst == sregs[0].ninst);
+}
+
+TEST(IdleTests, ShouldNotSkipLoopThatStores)
+{
+    struct pstate ref;
+    uint32 count, rcount;
+
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    noidle = 1;
+    load(ram_count, sizeof(ram_count) / 4);
+    exec_cmd("run 20000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+    ms->sis_memory_read(ERC32_RAM + 0x2000, (char *) &rcount, 4);
+    CHECK(rcount > 1000);
+
+    noidle = 0;
+    load(ram_count, sizeof(ram_count) / 4);
+    exec_cmd("run 20000");
+    ms->sis_memory_read(ERC32_RAM + 0x2000, (char *) &count, 4);
+
+    LONGS_EQUAL(rcount, count);
+    CHECK(ref.simtime == sregs[0].simtime);
+    CHECK(ref.ninst == sregs[0].ninst);
+}
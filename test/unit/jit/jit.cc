@@ -0,0 +1,231 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+#include "../common/loops.h"
+
+#define DATA_WORDS 128
+
+/* Run prog from a fresh data area at data, if any, with jit and
+   jithost as given */
+static void run(const uint32 *prog, int len, uint32 data, int j, int host,
+                int stat)
+{
+    jit = j;
+    jithost = host;
+    ebase.stat = stat;
+    load(prog, len);
+    for (uint32 i = 0; data && (i < DATA_WORDS); i++) {
+        uint32 val = 0x01020304 * (i + 1);
+
+        ms->sis_memory_write(data + 4 * i, (char *) &val, 4);
+    }
+    exec_cmd("run 20000");
+    jit = 0;
+    jithost = 1;
+    ebase.stat = 0;
+}
+
+/* Run prog without translation, then as threaded code and as host
+   code, and check that registers, pc, simulated time, the data area
+   and, in the statistics run loops, the counters come out the same */
+static void compare(const uint32 *prog, int len, uint32 data = 0)
+{
+    struct pstate ref;
+    uint32 mem[DATA_WORDS], val;
+
+    for (int stat = 0; stat < 2; stat++) {
+        run(prog, len, data, 0, 0, stat);
+        memcpy(&ref, &sregs[0], sizeof(ref));
+        for (uint32 i = 0; data && (i < DATA_WORDS); i++)
+            ms->sis_memory_read(data + 4 * i, (char *) &mem[i], 4);
+
+        for (int host = 0; host < 2; host++) {
+            run(prog, len, data, 1, host, stat);
+            for (int i = 0; i < 128; i++)
+                LONGS_EQUAL(ref.r[i], sregs[0].r[i]);
+            for (int i = 0; i < 8; i++)
+                LONGS_EQUAL(ref.g[i], sregs[0].g[i]);
+            LONGS_EQUAL(ref.psr, sregs[0].psr);
+            LONGS_EQUAL(ref.y, sregs[0].y);
+            LONGS_EQUAL(ref.pc, sregs[0].pc);
+            if (arch == &sparc32)
+                LONGS_EQUAL(ref.npc, sregs[0].npc);
+            CHECK(ref.simtime == sregs[0].simtime);
+            CHECK(ref.ninst == sregs[0].ninst);
+            CHECK(ref.holdt == sregs[0].holdt);
+            CHECK(ref.icntt == sregs[0].icntt);
+            CHECK(ref.nbranch == sregs[0].nbranch);
+            CHECK(ref.nload == sregs[0].nload);
+            CHECK(ref.nstore == sregs[0].nstore);
+            for (uint32 i = 0; data && (i < DATA_WORDS); i++) {
+                ms->sis_memory_read(data + 4 * i, (char *) &val, 4);
+                LONGS_EQUAL(mem[i], val);
+            }
+        }
+    }
+}
+
+/* SPARC loads and stores of each size next to their uses, calls two
+   windows deep through SAVE, RESTORE and JMPL, and a store to the
+   page of the inner call, which leaves every block it is in */
+#define SPARC_DATA (ERC32_RAM + 0x2000)
+#define SPARC_FUNC 1024		/* word offset of the inner call */
+
+static const uint32 sparc_mem[] = {
+    0x03008008,	/* sethi %hi(SPARC_DATA), %g1 */
+    0x1b008006,	/* sethi %hi(ERC32_RAM + 0x1800), %o5 */
+    0x84102032,	/* mov 50, %g2 */
+    0x86000000,	/* clr %g3 */
+    0x88102010,	/* 1: mov 16, %g4 */
+    0x8a004000,	/* mov %g1, %g5 */
+    0xcc016000,	/* 2: ld [%g5], %g6 */
+    0x8600c006,	/* add %g3, %g6, %g3 */
+    0xce096001,	/* ldub [%g5 + 1], %g7 */
+    0xce316002,	/* sth %g7, [%g5 + 2] */
+    0x8c01a001,	/* add %g6, 1, %g6 */
+    0xcc216000,	/* st %g6, [%g5] */
+    0x88a12001,	/* subcc %g4, 1, %g4 */
+    0x12bffff9,	/* bne 2b */
+    0x8a016004,	/*  add %g5, 4, %g5 */
+    0x4000000b,	/* call 3f */
+    0x9000c000,	/*  mov %g3, %o0 */
+    0xd4186008,	/* ldd [%g1 + 8], %o2 */
+    0xd4386100,	/* std %o2, [%g1 + 0x100] */
+    0xd0286180,	/* stb %o0, [%g1 + 0x180] */
+    0xc4236000,	/* st %g2, [%o5] */
+    0x84a0a001,	/* subcc %g2, 1, %g2 */
+    0x32bfffee,	/* bne,a 1b */
+    0x8600c008,	/*  add %g3, %o0, %g3 */
+    0x10800000,	/* ba . */
+    0x01000000,	/*  nop */
+    0x9de3bfa0,	/* 3: save %sp, -96, %sp */
+    0xa0062001,	/* add %i0, 1, %l0 */
+    0x400003e4,	/* call SPARC_FUNC */
+    0x90040000,	/*  mov %l0, %o0 */
+    0xe2106006,	/* lduh [%g1 + 6], %l1 */
+    0xe4486005,	/* ldsb [%g1 + 5], %l2 */
+    0xe6506004,	/* ldsh [%g1 + 4], %l3 */
+    0xb0020011,	/* add %o0, %l1, %i0 */
+    0xb01e0013,	/* xor %i0, %l3, %i0 */
+    0x81c7e008,	/* ret */
+    0x91ee0012,	/*  restore %i0, %l2, %o0 */
+};
+
+static const uint32 sparc_func[] = {
+    0x9de3bfa0,	/* save %sp, -96, %sp */
+    0xb0062002,	/* add %i0, 2, %i0 */
+    0x81c7e008,	/* ret */
+    0x81e80000,	/*  restore */
+};
+
+/* RV32 loads and stores of each size, compressed ones through sp and
+   a register, a load to x0, a call and a store to the page of the
+   call, which leaves every block it is in */
+#define RV_DATA (RV32_RAM + 0x2000)
+#define RV_FUNC 1024		/* word offset of the call */
+
+static const uint32 rv_mem[] = {
+    0x80002337,	/* lui t1, %hi(RV_DATA) */
+    0x80001f37,	/* lui t5, %hi(RV32_RAM + 0x1000) */
+    0x10030113,	/* addi sp, t1, 256 */
+    0x01e00413,	/* li s0, 30 */
+    0x00000493,	/* li s1, 0 */
+    0x01000293,	/* 1: li t0, 16 */
+    0x00030593,	/* mv a1, t1 */
+    0x0005a603,	/* 2: lw a2, 0(a1) */
+    0x00c484b3,	/* add s1, s1, a2 */
+    0x0015c683,	/* lbu a3, 1(a1) */
+    0x00d59123,	/* sh a3, 2(a1) */
+    0x00358703,	/* lb a4, 3(a1) */
+    0x00e484b3,	/* add s1, s1, a4 */
+    0x00160613,	/* addi a2, a2, 1 */
+    0x00c5a023,	/* sw a2, 0(a1) */
+    0xfff28293,	/* addi t0, t0, -1 */
+    0x00458593,	/* addi a1, a1, 4 */
+    0xfc029ce3,	/* bnez t0, 2b */
+    0x01432003,	/* lw zero, 20(t1) */
+    0xc59c41dc,	/* c.lw a5, 4(a1); c.sw a5, 8(a1) */
+    0x4732c63e,	/* c.swsp a5, 12(sp); c.lwsp a4, 12(sp) */
+    0x7ad000ef,	/* jal RV_FUNC */
+    0x00631803,	/* lh a6, 6(t1) */
+    0x00a35883,	/* lhu a7, 10(t1) */
+    0x010484b3,	/* add s1, s1, a6 */
+    0x0114c4b3,	/* xor s1, s1, a7 */
+    0x18930023,	/* sb s1, 0x180(t1) */
+    0x708f2023,	/* sw s0, 0x700(t5) */
+    0xfff40413,	/* addi s0, s0, -1 */
+    0xfa0410e3,	/* bnez s0, 1b */
+    0x0000006f,	/* j . */
+};
+
+static const uint32 rv_func[] = {
+    0x01032383,	/* lw t2, 16(t1) */
+    0x00778533,	/* add a0, a5, t2 */
+    0x1ea30823,	/* sb a0, 0x1f0(t1) */
+    0x00008067,	/* ret */
+};
+
+TEST_GROUP(JitTests)
+{
+    /* Leave the defaults from func.c for the other groups */
+    void teardown()
+    {
+        jit = 0;
+        jithost = 1;
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+TEST(JitTests, ShouldMatchInterpreterOnIntegerLoop)
+{
+    use_target(&rv32, &riscv, RV32_RAM);
+    compare(alu_loop, sizeof(alu_loop) / 4);
+    CHECK(sregs[0].r[8] == 0);
+}
+
+TEST(JitTests, ShouldDropBlocksOverwrittenByStores)
+{
+    use_target(&rv32, &riscv, RV32_RAM);
+    compare(smc_loop, sizeof(smc_loop) / 4);
+    CHECK(sregs[0].r[8] == 0);
+}
+
+TEST(JitTests, ShouldMatchInterpreterOnSparcDelaySlots)
+{
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    compare(sparc_loop, sizeof(sparc_loop) / 4);
+    CHECK(sregs[0].r[(((sregs[0].psr & 7) << 4) + 8) & 0x7f] == 0);
+}
+
+TEST(JitTests, ShouldMatchInterpreterOnSparcMemoryAndWindows)
+{
+    std::vector<uint32> p(sparc_mem, sparc_mem + sizeof(sparc_mem) / 4);
+
+    p.resize(SPARC_FUNC);
+    p.insert(p.end(), sparc_func, sparc_func + sizeof(sparc_func) / 4);
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    compare(&p[0], p.size(), SPARC_DATA);
+    /* it ran to the end, back in the first window */
+    LONGS_EQUAL(ERC32_RAM + 24 * 4, sregs[0].pc & ~4);
+    LONGS_EQUAL(0, sregs[0].g[2]);
+    LONGS_EQUAL(0, sregs[0].psr & 7);
+}
+
+TEST(JitTests, ShouldMatchInterpreterOnRiscvMemory)
+{
+    std::vector<uint32> p(rv_mem, rv_mem + sizeof(rv_mem) / 4);
+
+    p.resize(RV_FUNC);
+    p.insert(p.end(), rv_func, rv_func + sizeof(rv_func) / 4);
+    use_target(&rv32, &riscv, RV32_RAM);
+    compare(&p[0], p.size(), RV_DATA);
+    /* it ran to the end */
+    LONGS_EQUAL(RV32_RAM + 30 * 4, sregs[0].pc);
+    LONGS_EQUAL(0, sregs[0].r[8]);
+}
@@ -0,0 +1,141 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+
+/* Each hart adds 1000 to one word with amoadd and to the next with
+   lr/sc */
+static const uint32 amo_loop[] = {
+    0x3e800413,	/* li s0, 1000 */
+    0x80001537,	/* lui a0, 0x80001 */
+    0x00450593,	/* addi a1, a0, 4 */
+    0x00100313,	/* li t1, 1 */
+    0x0065202f,	/* 1: amoadd.w zero, t1, (a0) */
+    0x1005a3af,	/* 2: lr.w t2, (a1) */
+    0x00138393,	/* addi t2, t2, 1 */
+    0x1875a6af,	/* sc.w a3, t2, (a1) */
+    0xfe069ae3,	/* bnez a3, 2b */
+    0xfff40413,	/* addi s0, s0, -1 */
+    0xfe0414e3,	/* bnez s0, 1b */
+    0x0000006f,	/* j . */
+};
+
+/* After a delay growing with mhartid, so that the harts get there one
+   by one, each hart divides 2 by 3 rounding down and stores the result
+   at 0x80001000 + 4 * mhartid */
+static const uint32 fdiv_loop[] = {
+    0xf1402373,	/* csrr t1, mhartid */
+    0x00a31393,	/* slli t2, t1, 10 */
+    0xfff38393,	/* 1: addi t2, t2, -1 */
+    0xfe03dee3,	/* bgez t2, 1b */
+    0x00215073,	/* csrwi frm, 2 */
+    0x00200513,	/* li a0, 2 */
+    0xd0057053,	/* fcvt.s.w f0, a0 */
+    0x00300513,	/* li a0, 3 */
+    0xd00570d3,	/* fcvt.s.w f1, a0 */
+    0x18107153,	/* fdiv.s f2, f0, f1 */
+    0xe0010653,	/* fmv.x.w a2, f2 */
+    0x00231313,	/* slli t1, t1, 2 */
+    0x800015b7,	/* lui a1, 0x80001 */
+    0x006585b3,	/* add a1, a1, t1 */
+    0x00c5a023,	/* sw a2, 0(a1) */
+    0x0000006f,	/* j . */
+};
+
+/* Hart 0 sleeps in wfi between ten timer interrupts 1000 cycles
+   apart, the other harts park in wfi with interrupts off */
+static const uint32 wfi_loop[] = {
+    0xf1402373,	/* csrr t1, mhartid */
+    0x00030663,	/* beqz t1, 2f */
+    0x10500073,	/* 1: wfi */
+    0xfe000ee3,	/* j 1b */
+    0x80000337,	/* 2: lui t1, 0x80000 */
+    0x04c30313,	/* addi t1, t1, 76 */
+    0x30531073,	/* csrw mtvec, t1 */
+    0x02004337,	/* lui t1, 0x2004 */
+    0x3e800393,	/* li t2, 1000 */
+    0x00732023,	/* sw t2, 0(t1) */
+    0x000013b7,	/* lui t2, 0x1 */
+    0x88038393,	/* addi t2, t2, -1920 */
+    0x3043a073,	/* csrs mie, t2 */
+    0x00800393,	/* li t2, 8 */
+    0x3003a073,	/* csrs mstatus, t2 */
+    0x00a00413,	/* li s0, 10 */
+    0x10500073,	/* 3: wfi */
+    0xfe8e4ee3,	/* blt t3, s0, 3b */
+    0x0000006f,	/* j . */
+    0x001e0e13,	/* addi t3, t3, 1 */
+    0x0200ceb7,	/* lui t4, 0x200c */
+    0xff8eaf03,	/* lw t5, -8(t4) */
+    0x3e8f0f13,	/* addi t5, t5, 1000 */
+    0x01e32023,	/* sw t5, 0(t1) */
+    0x30200073,	/* mret */
+};
+
+TEST_GROUP(MpTests)
+{
+    void teardown()
+    {
+        mtsim = 0;
+        ncpu = 1;
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+TEST(MpTests, ShouldKeepAtomicsAcrossHostThreads)
+{
+    uint32 v, zero = 0;
+    int32 ws;
+
+    use_target(&rv32, &riscv, RV32_RAM);
+    load(amo_loop, sizeof(amo_loop) / 4);
+    ms->sis_memory_write(RV32_RAM + 0x1000, (char *) &zero, 4);
+    ms->sis_memory_write(RV32_RAM + 0x1004, (char *) &zero, 4);
+    exec_cmd("ncpu 4");
+    mtsim = 1;
+    exec_cmd("run 100000");
+
+    ms->memory_read(RV32_RAM + 0x1000, &v, &ws);
+    LONGS_EQUAL(4000, v);
+    ms->memory_read(RV32_RAM + 0x1004, &v, &ws);
+    LONGS_EQUAL(4000, v);
+}
+
+/* The host rounding mode is set per thread, one hart setting it must
+   not make another thread skip setting its own */
+TEST(MpTests, ShouldRoundOnEachHostThread)
+{
+    uint32 v;
+    int32 ws;
+
+    use_target(&rv32, &riscv, RV32_RAM);
+    load(fdiv_loop, sizeof(fdiv_loop) / 4);
+    exec_cmd("ncpu 4");
+    mtsim = 1;
+    exec_cmd("run 20000");
+
+    for (int i = 0; i < 4; i++) {
+        ms->memory_read(RV32_RAM + 0x1000 + 4 * i, &v, &ws);
+        LONGS_EQUAL(0x3f2aaaaa, v);
+    }
+}
+
+/* Parked harts are skipped, not run, but keep up with simulated time */
+TEST(MpTests, ShouldWakeSleepingHartOnTimer)
+{
+    use_target(&rv32, &riscv, RV32_RAM);
+    load(wfi_loop, sizeof(wfi_loop) / 4);
+    exec_cmd("ncpu 4");
+    exec_cmd("run 12000");
+
+    LONGS_EQUAL(RV32_RAM + 0x48, sregs[0].pc);
+    CHECK(sregs[0].r[28] >= 10);
+    for (int i = 1; i < 4; i++) {
+        LONGS_EQUAL(1, sregs[i].pwd_mode);
+        LONGS_EQUAL(RV32_RAM + 0xc, sregs[i].pc);
+        CHECK(sregs[i].simtime == ebase.simtime);
+    }
+}
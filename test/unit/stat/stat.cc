@@ -0,0 +1,41 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+#include "../common/loops.h"
+
+TEST_GROUP(StatTests)
+{
+    void teardown()
+    {
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+/* Detailed statistics are collected by separate run loops, which must
+   time the program as the plain ones do */
+TEST(StatTests, ShouldKeepTimingWhenCollectingStatistics)
+{
+    struct pstate ref;
+
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    load(sparc_loop, sizeof(sparc_loop) / 4);
+    exec_cmd("run 20000");
+    memcpy(&ref, &sregs[0], sizeof(ref));
+    /* the plain loops leave the instruction mix alone */
+    CHECK(ref.nbranch == 0);
+
+    ebase.stat = 1;
+    load(sparc_loop, sizeof(sparc_loop) / 4);
+    exec_cmd("run 20000");
+    ebase.stat = 0;
+
+    CHECK(ref.simtime == sregs[0].simtime);
+    CHECK(ref.ninst == sregs[0].ninst);
+    CHECK(sregs[0].nbranch != 0);
+    CHECK(sregs[0].icntt != 0);
+}
@@ -0,0 +1,51 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "sis.h"
+}
+#include "../common/target.h"
+
+/* Stores and loads through the TLB must leave memory and waitstates
+   as the memsys path does, the first access of each pair filling
+   the entry */
+static void compare_tlb(uint32 ram)
+{
+    uint32 v, ref, data[2] = {0x12345678, 0x9abcdef0};
+    int32 ws, refws;
+
+    for (int sz = 0; sz < 4; sz++) {
+        for (int i = 0; i < 2; i++) {
+            uint32 a = ram + 0x100 + 8 * sz, b = a + 0x40;
+
+            LONGS_EQUAL(0, ms->memory_write(b, data, sz, &refws));
+            LONGS_EQUAL(0, tlb_write(&sregs[0], a, data, sz, &ws));
+            LONGS_EQUAL(refws, ws);
+            LONGS_EQUAL(0, ms->memory_read(b, &ref, &refws));
+            LONGS_EQUAL(0, tlb_read(&sregs[0], a, &v, &ws));
+            LONGS_EQUAL(ref, v);
+            LONGS_EQUAL(refws, ws);
+            if (sz == 3) {
+                LONGS_EQUAL(0, ms->memory_read(b + 4, &ref, &refws));
+                LONGS_EQUAL(0, tlb_read(&sregs[0], a + 4, &v, &ws));
+                LONGS_EQUAL(ref, v);
+            }
+        }
+    }
+}
+
+TEST_GROUP(TlbTests)
+{
+    void teardown()
+    {
+        ms = NULL;
+        arch = &sparc32;
+    }
+};
+
+TEST(TlbTests, ShouldAccessMemoryThroughTlbLikeMemsys)
+{
+    use_target(&erc32sys, &sparc32, ERC32_RAM);
+    compare_tlb(ERC32_RAM);
+    use_target(&rv32, &riscv, RV32_RAM);
+    compare_tlb(RV32_RAM);
+}